@@ -0,0 +1,30 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* bump allocator, memory is never freed piece by piece but all at once with
+ * arena_reset or arena_free. allocations are aligned for any scalar type */
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock* head;     // block being filled, the older ones follow it
+    size_t next_size;     // size of the next block, doubles up to ARENA_MAX_BLOCK
+} Arena;
+
+Arena* arena_create(void);
+void arena_free(Arena* arena);
+
+/* drop every allocation, the newest block is kept for reuse */
+void arena_reset(Arena* arena);
+
+void* arena_alloc(Arena* arena, size_t size);
+void* arena_calloc(Arena* arena, size_t count, size_t size);
+
+/* copy n bytes and add a NUL terminator */
+char* arena_strndup(Arena* arena, const char* s, size_t n);
+
+/* move the blocks of src into dst, src is left empty */
+void arena_merge(Arena* dst, Arena* src);
+
+#endif
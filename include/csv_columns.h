@@ -0,0 +1,62 @@
+#ifndef CSV_COLUMNS_H
+#define CSV_COLUMNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "csv_reader.h"
+
+/* bytes of a string field, not NUL terminated */
+typedef struct {
+    const char* data;
+    size_t length;
+} StringRef;
+
+/* one column of a set of rows as a contiguous typed vector, entry i belongs to row i.
+ * integers and doubles mixed in one column are stored as doubles, since value_compare
+ * compares them as doubles anyway. a column mixing any other types is not typed and
+ * keeps no data, operators read its rows instead */
+typedef struct ColumnVector {
+    ValueType type;       // type of every non NULL entry, VALUE_TYPE_NULL if all are NULL
+    bool typed;
+    bool widened;         // a double vector holding entries that were integers
+    int length;
+    int null_count;
+    uint64_t* validity;   // bit i is set when entry i is not NULL
+    union {
+        long long* ints;
+        double* doubles;
+        DateValue* dates;
+        StringRef* strings;  // point into the file data or the storage of the rows
+        void* data;
+    };
+} ColumnVector;
+
+static inline bool column_vector_valid(const ColumnVector* vector, int i) {
+    return (vector->validity[i >> 6] >> (i & 63)) & 1;
+}
+
+/* numeric entry of an integer or double vector */
+static inline double column_vector_number(const ColumnVector* vector, int i) {
+    return vector->type == VALUE_TYPE_INTEGER ? (double)vector->ints[i] : vector->doubles[i];
+}
+
+/* vector of column col over rows, reading fields the way row_value does without
+ * caching them in the rows */
+ColumnVector* column_vector_build(Row* rows, int row_count, int col);
+void column_vector_free(ColumnVector* vector);
+
+/* order of two non NULL entries, the same as value_compare on their values */
+int column_vector_compare(const ColumnVector* vector, int a, int b);
+
+/* order of a non NULL entry and a value, the same as value_compare */
+int column_vector_compare_value(const ColumnVector* vector, int i, const Value* value);
+
+/* vector of a table column, built on first use and kept until the rows change.
+ * returns NULL for an unknown column */
+const ColumnVector* csv_column_vector(CsvTable* table, int col);
+
+/* forget the vectors of a table, must be called whenever its rows or columns change */
+void csv_drop_column_vectors(CsvTable* table);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include "arena.h"
 
 /* date value structure */
 typedef struct {
@@ -20,13 +21,19 @@ typedef enum {
     VALUE_TYPE_DATE,
 } ValueType;
 
-/* value structure */
+/* value structure. a string is string_length bytes at string_value, a borrowed one points
+ * into memory owned by a table (its file data or arena) and is never freed on its own.
+ * owned strings are NUL terminated, strings borrowed from the file data are not */
 typedef struct {
     ValueType type;
+    bool borrowed;
     union {
         long long int_value;
         double double_value;
-        char* string_value;
+        struct {
+            char* string_value;
+            size_t string_length;
+        };
         DateValue date_value;
     };
 } Value;
@@ -37,12 +44,50 @@ typedef struct {
     ValueType inferred_type;
 } Column;
 
-/* row structure */
+/* byte range of a field inside its line, offset is relative to Row.line */
 typedef struct {
-    Value* values;
+    unsigned int offset;
+    unsigned int length;  // FIELD_SPAN_PARSED is set once the value is cached
+} FieldSpan;
+
+#define FIELD_SPAN_PARSED 0x80000000u
+
+/* row structure, a lazily loaded row only keeps the field spans and parses
+ * a value the first time it is read through row_value */
+typedef struct {
+    Value* values;        // NULL until the first field of a lazy row is read
     int column_count;
+    int field_count;      // entries in spans and values of a lazy row
+    const char* line;     // start of the row in CsvTable.data, lazy rows only
+    FieldSpan* spans;     // NULL for materialized rows
+    const int* slots;     // column -> entry in spans, -1 if not loaded, NULL if one entry per column
+    Arena* arena;         // where a lazy row allocates the values it parses, NULL to use malloc.
+                          // with an arena the strings it parses are borrowed from line
 } Row;
 
+/* comparison checked by the loader on every data row, see CsvConfig.filters */
+typedef enum {
+    ROW_FILTER_EQ,
+    ROW_FILTER_NE,
+    ROW_FILTER_LT,
+    ROW_FILTER_LE,
+    ROW_FILTER_GT,
+    ROW_FILTER_GE,
+    ROW_FILTER_IN,        // equal to one of the values
+    ROW_FILTER_LIKE,      // string matching the LIKE pattern values[0]
+    ROW_FILTER_ILIKE,     // same, ignoring case
+} RowFilterOp;
+
+/* column <op> literal values, compared with value_compare like a WHERE clause does */
+typedef struct {
+    const char* column;
+    int column_index;     // resolved by csv_load
+    RowFilterOp op;
+    Value* values;
+    int value_count;
+    struct LikePattern* like;  // pattern of a LIKE filter, compiled by csv_load
+} RowFilter;
+
 /* CSV table structure */
 typedef struct {
     char* filename;
@@ -60,6 +105,13 @@ typedef struct {
     
     char delimiter;      // field delimiter (default: ',')
     char quote;          // quote character (default: '"')
+    bool lazy;           // rows keep field spans into data instead of values
+    int* slots;          // column -> stored field of lazy rows, -1 if left NULL; NULL loads every column
+    int slot_count;      // number of loaded columns
+    RowFilter* filters;  // resolved row filters, only set while loading
+    int filter_count;
+    Arena* arena;        // owns every row value and string, NULL if each one is malloc'd on its own
+    struct ColumnVector** vectors;  // typed copies of the columns built so far, see csv_columns.h
 } CsvTable;
 
 /* configuration for CSV parsing */
@@ -67,6 +119,15 @@ typedef struct {
     char delimiter;
     char quote;
     bool has_header;
+    int threads;         // loader threads, 0 = one per cpu, 1 = single threaded
+    bool lazy;           // parse fields on first access instead of at load time, strings
+                         // are borrowed from the file data unless the table is editable
+    char** projection;   // names of the columns to parse, NULL parses every column
+    int projection_count;
+    const RowFilter* filters;  // conjunction of filters, rows failing one are not loaded
+    int filter_count;
+    bool editable;       // rows are edited in place, malloc every value instead of using an arena
+    bool columnar;       // also build the typed column vectors of the loaded columns
 } CsvConfig;
 
 /* create default CSV config used in tests */
@@ -81,9 +142,49 @@ bool csv_save(const char* filename, CsvTable* table);
 /* free CSV table */
 void csv_free(CsvTable* table);
 
+/* incremental reader giving the data rows of a file a batch at a time, the filters
+ * of the config must stay valid until the cursor is closed */
+typedef struct CsvCursor CsvCursor;
+
+CsvCursor* csv_cursor_open(const char* filename, CsvConfig config);
+
+/* header of the file, its rows are the current batch */
+CsvTable* csv_cursor_table(CsvCursor* cursor);
+
+/* replace the current batch with the next rows, returns 0 at the end of the file */
+int csv_cursor_next(CsvCursor* cursor);
+void csv_cursor_close(CsvCursor* cursor);
+
+/* value of a row field, parsing and caching it on first access for lazy rows.
+ * fields missing from a short line or not loaded read as a shared NULL, so the
+ * value is read only, a row is changed through its values */
+const Value* row_value_slow(Row* row, int col_index);
+
+static inline const Value* row_value(Row* row, int col_index) {
+    if (col_index < row->column_count) {
+        if (!row->spans) return &row->values[col_index];
+        
+        int field = row->slots ? row->slots[col_index] : col_index;
+        if (field >= 0 && (row->spans[field].length & FIELD_SPAN_PARSED)) {
+            return &row->values[field];
+        }
+    }
+    return row_value_slow(row, col_index);
+}
+
+/* value of a row field without caching it in the row, a string is borrowed
+ * from the file data or from the value already cached */
+Value row_value_peek(Row* row, int col_index);
+
+/* storage of the rows of a table, from its arena if it has one. csv_store_value takes
+ * ownership of a value, csv_copy_value deep copies. a borrowed string is copied by both */
+Value* csv_alloc_values(CsvTable* table, int count);
+void csv_store_value(CsvTable* table, Value* dst, Value value);
+void csv_copy_value(CsvTable* table, Value* dst, const Value* src);
+
 /* get value from table */
-Value* csv_get_value(CsvTable* table, int row_index, int col_index);
-Value* csv_get_value_by_name(CsvTable* table, int row_index, const char* col_name);
+const Value* csv_get_value(CsvTable* table, int row_index, int col_index);
+const Value* csv_get_value_by_name(CsvTable* table, int row_index, const char* col_name);
 
 /* get column index by name */
 int csv_get_column_index(CsvTable* table, const char* col_name);
@@ -92,11 +193,26 @@ int csv_get_column_index(CsvTable* table, const char* col_name);
 void csv_print_table(CsvTable* table, int max_rows);
 void csv_print_table_vertical(CsvTable* table, int max_rows);
 
+/* the same layouts printed in pieces, for results that arrive a batch at a time.
+ * first_row is the number of rows already printed */
+void csv_print_table_header(CsvTable* table);
+void csv_print_table_rows(CsvTable* table, int row_count);
+void csv_print_table_vertical_rows(CsvTable* table, int row_count, int first_row);
+
 /* value utilities */
 void value_free(Value* value);
-char* value_to_string(Value* value);
-int value_compare(Value* a, Value* b);
+char* value_to_string(const Value* value);
+int value_compare(const Value* a, const Value* b);
 Value parse_value(const char* str, size_t len);
-Value value_copy(const Value* src);  // deep copy a value
+Value parse_value_borrowed(const char* str, size_t len);  // a string borrows from str
+Value value_copy(const Value* src);  // deep copy a value, the copy owns its string
+
+/* string values, value_string takes ownership of a malloc'd NUL terminated string */
+Value value_string(char* str);
+Value value_string_borrowed(const char* str, size_t len);
+Value value_borrow(const Value* src);  // shallow copy, valid as long as src is
+
+/* compare string bytes the way strcmp would */
+int value_string_compare(const Value* a, const Value* b);
 
 #endif
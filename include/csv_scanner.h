@@ -0,0 +1,38 @@
+#ifndef CSV_SCANNER_H
+#define CSV_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* structural characters of a 64 byte block, bit i is set when byte i matches */
+typedef struct {
+    uint64_t delimiter;
+    uint64_t quote;
+    uint64_t newline;    // '\n' or '\r'
+} BlockMasks;
+
+/* field separators of one line as found by csv_scan_line */
+typedef struct {
+    int* separators;          // offsets of delimiters outside quotes, relative to line start
+    int separator_count;
+    int separator_capacity;
+    bool has_quote;           // line contains the quote character
+} LineScan;
+
+/* classify 64 bytes starting at block (all must be readable), uses AVX2 or SSE2 when available */
+void csv_scan_block(const char* block, char delimiter, char quote, BlockMasks* out);
+
+/* bit i of the result is the xor of bits 0..i, turns quote positions into an inside-quotes mask */
+uint64_t prefix_xor(uint64_t bits);
+
+/* scan from ptr up to the first '\n'/'\r' (or end), recording the delimiters that are not
+ * between quotes. returns the length of the line */
+size_t csv_scan_line(const char* ptr, const char* end, char delimiter, char quote, LineScan* scan);
+
+void line_scan_free(LineScan* scan);
+
+/* name of the block classifier in use ("avx2", "sse2" or "scalar") */
+const char* csv_scanner_kind(void);
+
+#endif
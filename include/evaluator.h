@@ -20,6 +20,11 @@ typedef struct {
     /* for correlated subqueries */
     Row* outer_row;       // row from outer query (NULL if not in correlated subquery)
     CsvTable* outer_table; // table from outer query (NULL if not in correlated subquery)
+    struct OuterRefs* outer_refs;  // outer columns read are noted here, NULL if nobody asks
+    
+    struct SubqueryCache* subqueries;  // results of subqueries kept until the context is freed
+    
+    unsigned int scope;   // identifier bindings made with other tables are stale, see context_new_scope
 } QueryContext;
 
 /* result set, essentially a CSV table built from query results */
@@ -31,6 +36,22 @@ extern CsvConfig global_csv_config;
 /* main evaluation function */
 ResultSet* evaluate_query(ASTNode* query_ast);
 
+/* consumer of a streamed result, begin gets the output columns (no rows) once,
+ * then rows gets every batch of result rows in order */
+typedef struct {
+    void (*begin)(void* ctx, ResultSet* header);
+    void (*rows)(void* ctx, ResultSet* batch);
+    void* ctx;
+} ResultSink;
+
+/* check if a query can run as a scan -> filter -> project pipeline, that is
+ * a single table query without ORDER BY, GROUP BY, DISTINCT, aggregates or window functions */
+bool query_is_streamable(ASTNode* query_ast);
+
+/* evaluate a streamable query batch by batch, rows are handed to the sink as soon as they
+ * are produced and freed afterwards. returns the number of rows or -1 on error */
+int evaluate_query_streaming(ASTNode* query_ast, ResultSink* sink);
+
 /* helper functions */
 QueryContext* context_create(ASTNode* query_ast);
 void context_free(QueryContext* ctx);
@@ -41,12 +62,21 @@ CsvTable* load_table_from_string(const char* filename);
 /* table lookup by alias */
 TableRef* context_get_table(QueryContext* ctx, const char* alias);
 
+/* start a new binding scope, must be called whenever the tables or outer row of a context change */
+void context_new_scope(QueryContext* ctx);
+
 /* value evaluation */
 Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index);
 bool evaluate_condition(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index);
 
 /* column resolution handling qualified names like "table.column" */
-Value* resolve_column(QueryContext* ctx, const char* column_name, Row* current_row, int table_index);
+const Value* resolve_column(QueryContext* ctx, const char* column_name, Row* current_row, int table_index);
+
+/* the same for an identifier node, resolving its name once per scope and table */
+const Value* resolve_column_node(QueryContext* ctx, ASTNode* node, Row* current_row, int table_index);
+
+/* what an identifier node refers to in a table of the context, bound as resolve_column_node binds it */
+const ColumnBinding* bind_column_node(QueryContext* ctx, ASTNode* node, int table_index);
 
 /* result building */
 ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count);
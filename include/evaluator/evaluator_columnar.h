@@ -0,0 +1,33 @@
+#ifndef EVALUATOR_COLUMNAR_H
+#define EVALUATOR_COLUMNAR_H
+
+#include <stdbool.h>
+#include "evaluator.h"
+#include "csv_columns.h"
+#include "parser.h"
+
+/* column of the first table an identifier reads on every row, the one resolve_column
+ * finds for it. -1 if it could resolve to anything else, such as an outer row */
+int columnar_column_index(QueryContext* ctx, const char* name);
+
+/* typed vector of a column of the first table, NULL if the column mixes types */
+const ColumnVector* columnar_vector(QueryContext* ctx, int col);
+
+/* the same for an operator reading row_count rows of the first table, NULL unless the vector
+ * is built already or the rows are at least half of the table */
+const ColumnVector* columnar_vector_for(QueryContext* ctx, int col, int row_count);
+
+/* rows the batch WHERE evaluator works on at a time */
+#define COLUMNAR_BATCH_SIZE 1024
+
+/* evaluate a WHERE clause on count rows of the first table from start, at most
+ * COLUMNAR_BATCH_SIZE. writes the offsets from start of the rows passing it to sel in order
+ * and returns how many there are. comparisons and arithmetic over typed columns run on the
+ * whole batch, anything else goes through evaluate_condition for the rows still selected */
+int columnar_filter_batch(QueryContext* ctx, ASTNode* where, int start, int count, int* sel);
+
+/* stable sort of rows on column col comparing like value_compare, returns false and
+ * leaves the rows alone if the column is not typed */
+bool columnar_sort_rows(Row* rows, int row_count, int col, bool descending);
+
+#endif /* EVALUATOR_COLUMNAR_H */
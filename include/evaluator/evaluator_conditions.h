@@ -7,4 +7,7 @@
 /* condition evaluation */
 bool evaluate_condition(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index);
 
+/* the same walking the tree instead of running the compiled program */
+bool evaluate_condition_tree(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index);
+
 #endif /* EVALUATOR_CONDITIONS_H */
@@ -12,8 +12,10 @@ void context_free(QueryContext* ctx);
 /* table management */
 CsvTable* load_table_from_string(const char* filename);
 TableRef* context_get_table(QueryContext* ctx, const char* alias);
+void context_new_scope(QueryContext* ctx);
 
 /* column resolution */
-Value* resolve_column(QueryContext* ctx, const char* column_name, Row* current_row, int table_index);
+const Value* resolve_column(QueryContext* ctx, const char* column_name, Row* current_row, int table_index);
+const Value* resolve_column_node(QueryContext* ctx, ASTNode* node, Row* current_row, int table_index);
 
 #endif /* EVALUATOR_CORE_H */
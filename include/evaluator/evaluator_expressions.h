@@ -7,4 +7,17 @@
 /* expression evaluation */
 Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index);
 
+/* the same walking the tree instead of running the compiled program */
+Value evaluate_expression_tree(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index);
+
+/* operator character of an arithmetic operator string, 0 if it is none of + - * / % & | ^ */
+char arithmetic_operator(const char* op);
+
+/* result of a unary operator, unary plus returns the operand itself */
+Value unary_value(const char* op, const Value* operand);
+
+/* result of a binary arithmetic operator. numbers only, anything else and a division
+ * by zero give NULL. an unknown operator gives 0 */
+Value arithmetic_value(char op, const Value* left, const Value* right);
+
 #endif /* EVALUATOR_EXPRESSIONS_H */
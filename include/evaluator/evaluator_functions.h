@@ -3,7 +3,45 @@
 
 #include "evaluator.h"
 
-/* scalar function evaluation */
+/* scalar functions, resolved from their name once so calls dispatch on the id */
+typedef enum {
+    SCALAR_UNKNOWN = -1,
+    SCALAR_CONCAT,
+    SCALAR_LOWER,
+    SCALAR_UPPER,
+    SCALAR_LENGTH,
+    SCALAR_SUBSTRING,
+    SCALAR_REPLACE,
+    SCALAR_COALESCE,
+    SCALAR_POWER,
+    SCALAR_SQRT,
+    SCALAR_CEIL,
+    SCALAR_CEILING,
+    SCALAR_FLOOR,
+    SCALAR_ROUND,
+    SCALAR_ABS,
+    SCALAR_EXP,
+    SCALAR_LN,
+    SCALAR_LOG,
+    SCALAR_MOD,
+    SCALAR_DATE,
+    SCALAR_CURRENT_DATE,
+    SCALAR_YEAR,
+    SCALAR_MONTH,
+    SCALAR_DAY,
+    SCALAR_DAYOFWEEK,
+    SCALAR_DAYOFYEAR,
+    SCALAR_DATE_ADD,
+    SCALAR_DATE_SUB,
+    SCALAR_DATE_DIFF,
+    SCALAR_DATE_FORMAT,
+} ScalarFunction;
+
+/* function of a name, ignoring case. SCALAR_UNKNOWN for anything else, aggregates included */
+ScalarFunction scalar_function_lookup(const char* func_name);
+
+/* scalar function evaluation, a result string is owned by the caller */
 Value evaluate_scalar_function(const char* func_name, Value* args, int arg_count);
+Value evaluate_scalar_function_id(ScalarFunction function, Value* args, int arg_count);
 
 #endif /* EVALUATOR_FUNCTIONS_H */
@@ -0,0 +1,68 @@
+#ifndef EVALUATOR_HASH_H
+#define EVALUATOR_HASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "csv_reader.h"
+
+/* typed hashing of values, integral doubles hash like the matching integer
+ * so that 1 and 1.0 land in the same bucket (value_compare treats them as equal) */
+uint64_t value_hash(const Value* value);
+uint64_t hash_combine(uint64_t seed, uint64_t hash);
+
+/* typed equality consistent with value_hash, NULL equals NULL and
+ * values of non comparable types (string vs number) are never equal */
+bool value_equal(const Value* a, const Value* b);
+
+/* hash and equality of a tuple of values, used for composite keys */
+uint64_t value_tuple_hash(const Value* values, int count);
+bool value_tuple_equal(const Value* a, const Value* b, int count);
+
+/* open addressing hash table keyed on typed value tuples, every distinct key
+ * gets a dense entry index (0, 1, 2, ...) in insertion order */
+typedef struct {
+    int* slots;           // entry index per slot, -1 if empty
+    int slot_count;       // power of two
+    uint64_t* hashes;     // hash per entry
+    Value* keys;          // key_count values per entry, owned by the table
+    int key_count;
+    int entry_count;
+    int entry_capacity;
+} ValueHashTable;
+
+void value_hash_table_init(ValueHashTable* table, int key_count);
+void value_hash_table_free(ValueHashTable* table);
+
+/* find the entry for a key, -1 if not present */
+int value_hash_table_find(const ValueHashTable* table, const Value* key);
+
+/* find the entry for a key or add it (deep copying the key), *inserted tells which happened */
+int value_hash_table_insert(ValueHashTable* table, const Value* key, bool* inserted);
+
+/* key values of an entry */
+static inline const Value* value_hash_table_key(const ValueHashTable* table, int entry) {
+    return &table->keys[(size_t)entry * table->key_count];
+}
+
+/* open addressing set of rows compared on their first column_count values, with the same
+ * equality as the keys above. rows are not copied, they must stay in place while in the set */
+typedef struct {
+    int* slots;           // entry index per slot, -1 if empty
+    int slot_count;       // power of two
+    uint64_t* hashes;     // hash per entry
+    Row** rows;           // row per entry
+    int column_count;
+    int entry_count;
+    int entry_capacity;
+} RowHashSet;
+
+void row_hash_set_init(RowHashSet* set, int column_count);
+void row_hash_set_free(RowHashSet* set);
+
+/* find the entry equal to a row, -1 if not present */
+int row_hash_set_find(const RowHashSet* set, Row* row);
+
+/* find the entry equal to a row or add the row, *inserted tells which happened */
+int row_hash_set_insert(RowHashSet* set, Row* row, bool* inserted);
+
+#endif /* EVALUATOR_HASH_H */
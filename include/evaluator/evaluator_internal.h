@@ -7,8 +7,11 @@
 #include "parser.h"
 #include "csv_reader.h"
 
-/* from evaluator.c */
-ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable* outer_table);
+/* from evaluator.c, a run given for a subquery collects the outer columns it reads and
+ * keeps its FROM table for the next evaluation, see SubqueryRun */
+struct SubqueryRun;
+ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable* outer_table,
+                                   struct SubqueryRun* run);
 
 /* from evaluator_aggregates.c */
 int find_column_index(CsvTable* table, const char* col_name);
@@ -4,6 +4,11 @@
 #include "evaluator.h"
 #include "csv_reader.h"
 #include "parser.h"
+#include "evaluator/evaluator_projection.h"
+#include "evaluator/evaluator_pushdown.h"
+
+/* load config of a table read by a query, lazy with the column and filter pushdown applied */
+CsvConfig query_load_config(const ColumnRefs* refs, const PushdownFilters* filters);
 
 /* JOIN operations */
 CsvTable* load_from_table(ASTNode* from_clause, const char** out_alias, QueryContext* ctx);
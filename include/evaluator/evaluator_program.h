@@ -0,0 +1,23 @@
+#ifndef EVALUATOR_PROGRAM_H
+#define EVALUATOR_PROGRAM_H
+
+#include <stdbool.h>
+#include "evaluator.h"
+#include "parser.h"
+
+/* an expression or condition tree lowered to register bytecode. operators, functions and
+ * comparisons are resolved to opcodes and literals parsed once when it is compiled, column
+ * reads go through the identifier bindings. subtrees that only depend on literals are folded
+ * into constants, so they cost nothing per row. compiled on first use and kept in the root node */
+typedef struct Program Program;
+
+/* evaluate a literal, arithmetic, function or CASE expression through its program. returns false
+ * for any other node, which the caller evaluates by walking the tree */
+bool program_evaluate(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index, Value* result);
+
+/* the same for a condition node */
+bool program_check(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index, bool* result);
+
+void program_free(Program* program);
+
+#endif /* EVALUATOR_PROGRAM_H */
@@ -0,0 +1,23 @@
+#ifndef EVALUATOR_PROJECTION_H
+#define EVALUATOR_PROJECTION_H
+
+#include <stdbool.h>
+#include "parser.h"
+
+/* set of column names referenced anywhere in a query */
+typedef struct {
+    char** names;
+    int count;
+    int capacity;
+    bool all_columns;     // true if the query uses SELECT * somewhere
+} ColumnRefs;
+
+/* collect column references from a query AST (including subqueries) */
+void column_refs_collect(ColumnRefs* refs, ASTNode* node);
+void column_refs_free(ColumnRefs* refs);
+
+/* check if a table column may be referenced, matching is done on the unqualified
+ * column name so "u.name", "joined.u.name" and "name" all refer to "name" */
+bool column_refs_match(const ColumnRefs* refs, const char* column_name);
+
+#endif /* EVALUATOR_PROJECTION_H */
@@ -0,0 +1,21 @@
+#ifndef EVALUATOR_PUSHDOWN_H
+#define EVALUATOR_PUSHDOWN_H
+
+#include "csv_reader.h"
+#include "parser.h"
+
+/* WHERE clause conjuncts that csv_load can check on the raw fields of a row */
+typedef struct {
+    RowFilter* filters;   // values are owned, column names point into the AST
+    int count;
+    int capacity;
+} PushdownFilters;
+
+/* collect the conjuncts of shape `column <op> literal`, `column IN (literals)` and
+ * `column LIKE|ILIKE 'pattern'` with any literal pattern, qualified columns must use
+ * table_alias. the WHERE clause is still evaluated afterwards, a pushed filter only
+ * drops rows it would reject */
+void pushdown_collect(PushdownFilters* filters, ASTNode* where, const char* table_alias);
+void pushdown_free(PushdownFilters* filters);
+
+#endif /* EVALUATOR_PUSHDOWN_H */
@@ -0,0 +1,36 @@
+#ifndef EVALUATOR_SORT_H
+#define EVALUATOR_SORT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "csv_reader.h"
+
+/* one ORDER BY key resolved to a column of the rows being sorted */
+typedef struct {
+    int column;
+    bool descending;
+    bool nulls_first;
+} SortKeySpec;
+
+/* normalized sort key of a row, its keys encoded so that memcmp of two encodings orders
+ * them like the ORDER BY would. numbers compare by value whatever their type, then come
+ * dates and strings, a value of one of them never equals one of another */
+typedef struct {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} SortKey;
+
+void sort_key_init(SortKey* key);
+void sort_key_free(SortKey* key);
+
+/* append the encoding of one key value */
+void sort_key_append(SortKey* key, const Value* value, bool descending, bool nulls_first);
+
+/* order of two encodings, memcmp with the shorter one first */
+int sort_key_compare(const unsigned char* a, size_t a_length, const unsigned char* b, size_t b_length);
+
+/* sort rows on the given keys by their encodings, rows with equal keys keep their order */
+void sort_rows_by_keys(Row* rows, int row_count, const SortKeySpec* keys, int key_count);
+
+#endif /* EVALUATOR_SORT_H */
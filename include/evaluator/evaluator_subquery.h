@@ -0,0 +1,51 @@
+#ifndef EVALUATOR_SUBQUERY_H
+#define EVALUATOR_SUBQUERY_H
+
+#include <stdbool.h>
+#include "evaluator.h"
+#include "parser.h"
+#include "csv_reader.h"
+
+/* columns of the outer row a subquery read while it was evaluated, each listed once.
+ * evaluation only depends on the values it reads, so a subquery that read none of them
+ * gives the same result for every outer row */
+typedef struct OuterRefs {
+    int* columns;
+    int count;
+    int capacity;
+} OuterRefs;
+
+void outer_refs_add(OuterRefs* refs, int column);
+void outer_refs_free(OuterRefs* refs);
+
+/* what one evaluation of a subquery hands back to the next one. its FROM table depends on
+ * nothing but the query, so the first evaluation loads it and the next ones reuse it */
+typedef struct SubqueryRun {
+    OuterRefs refs;            // outer columns read by the last evaluation
+    CsvTable* source;          // FROM table, owned by the run once loaded
+    const char* source_alias;
+} SubqueryRun;
+
+void subquery_run_free(SubqueryRun* run);
+
+/* subquery results a context keeps until it is freed */
+typedef struct SubqueryCache SubqueryCache;
+
+void subquery_cache_free(SubqueryCache* cache);
+
+/* value of a scalar subquery for a row of outer_table, NULL unless it returns exactly one row
+ * and one column, which is reported when report_errors is set. an aggregate over one table
+ * correlated by inner.col = outer.col conditions is evaluated once for all rows, grouped by
+ * those columns. other results are memoized in the context by the values of the outer columns
+ * the subquery reads, so rows agreeing on them share one evaluation. released with value_free,
+ * a string is borrowed from the context */
+Value evaluate_scalar_subquery(QueryContext* ctx, ASTNode* subquery, Row* current_row, CsvTable* outer_table,
+                               bool report_errors);
+
+/* value IN (subquery), or NOT IN when negated. an uncorrelated subquery runs once per context
+ * and its single column is kept as a hash set, a correlated one runs again for every row.
+ * values match as in a literal IN list, by value_compare with NULL equal to NULL */
+bool evaluate_in_subquery(QueryContext* ctx, ASTNode* subquery, const Value* value, bool negated,
+                          Row* current_row, int table_index);
+
+#endif /* EVALUATOR_SUBQUERY_H */
@@ -9,15 +9,16 @@ void value_deep_copy(Value* dst, const Value* src);
 
 /* result building */
 ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count);
+ResultSet* build_result_top_n(QueryContext* ctx, Row** filtered_rows, int row_count, ASTNode* order_by, int n);
 Row** filter_rows(QueryContext* ctx, ASTNode* where_clause, int* out_filtered_count);
 
 /* result processing */
-void sort_result(ResultSet* result, ASTNode* select_node, const char* column_spec, bool descending);
+void sort_result(ResultSet* result, ASTNode* select_node, ASTNode* order_by);
 void apply_limit_offset(ResultSet* result, int limit, int offset);
 void apply_distinct(ResultSet* result);
 void free_row_range(Row* rows, int start, int end);
 
-/* set operations */
+/* set operations, rows may be moved out of left and right which are then only fit for csv_free */
 ResultSet* set_union(ResultSet* left, ResultSet* right, bool include_duplicates);
 ResultSet* set_intersect(ResultSet* left, ResultSet* right);
 ResultSet* set_except(ResultSet* left, ResultSet* right);
@@ -0,0 +1,24 @@
+#ifndef LIKE_H
+#define LIKE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* LIKE pattern match of length delimited strings, % and _ wildcards */
+bool match_pattern(const char* str, size_t str_len, const char* pattern, size_t pattern_len,
+                   bool case_sensitive);
+
+/* a LIKE pattern prepared once for matching many strings. a pattern made of text and %
+ * wildcards is matched by comparing and searching the text between them, an exact text,
+ * a prefix, a suffix or a single substring without any backtracking. a pattern holding _
+ * is left to match_pattern */
+typedef struct LikePattern LikePattern;
+
+LikePattern* like_compile(const char* pattern, size_t pattern_len, bool case_sensitive);
+
+/* the same answer match_pattern gives for the pattern */
+bool like_match(const LikePattern* like, const char* str, size_t str_len);
+
+void like_free(LikePattern* like);
+
+#endif
@@ -49,8 +49,26 @@ typedef enum {
     SET_OP_EXCEPT,
 } SetOpType;
 
-/* forward declaration */
+/* forward declarations */
 typedef struct ASTNode ASTNode;
+struct Program;
+
+/* what an identifier resolves to, see resolve_column_node */
+typedef enum {
+    BINDING_NONE,          // nothing, reads as NULL
+    BINDING_ROW,           // column of the row being evaluated
+    BINDING_OUTER,         // column of the outer row of a correlated subquery
+    BINDING_SELECT_ALIAS,  // SELECT expression named by an AS alias
+} BindingKind;
+
+/* resolution of an identifier cached by the evaluator, valid for the evaluation scope
+ * and table it was made in. scope 0 means not bound yet */
+typedef struct {
+    unsigned int scope;
+    int table_index;
+    BindingKind kind;
+    int index;             // column, or SELECT expression for BINDING_SELECT_ALIAS
+} ColumnBinding;
 
 struct ASTNode {
     int refcount;
@@ -104,8 +122,10 @@ struct ASTNode {
         } list;
         
         struct {
-            char* column;
-            bool descending;
+            char** columns;       // sort keys, most significant first
+            bool* descending;     // direction of each key
+            bool* nulls_first;    // NULL placement of each key, by default first ascending and last descending
+            int column_count;
         } order_by;
         
         struct {
@@ -198,6 +218,8 @@ struct ASTNode {
         char* identifier;  // used for generic identifiers, not GROUP BY
         char* alias;
     };
+    ColumnBinding binding;  // identifiers only
+    struct Program* program;  // bytecode the evaluator compiled the node to, see evaluator_program.h
 };
 
 /* as we will use reference counting for memory management, we need utility functions to handle it */
@@ -7,5 +7,6 @@
 char* cq_strndup(const char* s, size_t n);
 size_t cq_strlcat(char* dst, const char* src, size_t size);
 char* cq_strcasestr(const char* haystack, const char* needle);
+const char* cq_memmem(const char* haystack, size_t haystack_len, const char* needle, size_t needle_len);
 
 #endif
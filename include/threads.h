@@ -0,0 +1,14 @@
+#ifndef _THREADS_H
+#define _THREADS_H
+
+/* work function called once per task index */
+typedef void (*ParallelTask)(void* ctx, int index);
+
+/* number of online cpus, at least 1 */
+int cq_cpu_count(void);
+
+/* run task(ctx, i) for i in [0, count) each on its own thread and wait for all of them,
+ * tasks whose thread cannot be started run on the calling thread */
+void cq_parallel_for(int count, ParallelTask task, void* ctx);
+
+#endif
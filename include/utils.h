@@ -1,6 +1,7 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdio.h>
 #include "csv_reader.h"
 #include "string_utils.h"
 
@@ -13,6 +14,10 @@ typedef CsvTable ResultSet;
 char* skipWhitespaces(char* str);
 void print_help(const char* program_name);
 void write_csv_file(const char* filename, ResultSet* result, char delimiter);
+
+/* header line and rows of write_csv_file, for results written a batch at a time */
+void write_csv_header(FILE* f, ResultSet* result, char delimiter);
+void write_csv_rows(FILE* f, ResultSet* result, char delimiter);
 char* read_query_from_file(const char* filename);
 char* read_query_from_stdin(void);
 
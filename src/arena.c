@@ -0,0 +1,125 @@
+/* arena.c - bump allocator for table values and strings */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+#define ARENA_MIN_BLOCK (64 * 1024)
+#define ARENA_MAX_BLOCK (4 * 1024 * 1024)
+
+/* most strictly aligned of the types stored in an arena, C99 has no max_align_t */
+typedef union {
+    long long ll;
+    long double ld;
+    double d;
+    void* p;
+} ArenaAlign;
+
+#define ARENA_ALIGN sizeof(ArenaAlign)
+
+struct ArenaBlock {
+    ArenaBlock* next;
+    size_t size;
+    size_t used;
+    ArenaAlign data[];
+};
+
+Arena* arena_create(void) {
+    Arena* arena = calloc(1, sizeof(Arena));
+    arena->next_size = ARENA_MIN_BLOCK;
+    return arena;
+}
+
+void arena_free(Arena* arena) {
+    if (!arena) return;
+    
+    ArenaBlock* block = arena->head;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+void arena_reset(Arena* arena) {
+    if (!arena || !arena->head) return;
+    
+    ArenaBlock* block = arena->head->next;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+}
+
+/* helper: start a new block with room for at least size bytes */
+static ArenaBlock* arena_grow(Arena* arena, size_t size) {
+    size_t block_size = arena->next_size;
+    if (block_size < size) block_size = size;
+    if (arena->next_size < ARENA_MAX_BLOCK) arena->next_size *= 2;
+    
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + block_size);
+    if (!block) return NULL;
+    block->size = block_size;
+    block->used = 0;
+    
+    // an oversized request gets its own block behind the head, the head keeps filling up
+    if (arena->head && size > ARENA_MAX_BLOCK / 4) {
+        block->next = arena->head->next;
+        arena->head->next = block;
+    } else {
+        block->next = arena->head;
+        arena->head = block;
+    }
+    return block;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    if (size == 0) size = ARENA_ALIGN;
+    
+    ArenaBlock* block = arena->head;
+    if (!block || block->size - block->used < size) {
+        block = arena_grow(arena, size);
+        if (!block) return NULL;
+    }
+    
+    void* ptr = (char*)block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+void* arena_calloc(Arena* arena, size_t count, size_t size) {
+    void* ptr = arena_alloc(arena, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+char* arena_strndup(Arena* arena, const char* s, size_t n) {
+    char* copy = arena_alloc(arena, n + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, n);
+    copy[n] = '\0';
+    return copy;
+}
+
+void arena_merge(Arena* dst, Arena* src) {
+    if (!src->head) return;
+    
+    // the blocks of src go behind the head of dst
+    ArenaBlock* tail = src->head;
+    while (tail->next) tail = tail->next;
+    
+    if (dst->head) {
+        tail->next = dst->head->next;
+        dst->head->next = src->head;
+    } else {
+        dst->head = src->head;
+    }
+    src->head = NULL;
+}
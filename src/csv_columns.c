@@ -0,0 +1,169 @@
+/* csv_columns.c - typed column vectors with validity bitmaps */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "csv_reader.h"
+#include "csv_columns.h"
+#include "date_utils.h"
+
+static size_t entry_size(ValueType type) {
+    switch (type) {
+        case VALUE_TYPE_INTEGER: return sizeof(long long);
+        case VALUE_TYPE_DOUBLE: return sizeof(double);
+        case VALUE_TYPE_DATE: return sizeof(DateValue);
+        case VALUE_TYPE_STRING: return sizeof(StringRef);
+        default: return 0;
+    }
+}
+
+/* helper: store a non NULL value at entry i, false if its type does not fit the vector */
+static bool store_entry(ColumnVector* vector, int i, const Value* value) {
+    if (vector->type == VALUE_TYPE_NULL) {
+        // the first non NULL entry decides the type, entries before it are NULL
+        vector->type = value->type;
+        vector->data = calloc((size_t)vector->length, entry_size(value->type));
+    } else if (vector->type == VALUE_TYPE_INTEGER && value->type == VALUE_TYPE_DOUBLE) {
+        // widen the integers stored so far, both types are 8 bytes
+        for (int j = 0; j < i; j++) {
+            vector->doubles[j] = (double)vector->ints[j];
+        }
+        vector->type = VALUE_TYPE_DOUBLE;
+        vector->widened = true;
+    }
+    
+    switch (vector->type) {
+        case VALUE_TYPE_INTEGER:
+            if (value->type != VALUE_TYPE_INTEGER) return false;
+            vector->ints[i] = value->int_value;
+            return true;
+        case VALUE_TYPE_DOUBLE:
+            if (value->type == VALUE_TYPE_INTEGER) {
+                vector->doubles[i] = (double)value->int_value;
+                vector->widened = true;
+                return true;
+            }
+            if (value->type != VALUE_TYPE_DOUBLE) return false;
+            vector->doubles[i] = value->double_value;
+            return true;
+        case VALUE_TYPE_DATE:
+            if (value->type != VALUE_TYPE_DATE) return false;
+            vector->dates[i] = value->date_value;
+            return true;
+        case VALUE_TYPE_STRING:
+            if (value->type != VALUE_TYPE_STRING) return false;
+            vector->strings[i].data = value->string_value;
+            vector->strings[i].length = value->string_length;
+            return true;
+        default:
+            return false;
+    }
+}
+
+ColumnVector* column_vector_build(Row* rows, int row_count, int col) {
+    ColumnVector* vector = calloc(1, sizeof(ColumnVector));
+    vector->type = VALUE_TYPE_NULL;
+    vector->typed = true;
+    vector->length = row_count;
+    vector->validity = calloc(row_count > 0 ? ((size_t)row_count + 63) / 64 : 1, sizeof(uint64_t));
+    
+    for (int i = 0; i < row_count; i++) {
+        Value value = row_value_peek(&rows[i], col);
+        if (value.type == VALUE_TYPE_NULL) {
+            vector->null_count++;
+            continue;
+        }
+        
+        if (!store_entry(vector, i, &value)) {
+            // mixed types, the rows stay the only representation of this column
+            free(vector->data);
+            vector->data = NULL;
+            vector->typed = false;
+            break;
+        }
+        vector->validity[i >> 6] |= (uint64_t)1 << (i & 63);
+    }
+    
+    return vector;
+}
+
+void column_vector_free(ColumnVector* vector) {
+    if (!vector) return;
+    
+    free(vector->data);
+    free(vector->validity);
+    free(vector);
+}
+
+static int compare_strings(const StringRef* a, const char* b, size_t b_length) {
+    size_t len = a->length < b_length ? a->length : b_length;
+    int cmp = len > 0 ? memcmp(a->data, b, len) : 0;
+    if (cmp != 0) return cmp;
+    if (a->length == b_length) return 0;
+    return a->length < b_length ? -1 : 1;
+}
+
+int column_vector_compare(const ColumnVector* vector, int a, int b) {
+    switch (vector->type) {
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_DOUBLE: {
+            double x = column_vector_number(vector, a);
+            double y = column_vector_number(vector, b);
+            return (x > y) - (x < y);
+        }
+        case VALUE_TYPE_DATE:
+            return compare_dates(vector->dates[a], vector->dates[b]);
+        case VALUE_TYPE_STRING:
+            return compare_strings(&vector->strings[a], vector->strings[b].data, vector->strings[b].length);
+        default:
+            return 0;
+    }
+}
+
+int column_vector_compare_value(const ColumnVector* vector, int i, const Value* value) {
+    if (value->type == VALUE_TYPE_NULL) return 1;
+    
+    switch (vector->type) {
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_DOUBLE: {
+            double y;
+            if (value->type == VALUE_TYPE_INTEGER) y = (double)value->int_value;
+            else if (value->type == VALUE_TYPE_DOUBLE) y = value->double_value;
+            else return 0;
+            
+            double x = column_vector_number(vector, i);
+            return (x > y) - (x < y);
+        }
+        case VALUE_TYPE_DATE:
+            if (value->type != VALUE_TYPE_DATE) return 0;
+            return compare_dates(vector->dates[i], value->date_value);
+        case VALUE_TYPE_STRING:
+            if (value->type != VALUE_TYPE_STRING) return 0;
+            return compare_strings(&vector->strings[i], value->string_value, value->string_length);
+        default:
+            return 0;
+    }
+}
+
+const ColumnVector* csv_column_vector(CsvTable* table, int col) {
+    if (!table || col < 0 || col >= table->column_count) return NULL;
+    
+    if (!table->vectors) {
+        table->vectors = calloc((size_t)table->column_count, sizeof(ColumnVector*));
+    }
+    if (!table->vectors[col]) {
+        table->vectors[col] = column_vector_build(table->rows, table->row_count, col);
+    }
+    return table->vectors[col];
+}
+
+void csv_drop_column_vectors(CsvTable* table) {
+    if (!table || !table->vectors) return;
+    
+    for (int col = 0; col < table->column_count; col++) {
+        column_vector_free(table->vectors[col]);
+    }
+    free(table->vectors);
+    table->vectors = NULL;
+}
@@ -8,10 +8,17 @@
 
 
 #include "csv_reader.h"
+#include "csv_columns.h"
 #include "string_utils.h"
 #include "utils.h"
 #include "date_utils.h"
 #include "mmap.h"
+#include "threads.h"
+#include "csv_scanner.h"
+#include "like.h"
+
+/* files smaller than this per worker are loaded on a single thread */
+#define CSV_PARALLEL_MIN_CHUNK (4 * 1024 * 1024)
 
 
 /* CSV configuration used in tests */
@@ -20,6 +27,14 @@ CsvConfig csv_config_default(void) {
     config.delimiter = ',';
     config.quote = '"';
     config.has_header = true;
+    config.threads = 0;
+    config.lazy = false;
+    config.projection = NULL;
+    config.projection_count = 0;
+    config.filters = NULL;
+    config.filter_count = 0;
+    config.editable = false;
+    config.columnar = false;
     return config;
 }
 
@@ -41,17 +56,8 @@ static void trim_whitespace(char* str) {
     }
 }
 
-/* helper: ensure dynamic array capacity */
-static void* ensure_field_capacity(void* array, int* capacity, int current_count, size_t element_size) {
-    if (current_count >= *capacity) {
-        *capacity *= 2;
-        return realloc(array, element_size * (*capacity));
-    }
-    return array;
-}
-
 /* helper: convert value to numeric (double) */
-static double value_to_numeric(Value* value) {
+static double value_to_numeric(const Value* value) {
     if (!value) return 0.0;
     
     switch (value->type) {
@@ -59,8 +65,14 @@ static double value_to_numeric(Value* value) {
             return (double)value->int_value;
         case VALUE_TYPE_DOUBLE:
             return value->double_value;
-        case VALUE_TYPE_STRING:
-            return strtod(value->string_value, NULL);
+        case VALUE_TYPE_STRING: {
+            // borrowed strings are not terminated, strtod needs a copy
+            char buffer[64];
+            size_t len = value->string_length < sizeof(buffer) - 1 ? value->string_length : sizeof(buffer) - 1;
+            memcpy(buffer, value->string_value, len);
+            buffer[len] = '\0';
+            return strtod(buffer, NULL);
+        }
         default:
             return 0.0;
     }
@@ -69,12 +81,44 @@ static double value_to_numeric(Value* value) {
 /* value utilities */
 void value_free(Value* value) {
     if (value && value->type == VALUE_TYPE_STRING && value->string_value) {
-        free(value->string_value);
+        if (!value->borrowed) free(value->string_value);
         value->string_value = NULL;
     }
 }
 
-char* value_to_string(Value* value) {
+Value value_string(char* str) {
+    Value value;
+    value.type = VALUE_TYPE_STRING;
+    value.borrowed = false;
+    value.string_value = str;
+    value.string_length = str ? strlen(str) : 0;
+    return value;
+}
+
+Value value_string_borrowed(const char* str, size_t len) {
+    Value value;
+    value.type = VALUE_TYPE_STRING;
+    value.borrowed = true;
+    value.string_value = (char*)str;
+    value.string_length = len;
+    return value;
+}
+
+Value value_borrow(const Value* src) {
+    Value value = *src;
+    if (value.type == VALUE_TYPE_STRING) value.borrowed = true;
+    return value;
+}
+
+int value_string_compare(const Value* a, const Value* b) {
+    size_t len = a->string_length < b->string_length ? a->string_length : b->string_length;
+    int cmp = len > 0 ? memcmp(a->string_value, b->string_value, len) : 0;
+    if (cmp != 0) return cmp;
+    if (a->string_length == b->string_length) return 0;
+    return a->string_length < b->string_length ? -1 : 1;
+}
+
+char* value_to_string(const Value* value) {
     if (!value) return strdup("NULL");
     
     char buffer[256];
@@ -90,12 +134,12 @@ char* value_to_string(Value* value) {
         case VALUE_TYPE_DATE:
             return format_date(value->date_value, DATE_FORMAT_ISO);
         case VALUE_TYPE_STRING:
-            return strdup(value->string_value ? value->string_value : "");
+            return value->string_value ? cq_strndup(value->string_value, value->string_length) : strdup("");
     }
     return strdup("");
 }
 
-int value_compare(Value* a, Value* b) {
+int value_compare(const Value* a, const Value* b) {
     if (!a || !b) return 0;
     
     // handle NULL comparisons
@@ -122,7 +166,7 @@ int value_compare(Value* a, Value* b) {
     
     // handle string comparisons
     if (a->type == VALUE_TYPE_STRING && b->type == VALUE_TYPE_STRING) {
-        return strcmp(a->string_value, b->string_value);
+        return value_string_compare(a, b);
     }
     
     // different types that aren't comparable
@@ -192,9 +236,12 @@ static ValueType infer_type(const char* str, size_t len) {
     return VALUE_TYPE_STRING;
 }
 
-Value parse_value(const char* str, size_t len) {
+/* parse a field, strings are trimmed and then borrowed from str, copied into the arena,
+ * or malloc'd without one */
+static Value parse_field(Arena* arena, bool borrow, const char* str, size_t len) {
     Value value;
     value.type = VALUE_TYPE_NULL;  // initialize
+    value.borrowed = false;
     value.int_value = 0;  // initialize union
     
     ValueType type = infer_type(str, len);
@@ -230,19 +277,41 @@ Value parse_value(const char* str, size_t len) {
             }
             break;
         }
-        case VALUE_TYPE_STRING:
-            value.string_value = cq_strndup(str, len);
-            trim_whitespace(value.string_value);
+        case VALUE_TYPE_STRING: {
+            // trim before copying, only the kept bytes are duplicated
+            while (len > 0 && *str && isspace((unsigned char)*str)) {
+                str++;
+                len--;
+            }
+            while (len > 0 && isspace((unsigned char)str[len - 1])) len--;
+            
+            if (borrow) {
+                value = value_string_borrowed(str, len);
+            } else {
+                value.string_value = arena ? arena_strndup(arena, str, len) : cq_strndup(str, len);
+                value.string_length = len;
+                value.borrowed = arena != NULL;
+            }
             break;
+        }
     }
     
     return value;
 }
 
+Value parse_value(const char* str, size_t len) {
+    return parse_field(NULL, false, str, len);
+}
+
+Value parse_value_borrowed(const char* str, size_t len) {
+    return parse_field(NULL, true, str, len);
+}
+
 /* deep copy a value */
 Value value_copy(const Value* src) {
     Value dst;
     dst.type = src->type;
+    dst.borrowed = false;
     
     switch (src->type) {
         case VALUE_TYPE_NULL:
@@ -258,7 +327,8 @@ Value value_copy(const Value* src) {
             dst.date_value = src->date_value;  // struct copy
             break;
         case VALUE_TYPE_STRING:
-            dst.string_value = src->string_value ? strdup(src->string_value) : NULL;
+            dst.string_value = src->string_value ? cq_strndup(src->string_value, src->string_length) : NULL;
+            dst.string_length = src->string_length;
             break;
     }
     
@@ -275,12 +345,36 @@ static void add_row(CsvTable* table, Row row) {
     table->rows[table->row_count++] = row;
 }
 
-static void parse_line(CsvTable* table, const char* line_start, const char* line_end, bool is_header) {
+/* scratch buffers reused for every line parsed by one loader */
+typedef struct {
+    const char** fields;
+    size_t* field_lengths;
+    int field_count;
+    int field_capacity;
+    LineScan scan;
+} LineFields;
+
+static void line_fields_add(LineFields* lf, const char* start, size_t len) {
+    if (lf->field_count >= lf->field_capacity) {
+        lf->field_capacity = lf->field_capacity == 0 ? 16 : lf->field_capacity * 2;
+        lf->fields = realloc(lf->fields, sizeof(char*) * lf->field_capacity);
+        lf->field_lengths = realloc(lf->field_lengths, sizeof(size_t) * lf->field_capacity);
+    }
+    lf->fields[lf->field_count] = start;
+    lf->field_lengths[lf->field_count] = len;
+    lf->field_count++;
+}
+
+static void line_fields_free(LineFields* lf) {
+    free(lf->fields);
+    free(lf->field_lengths);
+    line_scan_free(&lf->scan);
+}
+
+/* byte at a time field splitter, the reference behaviour for every line */
+static void split_fields_scalar(CsvTable* table, const char* line_start, const char* line_end, LineFields* lf) {
     const char* ptr = line_start;
-    int field_count = 0;
-    int field_capacity = 16;
-    char** fields = malloc(sizeof(char*) * field_capacity);
-    size_t* field_lengths = malloc(sizeof(size_t) * field_capacity);
+    lf->field_count = 0;
     
     while (ptr < line_end) {
         // skip leading whitespace
@@ -323,19 +417,130 @@ static void parse_line(CsvTable* table, const char* line_start, const char* line
             field_len = ptr - field_start;
         }
         
-        // store field
-        fields = ensure_field_capacity(fields, &field_capacity, field_count, sizeof(char*));
-        field_lengths = ensure_field_capacity(field_lengths, &field_capacity, field_count, sizeof(size_t));
-        
-        fields[field_count] = (char*)field_start;
-        field_lengths[field_count] = field_len;
-        field_count++;
+        line_fields_add(lf, field_start, field_len);
         
         // skip delimiter
         if (ptr < line_end && *ptr == table->delimiter) {
             ptr++;
         }
     }
+}
+
+/* build fields from the separators found by csv_scan_line, returns false when the line has a
+ * shape the scalar splitter treats differently (unterminated quotes, quotes inside a field) */
+static bool split_fields_from_scan(CsvTable* table, const char* line_start, const char* line_end, LineFields* lf) {
+    const LineScan* scan = &lf->scan;
+    lf->field_count = 0;
+    
+    for (int i = 0; i <= scan->separator_count; i++) {
+        const char* seg_start = i == 0 ? line_start : line_start + scan->separators[i - 1] + 1;
+        const char* seg_end = i == scan->separator_count ? line_end : line_start + scan->separators[i];
+        bool last = (i == scan->separator_count);
+        
+        // skip leading whitespace
+        const char* ptr = seg_start;
+        while (ptr < seg_end && isspace(*ptr)) ptr++;
+        
+        if (ptr >= seg_end) {
+            // a blank segment is an empty field, unless it trails the line
+            if (!last) line_fields_add(lf, ptr, 0);
+            continue;
+        }
+        
+        if (!scan->has_quote) {
+            line_fields_add(lf, ptr, seg_end - ptr);
+            continue;
+        }
+        
+        if (*ptr != table->quote) {
+            // a quote in the middle of an unquoted field is literal text
+            if (memchr(ptr, table->quote, seg_end - ptr)) return false;
+            line_fields_add(lf, ptr, seg_end - ptr);
+            continue;
+        }
+        
+        // quoted field, find the closing quote skipping escaped ones
+        const char* field_start = ++ptr;
+        const char* closing = NULL;
+        while (ptr < seg_end) {
+            if (*ptr == table->quote) {
+                if (ptr + 1 < seg_end && *(ptr + 1) == table->quote) {
+                    ptr += 2;
+                } else {
+                    closing = ptr;
+                    break;
+                }
+            } else {
+                ptr++;
+            }
+        }
+        
+        // anything after the closing quote is ignored, but must not reopen a quote
+        if (!closing || memchr(closing + 1, table->quote, seg_end - closing - 1)) return false;
+        
+        line_fields_add(lf, field_start, closing - field_start);
+    }
+    
+    return true;
+}
+
+/* helper: check if the field at index col has to be parsed */
+static inline bool is_projected(const CsvTable* table, int col) {
+    if (!table->slots) return true;
+    return col < table->column_count && table->slots[col] >= 0;
+}
+
+/* helper: check a field value against one row filter */
+static bool row_filter_match(const RowFilter* filter, Value* value) {
+    switch (filter->op) {
+        case ROW_FILTER_EQ: return value_compare(value, &filter->values[0]) == 0;
+        case ROW_FILTER_NE: return value_compare(value, &filter->values[0]) != 0;
+        case ROW_FILTER_LT: return value_compare(value, &filter->values[0]) < 0;
+        case ROW_FILTER_LE: return value_compare(value, &filter->values[0]) <= 0;
+        case ROW_FILTER_GT: return value_compare(value, &filter->values[0]) > 0;
+        case ROW_FILTER_GE: return value_compare(value, &filter->values[0]) >= 0;
+        case ROW_FILTER_IN:
+            for (int i = 0; i < filter->value_count; i++) {
+                if (value_compare(value, &filter->values[i]) == 0) return true;
+            }
+            return false;
+        case ROW_FILTER_LIKE:
+        case ROW_FILTER_ILIKE:
+            return value->type == VALUE_TYPE_STRING && filter->like &&
+                   like_match(filter->like, value->string_value, value->string_length);
+    }
+    return true;
+}
+
+/* helper: check the split fields of a data line against every row filter of the load */
+static bool row_passes_filters(const CsvTable* table, const LineFields* lf) {
+    for (int i = 0; i < table->filter_count; i++) {
+        const RowFilter* filter = &table->filters[i];
+        int col = filter->column_index;
+        
+        // a field missing from a short line reads as NULL, strings are only looked at
+        Value value = { .type = VALUE_TYPE_NULL };
+        if (col < lf->field_count) {
+            value = parse_field(NULL, true, lf->fields[col], lf->field_lengths[col]);
+        }
+        
+        bool match = row_filter_match(filter, &value);
+        value_free(&value);
+        if (!match) return false;
+    }
+    return true;
+}
+
+static void parse_line(CsvTable* table, const char* line_start, const char* line_end, bool is_header, LineFields* lf) {
+    // whitespace delimiters interact with the leading whitespace skip, keep the scalar rules
+    if (isspace((unsigned char)table->delimiter) ||
+        !split_fields_from_scan(table, line_start, line_end, lf)) {
+        split_fields_scalar(table, line_start, line_end, lf);
+    }
+    
+    int field_count = lf->field_count;
+    const char** fields = lf->fields;
+    size_t* field_lengths = lf->field_lengths;
     
     // process fields
     if (is_header) {
@@ -356,23 +561,236 @@ static void parse_line(CsvTable* table, const char* line_start, const char* line
             table->columns[i].inferred_type = VALUE_TYPE_STRING;
         }
     } else {
+        // rows rejected by a pushed down filter are never stored
+        if (table->filter_count > 0 && !row_passes_filters(table, lf)) return;
+        
         // store data row
         Row row;
         row.column_count = field_count;
-        row.values = malloc(sizeof(Value) * field_count);
+        row.field_count = 0;
+        row.line = NULL;
+        row.spans = NULL;
+        row.slots = NULL;
+        row.arena = table->arena;
         
-        for (int i = 0; i < field_count; i++) {
-            row.values[i] = parse_value(fields[i], field_lengths[i]);
+        if (table->lazy) {
+            // remember where the fields are, values are parsed on first access
+            row.values = NULL;
+            row.line = line_start;
+            row.field_count = field_count;
+            
+            if (table->slots) {
+                // only loaded columns get an entry, the ones missing from the line stay empty
+                if (row.column_count > table->column_count) row.column_count = table->column_count;
+                row.field_count = table->slot_count;
+                row.slots = table->slots;
+            }
+            
+            // an empty span parses to NULL
+            size_t span_count = row.field_count > 0 ? row.field_count : 1;
+            row.spans = table->arena ? arena_calloc(table->arena, span_count, sizeof(FieldSpan))
+                                     : calloc(span_count, sizeof(FieldSpan));
+            for (int i = 0; i < row.column_count; i++) {
+                int field = row.slots ? row.slots[i] : i;
+                if (field < 0) continue;
+                row.spans[field].offset = (unsigned int)(fields[i] - line_start);
+                row.spans[field].length = (unsigned int)field_lengths[i];
+            }
+        } else {
+            row.values = csv_alloc_values(table, field_count);
+            for (int i = 0; i < field_count; i++) {
+                if (is_projected(table, i)) {
+                    row.values[i] = parse_field(table->arena, false, fields[i], field_lengths[i]);
+                } else {
+                    row.values[i].type = VALUE_TYPE_NULL;
+                    row.values[i].int_value = 0;
+                }
+            }
         }
         
         add_row(table, row);
     }
+}
+
+/* parse every non empty line in [ptr, end) as a data row, lines end at any '\n' or '\r'.
+ * the scanner finds the line end and the field separators in the same pass */
+static void parse_data_lines(CsvTable* table, const char* ptr, const char* end) {
+    LineFields lf = {0};
     
-    free(fields);
-    free(field_lengths);
+    while (ptr < end) {
+        // skip line terminators and empty lines
+        while (ptr < end && (*ptr == '\n' || *ptr == '\r')) ptr++;
+        if (ptr >= end) break;
+        
+        size_t len = csv_scan_line(ptr, end, table->delimiter, table->quote, &lf.scan);
+        parse_line(table, ptr, ptr + len, false, &lf);
+        ptr += len;
+    }
+    
+    line_fields_free(&lf);
 }
 
-CsvTable* csv_load(const char* filename, CsvConfig config) {
+/* byte range of the file parsed by one worker into its own row array */
+typedef struct {
+    const char* start;
+    const char* end;
+    CsvTable rows;
+} LoadChunk;
+
+static void load_chunk_task(void* ctx, int index) {
+    LoadChunk* chunk = &((LoadChunk*)ctx)[index];
+    parse_data_lines(&chunk->rows, chunk->start, chunk->end);
+}
+
+/* helper: move to the start of the line following pos */
+static const char* next_line_start(const char* pos, const char* end) {
+    while (pos < end && *pos != '\n' && *pos != '\r') pos++;
+    while (pos < end && (*pos == '\n' || *pos == '\r')) pos++;
+    return pos;
+}
+
+/* split [ptr, end) into line aligned chunks, parse them concurrently and append
+ * the rows to the table in file order */
+static void parse_data_lines_parallel(CsvTable* table, const char* ptr, const char* end, int threads) {
+    LoadChunk* chunks = calloc(threads, sizeof(LoadChunk));
+    size_t chunk_size = (end - ptr) / threads;
+    
+    // a record never spans lines, so a line start is always a record boundary
+    const char* chunk_start = ptr;
+    for (int i = 0; i < threads; i++) {
+        const char* chunk_end = end;
+        if (i < threads - 1) {
+            const char* split = ptr + chunk_size * (i + 1);
+            chunk_end = next_line_start(split > chunk_start ? split : chunk_start, end);
+        }
+        
+        chunks[i].start = chunk_start;
+        chunks[i].end = chunk_end;
+        chunks[i].rows.delimiter = table->delimiter;
+        chunks[i].rows.quote = table->quote;
+        chunks[i].rows.lazy = table->lazy;
+        chunks[i].rows.slots = table->slots;
+        chunks[i].rows.slot_count = table->slot_count;
+        chunks[i].rows.filters = table->filters;
+        chunks[i].rows.filter_count = table->filter_count;
+        chunks[i].rows.column_count = table->column_count;
+        chunks[i].rows.arena = table->arena ? arena_create() : NULL;
+        chunk_start = chunk_end;
+    }
+    
+    cq_parallel_for(threads, load_chunk_task, chunks);
+    
+    // stitch chunk rows together in order
+    int total_rows = table->row_count;
+    for (int i = 0; i < threads; i++) {
+        total_rows += chunks[i].rows.row_count;
+    }
+    
+    if (total_rows > table->row_capacity) {
+        table->row_capacity = total_rows;
+        table->rows = realloc(table->rows, sizeof(Row) * table->row_capacity);
+    }
+    
+    for (int i = 0; i < threads; i++) {
+        if (chunks[i].rows.row_count > 0) {
+            memcpy(&table->rows[table->row_count], chunks[i].rows.rows, sizeof(Row) * chunks[i].rows.row_count);
+            table->row_count += chunks[i].rows.row_count;
+        }
+        free(chunks[i].rows.rows);
+        
+        // the worker arenas become part of the table one
+        if (chunks[i].rows.arena) {
+            arena_merge(table->arena, chunks[i].rows.arena);
+            arena_free(chunks[i].rows.arena);
+        }
+    }
+    
+    if (table->arena) {
+        for (int i = 0; i < table->row_count; i++) {
+            table->rows[i].arena = table->arena;
+        }
+    }
+    
+    free(chunks);
+}
+
+/* helper: check if a column name is written as a bare identifier in queries */
+static bool is_plain_identifier(const char* name) {
+    if (!isalpha((unsigned char)*name) && *name != '_' && *name != '$') return false;
+    for (const char* p = name; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_' && *p != '$') return false;
+    }
+    return true;
+}
+
+/* number the columns named by the config projection, columns whose name is not a plain
+ * identifier are always loaded since a query can refer to them in quoted forms */
+static void build_projection(CsvTable* table, CsvConfig config) {
+    if (!config.projection || table->column_count == 0) return;
+    
+    table->slots = malloc(sizeof(int) * table->column_count);
+    table->slot_count = 0;
+    
+    for (int col = 0; col < table->column_count; col++) {
+        const char* name = table->columns[col].name;
+        bool loaded = !is_plain_identifier(name);
+        
+        for (int i = 0; i < config.projection_count && !loaded; i++) {
+            if (strcasecmp(name, config.projection[i]) == 0) loaded = true;
+        }
+        
+        table->slots[col] = loaded ? table->slot_count++ : -1;
+    }
+}
+
+/* resolve the config filters against the header, filters on unknown columns are dropped */
+static void resolve_filters(CsvTable* table, CsvConfig config) {
+    if (!config.filters || config.filter_count == 0) return;
+    
+    table->filters = malloc(sizeof(RowFilter) * config.filter_count);
+    table->filter_count = 0;
+    
+    for (int i = 0; i < config.filter_count; i++) {
+        int col = csv_get_column_index(table, config.filters[i].column);
+        if (col < 0 || !is_projected(table, col)) continue;
+        
+        RowFilter* filter = &table->filters[table->filter_count++];
+        *filter = config.filters[i];
+        filter->column_index = col;
+        
+        // a pattern is compiled once for the whole load
+        filter->like = NULL;
+        if ((filter->op == ROW_FILTER_LIKE || filter->op == ROW_FILTER_ILIKE) && filter->value_count > 0) {
+            const Value* pattern = &filter->values[0];
+            if (pattern->type == VALUE_TYPE_STRING && pattern->string_value) {
+                filter->like = like_compile(pattern->string_value, pattern->string_length,
+                                            filter->op == ROW_FILTER_LIKE);
+            }
+        }
+    }
+}
+
+/* helper: drop the resolved filters once the load is done */
+static void free_filters(CsvTable* table) {
+    for (int i = 0; i < table->filter_count; i++) {
+        like_free(table->filters[i].like);
+    }
+    free(table->filters);
+    table->filters = NULL;
+    table->filter_count = 0;
+}
+
+/* helper: number of loader threads for a byte range, every worker gets at least
+ * CSV_PARALLEL_MIN_CHUNK bytes */
+static int loader_threads(CsvConfig config, size_t bytes) {
+    int threads = config.threads > 0 ? config.threads : cq_cpu_count();
+    size_t max_threads = bytes / CSV_PARALLEL_MIN_CHUNK;
+    if ((size_t)threads > max_threads) threads = (int)max_threads;
+    return threads;
+}
+
+/* helper: map the file and read the header, *data_start is set to the first data line */
+static CsvTable* open_table(const char* filename, CsvConfig config, const char** data_start) {
     size_t file_size;
     int fd;
     
@@ -392,6 +810,8 @@ CsvTable* csv_load(const char* filename, CsvConfig config) {
     table->delimiter = config.delimiter;
     table->quote = config.quote;
     table->has_header = config.has_header;
+    table->lazy = config.lazy;
+    table->arena = config.editable ? NULL : arena_create();
     table->rows = NULL;
     table->row_count = 0;
     table->row_capacity = 0;
@@ -399,82 +819,129 @@ CsvTable* csv_load(const char* filename, CsvConfig config) {
     // parse CSV
     const char* ptr = data;
     const char* end = data + file_size;
-    bool first_line = true;
     
-    while (ptr < end) {
-        // find end of line
-        const char* line_start = ptr;
-        while (ptr < end && *ptr != '\n' && *ptr != '\r') ptr++;
-        const char* line_end = ptr;
-        
-        // skip empty lines
-        if (line_end > line_start) {
-            if (first_line) {
-                parse_line(table, line_start, line_end, true);
-                first_line = false;
-                
-                // if no header, also parse as data
-                if (!config.has_header) {
-                    parse_line(table, line_start, line_end, false);
+    // skip leading empty lines
+    while (ptr < end && (*ptr == '\n' || *ptr == '\r')) ptr++;
+    
+    // the first line gives the column names
+    if (ptr < end) {
+        LineFields lf = {0};
+        const char* line_end = ptr + csv_scan_line(ptr, end, table->delimiter, table->quote, &lf.scan);
+        parse_line(table, ptr, line_end, true, &lf);
+        line_fields_free(&lf);
+        
+        // if no header, the first line is also data
+        if (config.has_header) {
+            ptr = next_line_start(line_end, end);
+        }
+    }
+    
+    build_projection(table, config);
+    resolve_filters(table, config);
+    
+    *data_start = ptr;
+    return table;
+}
+
+/* helper: infer column types from the first rows */
+static void infer_column_types(CsvTable* table) {
+    if (table->row_count == 0 || table->column_count == 0) return;
+    
+    int sample_size = table->row_count < 20 ? table->row_count : 20;
+    
+    for (int col = 0; col < table->column_count; col++) {
+        // count occurrences of each type
+        int type_counts[5] = {0}; // NULL, INTEGER, DOUBLE, STRING, DATE
+        
+        for (int row = 0; row < sample_size; row++) {
+            if (row < table->row_count && col < table->rows[row].column_count) {
+                ValueType type = row_value(&table->rows[row], col)->type;
+                if (type >= 0 && type < 5) {
+                    type_counts[type]++;
                 }
-            } else {
-                parse_line(table, line_start, line_end, false);
             }
         }
         
-        // skip line terminators
-        while (ptr < end && (*ptr == '\n' || *ptr == '\r')) ptr++;
+        // determine predominant type (prefer DATE > DOUBLE > INTEGER > STRING > NULL)
+        // ignore NULL values in type inference
+        ValueType inferred = VALUE_TYPE_STRING;
+        
+        if (type_counts[VALUE_TYPE_DATE] > 0) {
+            inferred = VALUE_TYPE_DATE;
+        } else if (type_counts[VALUE_TYPE_DOUBLE] > 0) {
+            inferred = VALUE_TYPE_DOUBLE;
+        } else if (type_counts[VALUE_TYPE_INTEGER] > 0) {
+            inferred = VALUE_TYPE_INTEGER;
+        } else if (type_counts[VALUE_TYPE_STRING] > 0) {
+            inferred = VALUE_TYPE_STRING;
+        }
+        
+        table->columns[col].inferred_type = inferred;
+    }
+}
+
+CsvTable* csv_load(const char* filename, CsvConfig config) {
+    const char* ptr;
+    CsvTable* table = open_table(filename, config, &ptr);
+    if (!table) return NULL;
+    
+    const char* end = table->data + table->file_size;
+    int threads = loader_threads(config, (size_t)(end - ptr));
+    
+    if (threads > 1) {
+        parse_data_lines_parallel(table, ptr, end, threads);
+    } else {
+        parse_data_lines(table, ptr, end);
     }
     
-    // infer column types from data
-    if (table->row_count > 0 && table->column_count > 0) {
-        int sample_size = table->row_count < 20 ? table->row_count : 20;
-        
+    // the filter values belong to the caller and are only valid during the load
+    free_filters(table);
+    
+    infer_column_types(table);
+    
+    if (config.columnar) {
         for (int col = 0; col < table->column_count; col++) {
-            // count occurrences of each type
-            int type_counts[5] = {0}; // NULL, INTEGER, DOUBLE, STRING, DATE
-            
-            for (int row = 0; row < sample_size; row++) {
-                if (row < table->row_count && col < table->rows[row].column_count) {
-                    ValueType type = table->rows[row].values[col].type;
-                    if (type >= 0 && type < 5) {
-                        type_counts[type]++;
-                    }
-                }
-            }
-            
-            // determine predominant type (prefer DATE > DOUBLE > INTEGER > STRING > NULL)
-            // ignore NULL values in type inference
-            ValueType inferred = VALUE_TYPE_STRING;
-            
-            if (type_counts[VALUE_TYPE_DATE] > 0) {
-                inferred = VALUE_TYPE_DATE;
-            } else if (type_counts[VALUE_TYPE_DOUBLE] > 0) {
-                inferred = VALUE_TYPE_DOUBLE;
-            } else if (type_counts[VALUE_TYPE_INTEGER] > 0) {
-                inferred = VALUE_TYPE_INTEGER;
-            } else if (type_counts[VALUE_TYPE_STRING] > 0) {
-                inferred = VALUE_TYPE_STRING;
-            }
-            
-            table->columns[col].inferred_type = inferred;
+            if (is_projected(table, col)) csv_column_vector(table, col);
         }
     }
     
     return table;
 }
 
+/* helper: free the values of every row, an arena is emptied in one go */
+static void free_rows(CsvTable* table) {
+    csv_drop_column_vectors(table);
+    
+    if (table->arena) {
+        arena_reset(table->arena);
+    } else {
+        for (int i = 0; i < table->row_count; i++) {
+            Row* row = &table->rows[i];
+            if (row->values) {
+                int value_count = row->spans ? row->field_count : row->column_count;
+                for (int j = 0; j < value_count; j++) {
+                    value_free(&row->values[j]);
+                }
+            }
+            free(row->values);
+            free(row->spans);
+        }
+    }
+    table->row_count = 0;
+}
+
 void csv_free(CsvTable* table) {
     if (!table) return;
     
     // free rows
-    for (int i = 0; i < table->row_count; i++) {
-        for (int j = 0; j < table->rows[i].column_count; j++) {
-            value_free(&table->rows[i].values[j]);
-        }
-        free(table->rows[i].values);
+    if (table->arena) {
+        arena_free(table->arena);
+    } else {
+        free_rows(table);
     }
+    csv_drop_column_vectors(table);
     free(table->rows);
+    free(table->slots);
     
     // free columns
     for (int i = 0; i < table->column_count; i++) {
@@ -489,12 +956,138 @@ void csv_free(CsvTable* table) {
     free(table);
 }
 
+Value* csv_alloc_values(CsvTable* table, int count) {
+    size_t n = count > 0 ? (size_t)count : 1;
+    if (table && table->arena) return arena_alloc(table->arena, sizeof(Value) * n);
+    return malloc(sizeof(Value) * n);
+}
+
+void csv_store_value(CsvTable* table, Value* dst, Value value) {
+    if (value.type == VALUE_TYPE_STRING && value.string_value &&
+        (value.borrowed || (table && table->arena))) {
+        csv_copy_value(table, dst, &value);
+        value_free(&value);
+        return;
+    }
+    *dst = value;
+}
+
+void csv_copy_value(CsvTable* table, Value* dst, const Value* src) {
+    *dst = *src;
+    if (src->type == VALUE_TYPE_STRING && src->string_value) {
+        bool arena = table && table->arena;
+        dst->string_value = arena ? arena_strndup(table->arena, src->string_value, src->string_length)
+                                  : cq_strndup(src->string_value, src->string_length);
+        dst->borrowed = arena;
+    }
+}
+
+/* ===== Cursor ===== */
+
+/* bytes of file parsed per batch, small enough for the rows of a batch and the
+ * result built from them to stay in cache */
+#define CSV_CURSOR_WINDOW (64 * 1024)
+
+struct CsvCursor {
+    CsvTable* table;        // header, and the rows of the current batch
+    const char* pos;        // first byte not parsed yet
+    const char* end;
+    bool types_inferred;
+};
+
+CsvCursor* csv_cursor_open(const char* filename, CsvConfig config) {
+    const char* ptr;
+    CsvTable* table = open_table(filename, config, &ptr);
+    if (!table) return NULL;
+    
+    CsvCursor* cursor = calloc(1, sizeof(CsvCursor));
+    cursor->table = table;
+    cursor->pos = ptr;
+    cursor->end = table->data + table->file_size;
+    
+    return cursor;
+}
+
+CsvTable* csv_cursor_table(CsvCursor* cursor) {
+    return cursor ? cursor->table : NULL;
+}
+
+int csv_cursor_next(CsvCursor* cursor) {
+    if (!cursor) return 0;
+    
+    CsvTable* table = cursor->table;
+    free_rows(table);
+    
+    // a window where every row is filtered out gives nothing to return, go on to the next one
+    while (table->row_count == 0 && cursor->pos < cursor->end) {
+        const char* batch_end = cursor->end;
+        if ((size_t)(cursor->end - cursor->pos) > CSV_CURSOR_WINDOW) {
+            batch_end = next_line_start(cursor->pos + CSV_CURSOR_WINDOW, cursor->end);
+        }
+        
+        parse_data_lines(table, cursor->pos, batch_end);
+        cursor->pos = batch_end;
+    }
+    
+    if (!cursor->types_inferred && table->row_count > 0) {
+        infer_column_types(table);
+        cursor->types_inferred = true;
+    }
+    
+    return table->row_count;
+}
+
+void csv_cursor_close(CsvCursor* cursor) {
+    if (!cursor) return;
+    
+    free_filters(cursor->table);
+    csv_free(cursor->table);
+    free(cursor);
+}
+
 /* ===== Access Functions ===== */
-Value* csv_get_value(CsvTable* table, int row_index, int col_index) {
+const Value* csv_get_value(CsvTable* table, int row_index, int col_index) {
     if (!table || row_index < 0 || row_index >= table->row_count) return NULL;
     if (col_index < 0 || col_index >= table->rows[row_index].column_count) return NULL;
     
-    return &table->rows[row_index].values[col_index];
+    return row_value(&table->rows[row_index], col_index);
+}
+
+const Value* row_value_slow(Row* row, int col_index) {
+    static const Value missing = { .type = VALUE_TYPE_NULL };
+    if (col_index < 0 || col_index >= row->column_count) return &missing;
+    
+    int field = row->slots ? row->slots[col_index] : col_index;
+    if (field < 0) return &missing;
+    
+    if (!row->values) {
+        // unparsed entries read as NULL values, which value_free ignores
+        size_t value_count = row->field_count > 0 ? row->field_count : 1;
+        row->values = row->arena ? arena_calloc(row->arena, value_count, sizeof(Value))
+                                 : calloc(value_count, sizeof(Value));
+    }
+    
+    FieldSpan* span = &row->spans[field];
+    if (!(span->length & FIELD_SPAN_PARSED)) {
+        row->values[field] = parse_field(row->arena, row->arena != NULL,
+                                         row->line + span->offset, span->length);
+        span->length |= FIELD_SPAN_PARSED;
+    }
+    
+    return &row->values[field];
+}
+
+Value row_value_peek(Row* row, int col_index) {
+    if (col_index < 0 || col_index >= row->column_count) return (Value){ .type = VALUE_TYPE_NULL };
+    if (!row->spans) return value_borrow(&row->values[col_index]);
+    
+    int field = row->slots ? row->slots[col_index] : col_index;
+    if (field < 0) return (Value){ .type = VALUE_TYPE_NULL };
+    
+    FieldSpan* span = &row->spans[field];
+    if (span->length & FIELD_SPAN_PARSED) return value_borrow(&row->values[field]);
+    
+    return parse_field(NULL, true, row->line + span->offset, span->length);
 }
 
 int csv_get_column_index(CsvTable* table, const char* col_name) {
@@ -508,7 +1101,7 @@ int csv_get_column_index(CsvTable* table, const char* col_name) {
     return -1;
 }
 
-Value* csv_get_value_by_name(CsvTable* table, int row_index, const char* col_name) {
+const Value* csv_get_value_by_name(CsvTable* table, int row_index, const char* col_name) {
     int col_index = csv_get_column_index(table, col_name);
     if (col_index < 0) return NULL;
     return csv_get_value(table, row_index, col_index);
@@ -516,9 +1109,8 @@ Value* csv_get_value_by_name(CsvTable* table, int row_index, const char* col_nam
 
 /* ebug functions */
 
-void csv_print_table(CsvTable* table, int max_rows) {
-    if (!table) return;
-    
+/* helper: width of the table layout columns */
+static int print_column_width(CsvTable* table) {
     // calculate max column name length for better alignment
     int max_col_name_len = 0;
     for (int i = 0; i < table->column_count; i++) {
@@ -526,6 +1118,25 @@ void csv_print_table(CsvTable* table, int max_rows) {
         if (len > max_col_name_len) max_col_name_len = len;
     }
     if (max_col_name_len > 20) max_col_name_len = 20;  // cap at 20
+    return max_col_name_len;
+}
+
+/* helper: print a value left aligned in width, strings are printed from their bytes */
+static void print_value(const Value* value, int width) {
+    if (value->type == VALUE_TYPE_STRING && value->string_value) {
+        printf("%-*.*s", width, (int)value->string_length, value->string_value);
+        return;
+    }
+    
+    char* str = value_to_string(value);
+    printf("%-*s", width, str);
+    free(str);
+}
+
+void csv_print_table_header(CsvTable* table) {
+    if (!table) return;
+    
+    int max_col_name_len = print_column_width(table);
     
     // print header
     for (int i = 0; i < table->column_count; i++) {
@@ -540,25 +1151,37 @@ void csv_print_table(CsvTable* table, int max_rows) {
         if (i < table->column_count - 1) printf("-+-");
     }
     printf("\n");
+}
+
+void csv_print_table_rows(CsvTable* table, int row_count) {
+    if (!table) return;
+    
+    int max_col_name_len = print_column_width(table);
     
     // print rows
-    int rows_to_print = (max_rows > 0 && max_rows < table->row_count) ? max_rows : table->row_count;
-    for (int i = 0; i < rows_to_print; i++) {
+    for (int i = 0; i < row_count && i < table->row_count; i++) {
         for (int j = 0; j < table->rows[i].column_count && j < table->column_count; j++) {
-            char* str = value_to_string(&table->rows[i].values[j]);
-            printf("%-*s", max_col_name_len + 1, str);
-            free(str);
+            print_value(row_value(&table->rows[i], j), max_col_name_len + 1);
             if (j < table->column_count - 1) printf(" | ");
         }
         printf("\n");
     }
+}
+
+void csv_print_table(CsvTable* table, int max_rows) {
+    if (!table) return;
+    
+    csv_print_table_header(table);
+    
+    int rows_to_print = (max_rows > 0 && max_rows < table->row_count) ? max_rows : table->row_count;
+    csv_print_table_rows(table, rows_to_print);
     
     if (max_rows > 0 && table->row_count > max_rows) {
         printf("... (%d more rows)\n", table->row_count - max_rows);
     }
 }
 
-void csv_print_table_vertical(CsvTable* table, int max_rows) {
+void csv_print_table_vertical_rows(CsvTable* table, int row_count, int first_row) {
     if (!table) return;
     
     // find max column name length for alignment
@@ -569,15 +1192,21 @@ void csv_print_table_vertical(CsvTable* table, int max_rows) {
     }
     
     // print rows vertically
-    int rows_to_print = (max_rows > 0 && max_rows < table->row_count) ? max_rows : table->row_count;
-    for (int i = 0; i < rows_to_print; i++) {
-        printf("*************************** %d. row ***************************\n", i + 1);
+    for (int i = 0; i < row_count && i < table->row_count; i++) {
+        printf("*************************** %d. row ***************************\n", first_row + i + 1);
         for (int j = 0; j < table->column_count && j < table->rows[i].column_count; j++) {
-            char* str = value_to_string(&table->rows[i].values[j]);
-            printf("%*s: %s\n", max_name_len, table->columns[j].name, str);
-            free(str);
+            printf("%*s: ", max_name_len, table->columns[j].name);
+            print_value(row_value(&table->rows[i], j), 0);
+            printf("\n");
         }
     }
+}
+
+void csv_print_table_vertical(CsvTable* table, int max_rows) {
+    if (!table) return;
+    
+    int rows_to_print = (max_rows > 0 && max_rows < table->row_count) ? max_rows : table->row_count;
+    csv_print_table_vertical_rows(table, rows_to_print, 0);
     
     if (max_rows > 0 && table->row_count > max_rows) {
         printf("... (%d more rows)\n", table->row_count - max_rows);
@@ -629,7 +1258,7 @@ bool csv_save(const char* filename, CsvTable* table) {
         for (int col = 0; col < table->rows[row].column_count && col < table->column_count; col++) {
             if (col > 0) fprintf(f, "%c", table->delimiter);
             
-            Value* val = &table->rows[row].values[col];
+            const Value* val = row_value(&table->rows[row], col);
             
             switch (val->type) {
                 case VALUE_TYPE_NULL:
@@ -654,8 +1283,9 @@ bool csv_save(const char* filename, CsvTable* table) {
                 case VALUE_TYPE_STRING: {
                     // check if string needs quoting
                     bool needs_quote = false;
-                    const char* str = val->string_value;
-                    for (const char* p = str; *p; p++) {
+                    const char* str = val->string_value ? val->string_value : "";
+                    const char* str_end = str + (val->string_value ? val->string_length : 0);
+                    for (const char* p = str; p < str_end; p++) {
                         if (*p == table->delimiter || *p == table->quote || *p == '\n' || *p == '\r') {
                             needs_quote = true;
                             break;
@@ -664,7 +1294,7 @@ bool csv_save(const char* filename, CsvTable* table) {
                     
                     if (needs_quote) {
                         fprintf(f, "%c", table->quote);
-                        for (const char* p = str; *p; p++) {
+                        for (const char* p = str; p < str_end; p++) {
                             if (*p == table->quote) {
                                 fprintf(f, "%c%c", table->quote, table->quote);
                             } else {
@@ -673,7 +1303,7 @@ bool csv_save(const char* filename, CsvTable* table) {
                         }
                         fprintf(f, "%c", table->quote);
                     } else {
-                        fprintf(f, "%s", str);
+                        fwrite(str, 1, str_end - str, f);
                     }
                     break;
                 }
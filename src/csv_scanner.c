@@ -0,0 +1,218 @@
+/* csv_scanner.c - find line ends and field separators 64 bytes at a time */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "csv_scanner.h"
+
+/* build with -DCSV_SCANNER_FORCE_SCALAR to test the portable classifier on x86 */
+#if !defined(CSV_SCANNER_FORCE_SCALAR) && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__))
+    #define CSV_SCANNER_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+/* AVX2 is picked at runtime, only gcc and clang can compile a single function for it */
+#if defined(CSV_SCANNER_SSE2) && (defined(__GNUC__) || defined(__clang__))
+    #define CSV_SCANNER_AVX2 1
+    #include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+static inline int lowest_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return (int)index;
+#else
+    int index = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+#ifndef CSV_SCANNER_SSE2
+static void scan_block_scalar(const char* block, char delimiter, char quote, BlockMasks* out) {
+    uint64_t delim_bits = 0, quote_bits = 0, newline_bits = 0;
+    
+    for (int i = 0; i < 64; i++) {
+        char c = block[i];
+        uint64_t bit = (uint64_t)1 << i;
+        if (c == delimiter) delim_bits |= bit;
+        if (c == quote) quote_bits |= bit;
+        if (c == '\n' || c == '\r') newline_bits |= bit;
+    }
+    
+    out->delimiter = delim_bits;
+    out->quote = quote_bits;
+    out->newline = newline_bits;
+}
+#endif
+
+#ifdef CSV_SCANNER_SSE2
+static void scan_block_sse2(const char* block, char delimiter, char quote, BlockMasks* out) {
+    const __m128i delim_v = _mm_set1_epi8(delimiter);
+    const __m128i quote_v = _mm_set1_epi8(quote);
+    const __m128i lf_v = _mm_set1_epi8('\n');
+    const __m128i cr_v = _mm_set1_epi8('\r');
+    uint64_t delim_bits = 0, quote_bits = 0, newline_bits = 0;
+    
+    for (int i = 0; i < 4; i++) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(block + i * 16));
+        int shift = i * 16;
+        delim_bits |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delim_v)) << shift;
+        quote_bits |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote_v)) << shift;
+        newline_bits |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, lf_v), _mm_cmpeq_epi8(chunk, cr_v))) << shift;
+    }
+    
+    out->delimiter = delim_bits;
+    out->quote = quote_bits;
+    out->newline = newline_bits;
+}
+#endif
+
+#ifdef CSV_SCANNER_AVX2
+__attribute__((target("avx2")))
+static void scan_block_avx2(const char* block, char delimiter, char quote, BlockMasks* out) {
+    const __m256i delim_v = _mm256_set1_epi8(delimiter);
+    const __m256i quote_v = _mm256_set1_epi8(quote);
+    const __m256i lf_v = _mm256_set1_epi8('\n');
+    const __m256i cr_v = _mm256_set1_epi8('\r');
+    
+    __m256i lo = _mm256_loadu_si256((const __m256i*)block);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)(block + 32));
+    
+    out->delimiter = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, delim_v)) |
+                     (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, delim_v)) << 32;
+    out->quote = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote_v)) |
+                 (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote_v)) << 32;
+    out->newline = (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                       _mm256_or_si256(_mm256_cmpeq_epi8(lo, lf_v), _mm256_cmpeq_epi8(lo, cr_v))) |
+                   (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                       _mm256_or_si256(_mm256_cmpeq_epi8(hi, lf_v), _mm256_cmpeq_epi8(hi, cr_v))) << 32;
+}
+#endif
+
+typedef void (*ScanBlockFunc)(const char* block, char delimiter, char quote, BlockMasks* out);
+
+static ScanBlockFunc select_scan_block(void) {
+#ifdef CSV_SCANNER_AVX2
+    if (__builtin_cpu_supports("avx2")) return scan_block_avx2;
+#endif
+#ifdef CSV_SCANNER_SSE2
+    return scan_block_sse2;
+#else
+    return scan_block_scalar;
+#endif
+}
+
+void csv_scan_block(const char* block, char delimiter, char quote, BlockMasks* out) {
+    static ScanBlockFunc scan_block = NULL;
+    
+    // benign race, every thread computes the same pointer
+    if (!scan_block) scan_block = select_scan_block();
+    scan_block(block, delimiter, quote, out);
+}
+
+const char* csv_scanner_kind(void) {
+#ifdef CSV_SCANNER_AVX2
+    if (__builtin_cpu_supports("avx2")) return "avx2";
+#endif
+#ifdef CSV_SCANNER_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+static inline void add_separator(LineScan* scan, int offset) {
+    if (scan->separator_count >= scan->separator_capacity) {
+        scan->separator_capacity = scan->separator_capacity == 0 ? 32 : scan->separator_capacity * 2;
+        scan->separators = realloc(scan->separators, sizeof(int) * scan->separator_capacity);
+    }
+    scan->separators[scan->separator_count++] = offset;
+}
+
+size_t csv_scan_line(const char* ptr, const char* end, char delimiter, char quote, LineScan* scan) {
+    const char* line_start = ptr;
+    uint64_t inside_quotes = 0;   // all ones while a quoted section is open across blocks
+    
+    scan->separator_count = 0;
+    scan->has_quote = false;
+    
+    while (ptr < end) {
+        BlockMasks masks;
+        size_t remaining = end - ptr;
+        
+        if (remaining >= 64) {
+            csv_scan_block(ptr, delimiter, quote, &masks);
+        } else {
+            // the tail of a mapping cannot be over-read, classify a padded copy
+            char padded[64];
+            memcpy(padded, ptr, remaining);
+            memset(padded + remaining, '\n', 64 - remaining);
+            csv_scan_block(padded, delimiter, quote, &masks);
+        }
+        
+        // stop at the first line terminator of the block
+        uint64_t valid = ~(uint64_t)0;
+        int line_len_in_block = 64;
+        if (masks.newline) {
+            line_len_in_block = lowest_bit(masks.newline);
+            valid = line_len_in_block == 0 ? 0 : (~(uint64_t)0 >> (64 - line_len_in_block));
+        }
+        
+        uint64_t delims = masks.delimiter & valid;
+        uint64_t quotes = masks.quote & valid;
+        
+        if (quotes || inside_quotes) {
+            scan->has_quote = scan->has_quote || quotes != 0;
+            uint64_t inside = prefix_xor(quotes) ^ inside_quotes;
+            delims &= ~inside;
+            inside_quotes = (uint64_t)0 - (inside >> 63);
+        }
+        
+        int base = (int)(ptr - line_start);
+        while (delims) {
+            add_separator(scan, base + lowest_bit(delims));
+            delims &= delims - 1;
+        }
+        
+        if (line_len_in_block < 64) {
+            size_t len = (ptr - line_start) + line_len_in_block;
+            size_t max_len = end - line_start;
+            return len < max_len ? len : max_len;
+        }
+        
+        ptr += 64;
+    }
+    
+    return end - line_start;
+}
+
+void line_scan_free(LineScan* scan) {
+    if (!scan) return;
+    free(scan->separators);
+    scan->separators = NULL;
+    scan->separator_count = 0;
+    scan->separator_capacity = 0;
+}
@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include <ctype.h>
 #include <math.h>
+#include <limits.h>
 #include "evaluator.h"
 #include "parser.h"
 #include "csv_reader.h"
@@ -18,12 +19,15 @@
 #include "evaluator/evaluator_joins.h"
 #include "evaluator/evaluator_statements.h"
 #include "evaluator/evaluator_utils.h"
+#include "evaluator/evaluator_columnar.h"
+#include "evaluator/evaluator_subquery.h"
 
 /* global csv configuration to can be set before calling evaluate_query */
-CsvConfig global_csv_config = {.delimiter = ',', .quote = '"', .has_header = true};
+CsvConfig global_csv_config = {.delimiter = ',', .quote = '"', .has_header = true, .threads = 0, .lazy = false};
 
 /* main internal query evaluation logic */
-ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable* outer_table) {
+ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable* outer_table,
+                                   SubqueryRun* run) {
     if (!query_ast || query_ast->type != NODE_TYPE_QUERY) {
         fprintf(stderr, "Invalid query AST\n");
         return NULL;
@@ -35,10 +39,21 @@ ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable*
     // set outer context for correlated subqueries
     ctx->outer_row = outer_row;
     ctx->outer_table = outer_table;
+    ctx->outer_refs = run ? &run->refs : NULL;
     
-    // load table from FROM clause
+    // load table from FROM clause, a subquery evaluated again reuses the table loaded by its first run
     const char* table_alias = NULL;
-    CsvTable* source_table = load_from_table(query_ast->query.from, &table_alias, ctx);
+    CsvTable* source_table = NULL;
+    if (run && run->source) {
+        source_table = run->source;
+        table_alias = run->source_alias;
+    } else {
+        source_table = load_from_table(query_ast->query.from, &table_alias, ctx);
+        if (run) {
+            run->source = source_table;
+            run->source_alias = table_alias;
+        }
+    }
     if (!source_table) {
         context_free(ctx);
         return NULL;
@@ -54,8 +69,9 @@ ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable*
     
     // replace context table with joined result if needed
     if (working_table != ctx->tables[0].table) {
-        csv_free(ctx->tables[0].table);
+        if (!run) csv_free(ctx->tables[0].table);
         ctx->tables[0].table = working_table;
+        context_new_scope(ctx);
     }
     
     // apply WHERE filtering
@@ -68,7 +84,6 @@ ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable*
     
     if (group_by && group_by->type == NODE_TYPE_GROUP_BY && group_by->group_by.columns && group_by->group_by.column_count > 0) {
         // group rows by columns
-        GroupResult* groups = NULL;
         ASTNode* select_node = query_ast->query.select;
         
         // build array of column names/expressions for grouping
@@ -102,123 +117,13 @@ ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable*
             }
         }
         
-        // create groups with composite keys
-        if (group_by->group_by.column_count == 1 && !group_exprs[0]) {
-            // single column no expression - use optimized single-column grouping
-            groups = create_groups(filtered_rows, filtered_count, ctx->tables[0].table, group_columns[0]);
-        } else if (group_by->group_by.column_count == 1 && group_exprs[0]) {
-            // single expression
-            groups = create_groups_by_expression(ctx, filtered_rows, filtered_count, group_exprs[0]);
-        } else {
-            // multiple columns - create composite grouping
-            groups = calloc(1, sizeof(GroupResult));
-            groups->group_capacity = 16;
-            groups->groups = malloc(sizeof(GroupedRows) * groups->group_capacity);
-            groups->group_count = 0;
-            
-            for (int i = 0; i < filtered_count; i++) {
-                // build composite key from all group columns
-                char composite_key[1024] = "";
-                
-                for (int g = 0; g < group_by->group_by.column_count; g++) {
-                    if (g > 0) strcat(composite_key, "\t");  // use tab as separator
-                    
-                    char key_part[256];
-                    if (group_exprs[g]) {
-                        // evaluate expression
-                        Value val = evaluate_expression(ctx, group_exprs[g], filtered_rows[i], 0);
-                        switch (val.type) {
-                            case VALUE_TYPE_NULL:
-                                strcpy(key_part, "NULL");
-                                break;
-                            case VALUE_TYPE_INTEGER:
-                                snprintf(key_part, sizeof(key_part), "%lld", val.int_value);
-                                break;
-                            case VALUE_TYPE_DOUBLE:
-                                snprintf(key_part, sizeof(key_part), "%.6f", val.double_value);
-                                break;
-                            case VALUE_TYPE_DATE:
-                                snprintf(key_part, sizeof(key_part), "%04d-%02d-%02d",
-                                         val.date_value.year, val.date_value.month, val.date_value.day);
-                                break;
-                            case VALUE_TYPE_STRING:
-                                strncpy(key_part, val.string_value, sizeof(key_part) - 1);
-                                key_part[sizeof(key_part) - 1] = '\0';
-                                free((char*)val.string_value);
-                                break;
-                        }
-                    } else {
-                        // get column value
-                        int col_idx = csv_get_column_index(ctx->tables[0].table, group_columns[g]);
-                        if (col_idx >= 0) {
-                            Value* val = &filtered_rows[i]->values[col_idx];
-                            switch (val->type) {
-                                case VALUE_TYPE_NULL:
-                                    strcpy(key_part, "NULL");
-                                    break;
-                                case VALUE_TYPE_INTEGER:
-                                    snprintf(key_part, sizeof(key_part), "%lld", val->int_value);
-                                    break;
-                                case VALUE_TYPE_DOUBLE:
-                                    snprintf(key_part, sizeof(key_part), "%.6f", val->double_value);
-                                    break;
-                                case VALUE_TYPE_DATE:
-                                    snprintf(key_part, sizeof(key_part), "%04d-%02d-%02d",
-                                             val->date_value.year, val->date_value.month, val->date_value.day);
-                                    break;
-                                case VALUE_TYPE_STRING:
-                                    strncpy(key_part, val->string_value, sizeof(key_part) - 1);
-                                    key_part[sizeof(key_part) - 1] = '\0';
-                                    break;
-                            }
-                        } else {
-                            strcpy(key_part, "NULL");
-                        }
-                    }
-                    strcat(composite_key, key_part);
-                }
-                
-                // find or create group
-                int group_idx = -1;
-                for (int j = 0; j < groups->group_count; j++) {
-                    if (strcmp(groups->groups[j].group_key, composite_key) == 0) {
-                        group_idx = j;
-                        break;
-                    }
-                }
-                
-                if (group_idx < 0) {
-                    // create new group
-                    if (groups->group_count >= groups->group_capacity) {
-                        groups->group_capacity *= 2;
-                        groups->groups = realloc(groups->groups, sizeof(GroupedRows) * groups->group_capacity);
-                    }
-                    
-                    group_idx = groups->group_count++;
-                    groups->groups[group_idx].group_key = strdup(composite_key);
-                    groups->groups[group_idx].row_capacity = 16;
-                    groups->groups[group_idx].rows = malloc(sizeof(Row*) * groups->groups[group_idx].row_capacity);
-                    groups->groups[group_idx].row_count = 0;
-                }
-                
-                // add row to group
-                GroupedRows* group = &groups->groups[group_idx];
-                if (group->row_count >= group->row_capacity) {
-                    group->row_capacity *= 2;
-                    group->rows = realloc(group->rows, sizeof(Row*) * group->row_capacity);
-                }
-                group->rows[group->row_count++] = filtered_rows[i];
-            }
-        }
+        // hash aggregate in a single pass over the filtered rows
+        result = aggregate_rows(ctx, filtered_rows, filtered_count, group_columns, group_exprs,
+                                group_by->group_by.column_count, query_ast->query.select);
         
         free(group_columns);
         free(group_exprs);
         
-        // compute aggregated result
-        result = build_aggregated_result(ctx, groups, query_ast->query.select);
-        
-        free_groups(groups);
-        
         // evaluate HAVING filter if present
         if (query_ast->query.having) {
             apply_having_filter(result, query_ast->query.having, query_ast->query.select);
@@ -226,25 +131,12 @@ ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable*
         
         // apply ORDER BY to the aggregated result
         ASTNode* order_by = query_ast->query.order_by;
-        if (order_by && order_by->type == NODE_TYPE_ORDER_BY && order_by->order_by.column) {
-            sort_result(result, query_ast->query.select, order_by->order_by.column, order_by->order_by.descending);
+        if (order_by && order_by->type == NODE_TYPE_ORDER_BY) {
+            sort_result(result, query_ast->query.select, order_by);
         }
     } else if (has_aggregate_functions(query_ast->query.select)) {
         // aggregate functions without GROUP BY - entire result is a single group
-        GroupResult* groups = malloc(sizeof(GroupResult));
-        groups->group_count = 1;
-        groups->groups = malloc(sizeof(GroupedRows));
-        groups->groups[0].group_key = strdup("_all_");
-        groups->groups[0].row_count = filtered_count;
-        groups->groups[0].rows = filtered_rows;
-        
-        // compute aggregated result
-        result = build_aggregated_result(ctx, groups, query_ast->query.select);
-        
-        // clean up groups without freeing filtered_rows
-        free(groups->groups[0].group_key);
-        free(groups->groups);
-        free(groups);
+        result = aggregate_rows(ctx, filtered_rows, filtered_count, NULL, NULL, 0, query_ast->query.select);
         
         // evaluate HAVING filter if present
         if (query_ast->query.having) {
@@ -253,26 +145,32 @@ ResultSet* evaluate_query_internal(ASTNode* query_ast, Row* outer_row, CsvTable*
         
         // apply ORDER BY to aggregated result
         ASTNode* order_by = query_ast->query.order_by;
-        if (order_by && order_by->type == NODE_TYPE_ORDER_BY && order_by->order_by.column) {
-            sort_result(result, query_ast->query.select, order_by->order_by.column, order_by->order_by.descending);
+        if (order_by && order_by->type == NODE_TYPE_ORDER_BY) {
+            sort_result(result, query_ast->query.select, order_by);
         }
     } else {
-        // build result first so ORDER BY can use aliases
-        result = build_result(ctx, filtered_rows, filtered_count);
-        
-        // apply ORDER BY for non-aggregated results
         ASTNode* order_by = query_ast->query.order_by;
-        if (order_by && order_by->type == NODE_TYPE_ORDER_BY) {
-            const char* col_name = order_by->order_by.column;
-            bool descending = order_by->order_by.descending;
+        bool ordered = order_by && order_by->type == NODE_TYPE_ORDER_BY && order_by->order_by.column_count > 0;
+        bool distinct = query_ast->query.select && query_ast->query.select->select.distinct;
+        int limit = query_ast->query.limit;
+        int offset = query_ast->query.offset > 0 ? query_ast->query.offset : 0;
+        
+        if (ordered && !distinct && limit >= 0 && limit <= INT_MAX - offset) {
+            // ORDER BY ... LIMIT only ever materializes the rows it keeps
+            result = build_result_top_n(ctx, filtered_rows, filtered_count, order_by, limit + offset);
+        } else {
+            // build result first so ORDER BY can use aliases
+            result = build_result(ctx, filtered_rows, filtered_count);
             
-            if (col_name) {
-                sort_result(result, query_ast->query.select, col_name, descending);
+            // apply ORDER BY for non-aggregated results
+            if (ordered) {
+                sort_result(result, query_ast->query.select, order_by);
             }
         }
     }
     
     free(filtered_rows);
+    if (run && ctx->tables[0].table == run->source) ctx->tables[0].table = NULL;
     context_free(ctx);
     
     // apply DISTINCT if specified
@@ -344,5 +242,116 @@ ResultSet* evaluate_query(ASTNode* query_ast) {
         return result;
     }
     
-    return evaluate_query_internal(query_ast, NULL, NULL);
+    return evaluate_query_internal(query_ast, NULL, NULL, NULL);
+}
+
+bool query_is_streamable(ASTNode* query_ast) {
+    if (!query_ast || query_ast->type != NODE_TYPE_QUERY) return false;
+    
+    ASTNode* select_node = query_ast->query.select;
+    ASTNode* from = query_ast->query.from;
+    
+    // rows must come straight from a file, one at a time
+    if (!from || from->type != NODE_TYPE_FROM || !from->from.table || from->from.subquery) return false;
+    if (query_ast->query.join_count > 0) return false;
+    
+    // every operator below needs the whole input before it can produce a row
+    if (query_ast->query.group_by || query_ast->query.having || query_ast->query.order_by) return false;
+    if (!select_node || select_node->type != NODE_TYPE_SELECT || select_node->select.distinct) return false;
+    if (has_aggregate_functions(select_node)) return false;
+    
+    if (select_node->select.column_nodes) {
+        for (int i = 0; i < select_node->select.column_count; i++) {
+            ASTNode* col_node = select_node->select.column_nodes[i];
+            if (col_node && col_node->type == NODE_TYPE_WINDOW_FUNCTION) return false;
+        }
+    }
+    
+    return true;
+}
+
+int evaluate_query_streaming(ASTNode* query_ast, ResultSink* sink) {
+    if (!sink || !query_is_streamable(query_ast)) return -1;
+    
+    ASTNode* from = query_ast->query.from;
+    const char* table_alias = from->from.alias ? from->from.alias : "main";
+    
+    // same column and filter pushdown as load_from_table
+    ColumnRefs refs = {0};
+    PushdownFilters filters = {0};
+    column_refs_collect(&refs, query_ast);
+    pushdown_collect(&filters, query_ast->query.where, table_alias);
+    
+    CsvCursor* cursor = csv_cursor_open(from->from.table, query_load_config(&refs, &filters));
+    column_refs_free(&refs);
+    if (!cursor) {
+        fprintf(stderr, "Failed to load table from '%s'\n", from->from.table);
+        pushdown_free(&filters);
+        return -1;
+    }
+    
+    QueryContext* ctx = context_create(query_ast);
+    ctx->table_count = 1;
+    ctx->tables = malloc(sizeof(TableRef) * 1);
+    ctx->tables[0].alias = strdup(table_alias);
+    ctx->tables[0].table = csv_cursor_table(cursor);
+    
+    // an empty result carries the output columns
+    ResultSet* header = build_result(ctx, NULL, 0);
+    sink->begin(sink->ctx, header);
+    csv_free(header);
+    
+    int offset = query_ast->query.offset > 0 ? query_ast->query.offset : 0;
+    int limit = query_ast->query.limit;
+    int produced = 0;
+    
+    Row** filtered_rows = NULL;
+    int filtered_capacity = 0;
+    
+    // stop reading the file as soon as LIMIT is reached
+    while ((limit < 0 || produced < limit) && csv_cursor_next(cursor) > 0) {
+        CsvTable* batch = ctx->tables[0].table;
+        if (batch->row_count > filtered_capacity) {
+            filtered_capacity = batch->row_count;
+            filtered_rows = realloc(filtered_rows, sizeof(Row*) * filtered_capacity);
+        }
+        
+        // the WHERE clause is evaluated a batch of rows at a time, OFFSET and LIMIT on what it keeps
+        int filtered_count = 0;
+        int sel[COLUMNAR_BATCH_SIZE];
+        for (int start = 0; start < batch->row_count; start += COLUMNAR_BATCH_SIZE) {
+            if (limit >= 0 && produced + filtered_count >= limit) break;
+            
+            int count = batch->row_count - start;
+            if (count > COLUMNAR_BATCH_SIZE) count = COLUMNAR_BATCH_SIZE;
+            int kept = columnar_filter_batch(ctx, query_ast->query.where, start, count, sel);
+            
+            for (int k = 0; k < kept; k++) {
+                if (limit >= 0 && produced + filtered_count >= limit) break;
+                
+                if (offset > 0) {
+                    offset--;
+                    continue;
+                }
+                filtered_rows[filtered_count++] = &batch->rows[start + sel[k]];
+            }
+        }
+        
+        if (filtered_count > 0) {
+            ResultSet* result = build_result(ctx, filtered_rows, filtered_count);
+            sink->rows(sink->ctx, result);
+            csv_free(result);
+            produced += filtered_count;
+        }
+    }
+    
+    free(filtered_rows);
+    
+    // the batch table belongs to the cursor
+    ctx->tables[0].table = NULL;
+    context_free(ctx);
+    csv_cursor_close(cursor);
+    pushdown_free(&filters);
+    
+    return produced;
 }
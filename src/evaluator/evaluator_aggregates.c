@@ -8,6 +8,8 @@
 #include "csv_reader.h"
 #include "string_utils.h"
 #include "evaluator/evaluator_aggregates.h"
+#include "evaluator/evaluator_hash.h"
+#include "evaluator/evaluator_columnar.h"
 
 /* forward declarations for functions defined in other evaluator modules */
 extern Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index);
@@ -105,161 +107,6 @@ bool has_aggregate_functions(ASTNode* select_node) {
     return false;
 }
 
-GroupResult* create_groups(Row** rows, int row_count, CsvTable* table, const char* group_column) {
-    GroupResult* result = calloc(1, sizeof(GroupResult));
-    result->group_capacity = 16;
-    result->groups = malloc(sizeof(GroupedRows) * result->group_capacity);
-    result->group_count = 0;
-    
-    int group_col_idx = find_column_index_with_fallback(table, group_column);
-    
-    if (group_col_idx < 0) return result;
-    
-    for (int i = 0; i < row_count; i++) {
-        Value* group_val = &rows[i]->values[group_col_idx];
-        
-        // convert value to string for grouping key
-        char key_buf[256];
-        switch (group_val->type) {
-            case VALUE_TYPE_NULL:
-                strcpy(key_buf, "NULL");
-                break;
-            case VALUE_TYPE_INTEGER:
-                snprintf(key_buf, sizeof(key_buf), "%lld", group_val->int_value);
-                break;
-            case VALUE_TYPE_DOUBLE:
-                snprintf(key_buf, sizeof(key_buf), "%.6f", group_val->double_value);
-                break;
-            case VALUE_TYPE_DATE:
-                snprintf(key_buf, sizeof(key_buf), "%04d-%02d-%02d",
-                         group_val->date_value.year, group_val->date_value.month, group_val->date_value.day);
-                break;
-            case VALUE_TYPE_STRING:
-                strncpy(key_buf, group_val->string_value, sizeof(key_buf) - 1);
-                key_buf[sizeof(key_buf) - 1] = '\0';
-                break;
-        }
-        
-        // find or create group
-        int group_idx = -1;
-        for (int j = 0; j < result->group_count; j++) {
-            if (strcmp(result->groups[j].group_key, key_buf) == 0) {
-                group_idx = j;
-                break;
-            }
-        }
-        
-        if (group_idx < 0) {
-            // create new group
-            if (result->group_count >= result->group_capacity) {
-                result->group_capacity *= 2;
-                result->groups = realloc(result->groups, sizeof(GroupedRows) * result->group_capacity);
-            }
-            
-            group_idx = result->group_count++;
-            result->groups[group_idx].group_key = strdup(key_buf);
-            result->groups[group_idx].row_capacity = 16;
-            result->groups[group_idx].rows = malloc(sizeof(Row*) * result->groups[group_idx].row_capacity);
-            result->groups[group_idx].row_count = 0;
-        }
-        
-        // add row to group
-        GroupedRows* group = &result->groups[group_idx];
-        if (group->row_count >= group->row_capacity) {
-            group->row_capacity *= 2;
-            group->rows = realloc(group->rows, sizeof(Row*) * group->row_capacity);
-        }
-        group->rows[group->row_count++] = rows[i];
-    }
-    
-    return result;
-}
-
-/* create groups by evaluating a SELECT expression for each row */
-GroupResult* create_groups_by_expression(QueryContext* ctx, Row** rows, int row_count, 
-                                                 ASTNode* group_expr) {
-    GroupResult* result = calloc(1, sizeof(GroupResult));
-    result->group_capacity = 16;
-    result->groups = malloc(sizeof(GroupedRows) * result->group_capacity);
-    result->group_count = 0;
-    
-    for (int i = 0; i < row_count; i++) {
-        // evaluate the grouping expression for this row
-        Value group_val = evaluate_expression(ctx, group_expr, rows[i], 0);
-        
-        // convert value to string for grouping key
-        char key_buf[256];
-        switch (group_val.type) {
-            case VALUE_TYPE_NULL:
-                strcpy(key_buf, "NULL");
-                break;
-            case VALUE_TYPE_INTEGER:
-                snprintf(key_buf, sizeof(key_buf), "%lld", group_val.int_value);
-                break;
-            case VALUE_TYPE_DOUBLE:
-                snprintf(key_buf, sizeof(key_buf), "%.6f", group_val.double_value);
-                break;
-            case VALUE_TYPE_DATE:
-                snprintf(key_buf, sizeof(key_buf), "%04d-%02d-%02d",
-                         group_val.date_value.year, group_val.date_value.month, group_val.date_value.day);
-                break;
-            case VALUE_TYPE_STRING:
-                strncpy(key_buf, group_val.string_value, sizeof(key_buf) - 1);
-                key_buf[sizeof(key_buf) - 1] = '\0';
-                break;
-        }
-        
-        // free string value if allocated
-        if (group_val.type == VALUE_TYPE_STRING && group_val.string_value) {
-            free((char*)group_val.string_value);
-        }
-        
-        // find or create group
-        int group_idx = -1;
-        for (int j = 0; j < result->group_count; j++) {
-            if (strcmp(result->groups[j].group_key, key_buf) == 0) {
-                group_idx = j;
-                break;
-            }
-        }
-        
-        if (group_idx < 0) {
-            // create new group
-            if (result->group_count >= result->group_capacity) {
-                result->group_capacity *= 2;
-                result->groups = realloc(result->groups, sizeof(GroupedRows) * result->group_capacity);
-            }
-            
-            group_idx = result->group_count++;
-            result->groups[group_idx].group_key = strdup(key_buf);
-            result->groups[group_idx].row_capacity = 16;
-            result->groups[group_idx].rows = malloc(sizeof(Row*) * result->groups[group_idx].row_capacity);
-            result->groups[group_idx].row_count = 0;
-        }
-        
-        // add row to group
-        GroupedRows* group = &result->groups[group_idx];
-        if (group->row_count >= group->row_capacity) {
-            group->row_capacity *= 2;
-            group->rows = realloc(group->rows, sizeof(Row*) * group->row_capacity);
-        }
-        group->rows[group->row_count++] = rows[i];
-    }
-    
-    return result;
-}
-
-void free_groups(GroupResult* groups) {
-    if (!groups) return;
-    
-    for (int i = 0; i < groups->group_count; i++) {
-        free(groups->groups[i].group_key);
-        free(groups->groups[i].rows);
-    }
-    free(groups->groups);
-    free(groups);
-}
-
 Value evaluate_aggregate(const char* func_name, Row** rows, int row_count, CsvTable* table, const char* column_name) {
     Value result;
     result.type = VALUE_TYPE_NULL;
@@ -288,7 +135,7 @@ Value evaluate_aggregate(const char* func_name, Row** rows, int row_count, CsvTa
         int count = 0;
         
         for (int i = 0; i < row_count; i++) {
-            Value* val = &rows[i]->values[col_idx];
+            const Value* val = row_value(rows[i], col_idx);
             if (val->type == VALUE_TYPE_INTEGER) {
                 sum += val->int_value;
                 count++;
@@ -309,10 +156,10 @@ Value evaluate_aggregate(const char* func_name, Row** rows, int row_count, CsvTa
     }
     
     if (strcasecmp(func_name, "MIN") == 0 || strcasecmp(func_name, "MAX") == 0) {
-        Value* extreme = NULL;
+        const Value* extreme = NULL;
         
         for (int i = 0; i < row_count; i++) {
-            Value* val = &rows[i]->values[col_idx];
+            const Value* val = row_value(rows[i], col_idx);
             if (val->type != VALUE_TYPE_NULL) {
                 if (!extreme || 
                     (strcasecmp(func_name, "MIN") == 0 && value_compare(val, extreme) < 0) ||
@@ -332,7 +179,7 @@ Value evaluate_aggregate(const char* func_name, Row** rows, int row_count, CsvTa
         
         // first pass: calculate mean
         for (int i = 0; i < row_count; i++) {
-            Value* val = &rows[i]->values[col_idx];
+            const Value* val = row_value(rows[i], col_idx);
             if (val->type == VALUE_TYPE_INTEGER) {
                 sum += val->int_value;
                 count++;
@@ -349,7 +196,7 @@ Value evaluate_aggregate(const char* func_name, Row** rows, int row_count, CsvTa
         // second pass: calculate variance
         double variance_sum = 0;
         for (int i = 0; i < row_count; i++) {
-            Value* val = &rows[i]->values[col_idx];
+            const Value* val = row_value(rows[i], col_idx);
             double value = 0;
             if (val->type == VALUE_TYPE_INTEGER) {
                 value = val->int_value;
@@ -374,7 +221,7 @@ Value evaluate_aggregate(const char* func_name, Row** rows, int row_count, CsvTa
         int count = 0;
         
         for (int i = 0; i < row_count; i++) {
-            Value* val = &rows[i]->values[col_idx];
+            const Value* val = row_value(rows[i], col_idx);
             if (val->type == VALUE_TYPE_INTEGER) {
                 values[count++] = val->int_value;
             } else if (val->type == VALUE_TYPE_DOUBLE) {
@@ -513,10 +360,7 @@ void apply_having_filter(ResultSet* result, ASTNode* having, ASTNode* select_nod
         } else {
             // free this row's values
             for (int j = 0; j < result->rows[i].column_count; j++) {
-                if (result->rows[i].values[j].type == VALUE_TYPE_STRING &&
-                    result->rows[i].values[j].string_value) {
-                    free((char*)result->rows[i].values[j].string_value);
-                }
+                value_free(&result->rows[i].values[j]);
             }
             free(result->rows[i].values);
         }
@@ -529,20 +373,266 @@ void apply_having_filter(ResultSet* result, ASTNode* having, ASTNode* select_nod
     result->row_capacity = result->row_count;
 }
 
-/* function to build aggregated result */
-ResultSet* build_aggregated_result(QueryContext* ctx, GroupResult* groups, ASTNode* select_node) {
-    ResultSet* result = calloc(1, sizeof(ResultSet));
-    result->filename = strdup("query_result");
-    result->has_header = true;
-    result->delimiter = ',';
-    result->quote = '"';
+/* aggregate functions supported by the accumulators */
+typedef enum {
+    AGG_COUNT,
+    AGG_SUM,
+    AGG_AVG,
+    AGG_MIN,
+    AGG_MAX,
+    AGG_STDDEV,
+    AGG_MEDIAN,
+} AggregateKind;
+
+/* how an output column of an aggregated query is produced */
+typedef enum {
+    OUTPUT_AGGREGATE,     // accumulator updated for every row of the group
+    OUTPUT_SCALAR,        // scalar function spec evaluated on the first row of the group
+    OUTPUT_EXPRESSION,    // expression node evaluated on the first row of the group
+    OUTPUT_COLUMN,        // plain column taken from the first row of the group
+} OutputKind;
+
+typedef struct {
+    OutputKind kind;
+    AggregateKind agg;
+    int col_idx;          // source column, -1 if unknown
+    bool count_star;      // COUNT(*)
+    int acc_index;        // accumulator slot within a group, aggregates only
+    const ColumnVector* vector;  // typed vector of the source column, NULL to read the rows
+} OutputColumn;
+
+/* fixed size running state of one aggregate in one group */
+typedef struct {
+    long long numeric_count;
+    double sum;
+    double mean;          // Welford running mean
+    double m2;            // Welford sum of squared deviations
+    const Value* extreme; // MIN/MAX, points into the source table
+    int extreme_index;    // entry of extreme in the column vector
+    double* values;       // MEDIAN only, numeric values of the group
+    int value_count;
+    int value_capacity;
+} Accumulator;
+
+/* per group state: the first row stands in for non aggregated columns */
+typedef struct {
+    Row* first_row;
+    long long row_count;
+} GroupState;
+
+static bool parse_aggregate_kind(const char* func_name, AggregateKind* kind) {
+    if (strcasecmp(func_name, "COUNT") == 0) *kind = AGG_COUNT;
+    else if (strcasecmp(func_name, "SUM") == 0) *kind = AGG_SUM;
+    else if (strcasecmp(func_name, "AVG") == 0) *kind = AGG_AVG;
+    else if (strcasecmp(func_name, "MIN") == 0) *kind = AGG_MIN;
+    else if (strcasecmp(func_name, "MAX") == 0) *kind = AGG_MAX;
+    else if (strcasecmp(func_name, "STDDEV") == 0 || strcasecmp(func_name, "STDDEV_POP") == 0) *kind = AGG_STDDEV;
+    else if (strcasecmp(func_name, "MEDIAN") == 0) *kind = AGG_MEDIAN;
+    else return false;
+    return true;
+}
+
+/* parse the column specs of the SELECT list once, instead of once per group */
+static OutputColumn* plan_output_columns(ASTNode* select_node, CsvTable* table, int* out_acc_count) {
+    int column_count = select_node->select.column_count;
+    OutputColumn* outputs = calloc(column_count > 0 ? column_count : 1, sizeof(OutputColumn));
+    int acc_count = 0;
+    
+    for (int col = 0; col < column_count; col++) {
+        const char* col_spec = select_node->select.columns[col];
+        OutputColumn* out = &outputs[col];
+        char col_name[256];
+        char func_name[64] = "";
+        
+        out->col_idx = -1;
+        out->acc_index = -1;
+        
+        /* strip " AS alias" */
+        const char* as_pos = cq_strcasestr(col_spec, " AS ");
+        size_t col_len = as_pos ? (size_t)(as_pos - col_spec) : strlen(col_spec);
+        if (col_len >= sizeof(col_name)) col_len = sizeof(col_name) - 1;
+        strncpy(col_name, col_spec, col_len);
+        col_name[col_len] = '\0';
+        trim_trailing_spaces(col_name);
+        
+        char* paren = strchr(col_name, '(');
+        if (paren) {
+            int func_len = paren - col_name;
+            if (func_len >= (int)sizeof(func_name)) func_len = sizeof(func_name) - 1;
+            strncpy(func_name, col_name, func_len);
+            func_name[func_len] = '\0';
+            
+            if (!parse_aggregate_kind(func_name, &out->agg)) {
+                out->kind = OUTPUT_SCALAR;
+                continue;
+            }
+            
+            /* extract the column argument */
+            char* arg_start = paren + 1;
+            char* paren_close = strchr(arg_start, ')');
+            if (paren_close) *paren_close = '\0';
+            
+            out->kind = OUTPUT_AGGREGATE;
+            out->acc_index = acc_count++;
+            out->count_star = (out->agg == AGG_COUNT && strcmp(arg_start, "*") == 0);
+            if (!out->count_star) {
+                out->col_idx = find_column_index_with_fallback(table, arg_start);
+            }
+            continue;
+        }
+        
+        ASTNode* col_node = select_node->select.column_nodes ? select_node->select.column_nodes[col] : NULL;
+        if (col_node && col_node->type != NODE_TYPE_IDENTIFIER) {
+            out->kind = OUTPUT_EXPRESSION;
+        } else {
+            out->kind = OUTPUT_COLUMN;
+            out->col_idx = find_column_index_with_fallback(table, col_name);
+        }
+    }
     
-    if (!select_node) return result;
+    *out_acc_count = acc_count;
+    return outputs;
+}
+
+static inline bool numeric_value(const Value* val, double* out) {
+    if (val->type == VALUE_TYPE_INTEGER) {
+        *out = (double)val->int_value;
+        return true;
+    }
+    if (val->type == VALUE_TYPE_DOUBLE) {
+        *out = val->double_value;
+        return true;
+    }
+    return false;
+}
+
+/* helper to fold a number into a SUM, AVG, STDDEV or MEDIAN accumulator */
+static void accumulate_number(Accumulator* acc, const OutputColumn* out, double x) {
+    if (out->agg == AGG_MEDIAN) {
+        if (acc->value_count >= acc->value_capacity) {
+            acc->value_capacity = acc->value_capacity == 0 ? 16 : acc->value_capacity * 2;
+            acc->values = realloc(acc->values, sizeof(double) * acc->value_capacity);
+        }
+        acc->values[acc->value_count++] = x;
+        return;
+    }
     
-    result->column_count = select_node->select.column_count;
-    result->columns = malloc(sizeof(Column) * result->column_count);
+    acc->numeric_count++;
+    acc->sum += x;
+    if (out->agg == AGG_STDDEV) {
+        double delta = x - acc->mean;
+        acc->mean += delta / acc->numeric_count;
+        acc->m2 += delta * (x - acc->mean);
+    }
+}
+
+/* fold one row into an accumulator, index is the entry of the row in out->vector */
+static void accumulate(Accumulator* acc, const OutputColumn* out, Row* row, int index) {
+    if (out->col_idx < 0 || out->agg == AGG_COUNT) return;
+    
+    const ColumnVector* vector = out->vector;
+    if (vector) {
+        // NULL entries are skipped by every aggregate
+        if (!column_vector_valid(vector, index)) return;
+        
+        if (out->agg == AGG_MIN || out->agg == AGG_MAX) {
+            if (acc->extreme) {
+                int cmp = column_vector_compare(vector, index, acc->extreme_index);
+                if (out->agg == AGG_MIN ? cmp >= 0 : cmp <= 0) return;
+            }
+            acc->extreme = row_value(row, out->col_idx);
+            acc->extreme_index = index;
+        } else if (vector->type == VALUE_TYPE_INTEGER || vector->type == VALUE_TYPE_DOUBLE) {
+            accumulate_number(acc, out, column_vector_number(vector, index));
+        }
+        return;
+    }
+    
+    const Value* val = row_value(row, out->col_idx);
+    double x;
+    
+    switch (out->agg) {
+        case AGG_COUNT:
+            break;
+        case AGG_MIN:
+        case AGG_MAX:
+            if (val->type == VALUE_TYPE_NULL) break;
+            if (!acc->extreme ||
+                (out->agg == AGG_MIN && value_compare(val, acc->extreme) < 0) ||
+                (out->agg == AGG_MAX && value_compare(val, acc->extreme) > 0)) {
+                acc->extreme = val;
+            }
+            break;
+        case AGG_SUM:
+        case AGG_AVG:
+        case AGG_STDDEV:
+        case AGG_MEDIAN:
+            if (numeric_value(val, &x)) accumulate_number(acc, out, x);
+            break;
+    }
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+/* final value of an aggregate, same result types as evaluate_aggregate */
+static Value finalize_aggregate(Accumulator* acc, const OutputColumn* out, long long row_count) {
+    Value result;
+    result.type = VALUE_TYPE_NULL;
     
-    /* parse column specifications for aliases and functions */
+    if (out->agg == AGG_COUNT && out->count_star) {
+        result.type = VALUE_TYPE_INTEGER;
+        result.int_value = row_count;
+        return result;
+    }
+    
+    if (out->col_idx < 0) return result;
+    
+    switch (out->agg) {
+        case AGG_COUNT:
+            result.type = VALUE_TYPE_INTEGER;
+            result.int_value = row_count;
+            break;
+        case AGG_SUM:
+            result.type = VALUE_TYPE_DOUBLE;
+            result.double_value = acc->sum;
+            break;
+        case AGG_AVG:
+            result.type = VALUE_TYPE_DOUBLE;
+            result.double_value = acc->numeric_count > 0 ? acc->sum / acc->numeric_count : 0;
+            break;
+        case AGG_MIN:
+        case AGG_MAX:
+            if (acc->extreme) result = value_copy(acc->extreme);
+            break;
+        case AGG_STDDEV:
+            if (acc->numeric_count > 0) {
+                result.type = VALUE_TYPE_DOUBLE;
+                result.double_value = sqrt(acc->m2 / acc->numeric_count);
+            }
+            break;
+        case AGG_MEDIAN:
+            if (acc->value_count > 0) {
+                qsort(acc->values, acc->value_count, sizeof(double), compare_doubles);
+                result.type = VALUE_TYPE_DOUBLE;
+                if (acc->value_count % 2 == 1) {
+                    result.double_value = acc->values[acc->value_count / 2];
+                } else {
+                    result.double_value = (acc->values[acc->value_count / 2 - 1] +
+                                           acc->values[acc->value_count / 2]) / 2.0;
+                }
+            }
+            break;
+    }
+    
+    return result;
+}
+
+/* helper to name the output columns of an aggregated result */
+static void set_aggregate_column_names(ResultSet* result, ASTNode* select_node) {
     for (int i = 0; i < result->column_count; i++) {
         const char* col_spec = select_node->select.columns[i];
         
@@ -591,106 +681,182 @@ ResultSet* build_aggregated_result(QueryContext* ctx, GroupResult* groups, ASTNo
         }
         result->columns[i].inferred_type = VALUE_TYPE_STRING;
     }
+}
+
+/* single pass hash aggregation: every row is routed to its group through a hash table keyed
+ * on typed value tuples and folded into fixed size accumulators, so memory is proportional to
+ * the number of groups. with key_count == 0 all rows form one group, which exists even when
+ * there are no rows. groups are emitted in first-seen order */
+ResultSet* aggregate_rows(QueryContext* ctx, Row** rows, int row_count, char** group_columns,
+                          ASTNode** group_exprs, int key_count, ASTNode* select_node) {
+    ResultSet* result = calloc(1, sizeof(ResultSet));
+    result->filename = strdup("query_result");
+    result->has_header = true;
+    result->delimiter = ',';
+    result->quote = '"';
     
-    /* building rows, one row per group */
-    result->row_count = groups->group_count;
-    result->row_capacity = groups->group_count;
-    result->rows = malloc(sizeof(Row) * result->row_count);
+    if (!select_node) return result;
     
-    for (int g = 0; g < groups->group_count; g++) {
-        GroupedRows* group = &groups->groups[g];
-        result->rows[g].column_count = result->column_count;
-        result->rows[g].values = malloc(sizeof(Value) * result->column_count);
+    CsvTable* table = ctx->tables[0].table;
+    
+    result->column_count = select_node->select.column_count;
+    result->columns = malloc(sizeof(Column) * result->column_count);
+    set_aggregate_column_names(result, select_node);
+    
+    int acc_count = 0;
+    OutputColumn* outputs = plan_output_columns(select_node, table, &acc_count);
+    
+    /* aggregate arguments are read from the typed column vectors, which are indexed
+     * by the position of a row in the table */
+    bool rows_in_table = true;
+    for (int i = 0; i < row_count && rows_in_table; i++) {
+        rows_in_table = rows[i] >= table->rows && rows[i] < table->rows + table->row_count;
+    }
+    for (int col = 0; rows_in_table && col < select_node->select.column_count; col++) {
+        OutputColumn* out = &outputs[col];
+        if (out->kind == OUTPUT_AGGREGATE && out->agg != AGG_COUNT && out->col_idx >= 0) {
+            out->vector = columnar_vector_for(ctx, out->col_idx, row_count);
+        }
+    }
+    
+    /* resolve group key columns */
+    int* key_cols = malloc(sizeof(int) * (key_count > 0 ? key_count : 1));
+    bool missing_key_column = false;
+    for (int k = 0; k < key_count; k++) {
+        key_cols[k] = group_exprs && group_exprs[k] ? -1 : find_column_index_with_fallback(table, group_columns[k]);
+        if (key_cols[k] < 0 && !(group_exprs && group_exprs[k])) {
+            missing_key_column = true;
+        }
+    }
+    
+    /* grouping on a single unknown column yields no groups */
+    if (key_count == 1 && missing_key_column) {
+        row_count = 0;
+    }
+    
+    ValueHashTable lookup;
+    value_hash_table_init(&lookup, key_count);
+    Value* key = malloc(sizeof(Value) * (key_count > 0 ? key_count : 1));
+    
+    int group_capacity = 16;
+    int group_count = 0;
+    GroupState* groups = malloc(sizeof(GroupState) * group_capacity);
+    Accumulator* accs = calloc((size_t)group_capacity * (acc_count > 0 ? acc_count : 1), sizeof(Accumulator));
+    
+    if (key_count == 0) {
+        groups[0].first_row = NULL;
+        groups[0].row_count = 0;
+        group_count = 1;
+    }
+    
+    for (int i = 0; i < row_count; i++) {
+        int group_idx = 0;
         
-        for (int col = 0; col < result->column_count; col++) {
-            const char* col_spec = select_node->select.columns[col];
-            char col_name[256];
-            char func_name[64] = "";
-            
-            /* parse column specification */
-            char* alias = extract_column_alias(col_spec);
-            if (alias) {
-                // find " AS " in the original string to extract the expression part
-                const char* as_pos = cq_strcasestr(col_spec, " AS ");
-                if (as_pos) {
-                    int col_len = as_pos - col_spec;
-                    strncpy(col_name, col_spec, col_len);
-                    col_name[col_len] = '\0';
+        if (key_count > 0) {
+            for (int k = 0; k < key_count; k++) {
+                if (group_exprs && group_exprs[k]) {
+                    key[k] = evaluate_expression(ctx, group_exprs[k], rows[i], 0);
+                } else if (key_cols[k] >= 0) {
+                    key[k] = *row_value(rows[i], key_cols[k]);
+                } else {
+                    key[k].type = VALUE_TYPE_NULL;
                 }
-                free(alias);
-            } else {
-                strcpy(col_name, col_spec);
             }
             
-            /* trim trailing spaces */
-            trim_trailing_spaces(col_name);
+            group_idx = value_hash_table_insert(&lookup, key, NULL);
             
-            /* check if it's a function call */
-            char* paren = strchr(col_name, '(');
-            if (paren) {
-                /* extract function name */
-                int func_len = paren - col_name;
-                strncpy(func_name, col_name, func_len);
-                func_name[func_len] = '\0';
-                
-                /* check if it's an aggregate function */
-                if (is_aggregate_function(func_name)) {
-                    /* extract column argument */
-                    char* arg_start = paren + 1;
-                    char* paren_close = strchr(arg_start, ')');
-                    if (paren_close) {
-                        int arg_len = paren_close - arg_start;
-                        char temp_buf[256];
-                        strncpy(temp_buf, arg_start, arg_len);
-                        temp_buf[arg_len] = '\0';
-                        strcpy(col_name, temp_buf);
+            for (int k = 0; k < key_count; k++) {
+                if (group_exprs && group_exprs[k]) value_free(&key[k]);
+            }
+            
+            if (group_idx >= group_count) {
+                if (group_count >= group_capacity) {
+                    int old_capacity = group_capacity;
+                    group_capacity *= 2;
+                    groups = realloc(groups, sizeof(GroupState) * group_capacity);
+                    if (acc_count > 0) {
+                        accs = realloc(accs, sizeof(Accumulator) * group_capacity * acc_count);
+                        memset(&accs[(size_t)old_capacity * acc_count], 0,
+                               sizeof(Accumulator) * (group_capacity - old_capacity) * acc_count);
                     }
-                    
-                    /* handle qualified identifiers in function argument
-                       pass the full column name to evaluate_aggregate
-                       it will try exact match first, then strip prefix if needed */
-                    
-                    /* evaluate aggregate function */
-                    Value tmp = evaluate_aggregate(func_name, group->rows, group->row_count, 
-                                                   ctx->tables[0].table, col_name);
-                    result->rows[g].values[col] = value_copy(&tmp);
-                } else {
+                }
+                groups[group_count].first_row = NULL;
+                groups[group_count].row_count = 0;
+                group_count++;
+            }
+        }
+        
+        GroupState* group = &groups[group_idx];
+        if (!group->first_row) group->first_row = rows[i];
+        group->row_count++;
+        
+        Accumulator* group_accs = &accs[(size_t)group_idx * acc_count];
+        int index = rows_in_table ? (int)(rows[i] - table->rows) : -1;
+        for (int col = 0; col < result->column_count; col++) {
+            if (outputs[col].kind == OUTPUT_AGGREGATE) {
+                accumulate(&group_accs[outputs[col].acc_index], &outputs[col], rows[i], index);
+            }
+        }
+    }
+    
+    free(key);
+    value_hash_table_free(&lookup);
+    free(key_cols);
+    
+    /* building rows, one row per group */
+    result->row_count = group_count;
+    result->row_capacity = group_count;
+    result->rows = calloc(group_count > 0 ? group_count : 1, sizeof(Row));
+    
+    for (int g = 0; g < group_count; g++) {
+        GroupState* group = &groups[g];
+        Accumulator* group_accs = &accs[(size_t)g * acc_count];
+        result->rows[g].column_count = result->column_count;
+        result->rows[g].values = malloc(sizeof(Value) * result->column_count);
+        
+        for (int col = 0; col < result->column_count; col++) {
+            OutputColumn* out = &outputs[col];
+            Value* dst = &result->rows[g].values[col];
+            dst->type = VALUE_TYPE_NULL;
+            
+            switch (out->kind) {
+                case OUTPUT_AGGREGATE:
+                    *dst = finalize_aggregate(&group_accs[out->acc_index], out, group->row_count);
+                    break;
+                case OUTPUT_SCALAR:
                     /* scalar function - evaluate on first row of the group */
-                    if (group->row_count > 0) {
-                        Value tmp = evaluate_column_expression(col_spec, ctx, group->rows[0], NULL, col);
-                        result->rows[g].values[col] = value_copy(&tmp);
-                    } else {
-                        result->rows[g].values[col].type = VALUE_TYPE_NULL;
+                    if (group->first_row) {
+                        Value tmp = evaluate_column_expression(select_node->select.columns[col], ctx,
+                                                               group->first_row, NULL, col);
+                        *dst = value_copy(&tmp);
+                        value_free(&tmp);
                     }
-                }
-            } else {
-                /* regular column - check if we have a column_node (expression) for it */
-                ASTNode* col_node = select_node->select.column_nodes ? select_node->select.column_nodes[col] : NULL;
-                
-                if (col_node && col_node->type != NODE_TYPE_IDENTIFIER) {
-                    /* this is an expression (CASE, function call, etc.) - evaluate it on first row */
-                    if (group->row_count > 0) {
-                        Value tmp = evaluate_expression(ctx, col_node, group->rows[0], 0);
-                        result->rows[g].values[col] = value_copy(&tmp);
-                    } else {
-                        result->rows[g].values[col].type = VALUE_TYPE_NULL;
+                    break;
+                case OUTPUT_EXPRESSION:
+                    /* expression (CASE, arithmetic, etc.) - evaluate on first row */
+                    if (group->first_row) {
+                        Value tmp = evaluate_expression(ctx, select_node->select.column_nodes[col], group->first_row, 0);
+                        *dst = value_copy(&tmp);
+                        value_free(&tmp);
                     }
-                } else {
+                    break;
+                case OUTPUT_COLUMN:
                     /* regular column reference - use first row's value from the group */
-                    int col_idx = find_column_index_with_fallback(ctx->tables[0].table, col_name);
-                    
-                    if (col_idx >= 0 && group->row_count > 0) {
-                        Value* src = &group->rows[0]->values[col_idx];
-                        Value* dst = &result->rows[g].values[col];
-                        
-                        value_deep_copy(dst, src);
-                    } else {
-                        result->rows[g].values[col].type = VALUE_TYPE_NULL;
+                    if (out->col_idx >= 0 && group->first_row) {
+                        value_deep_copy(dst, row_value(group->first_row, out->col_idx));
                     }
-                }
+                    break;
             }
         }
+        
+        for (int a = 0; a < acc_count; a++) {
+            free(group_accs[a].values);
+        }
     }
     
+    free(accs);
+    free(groups);
+    free(outputs);
+    
     return result;
 }
@@ -0,0 +1,699 @@
+/* evaluator_columnar.c - batch WHERE evaluation and sorts over typed column vectors */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include "evaluator.h"
+#include "parser.h"
+#include "csv_reader.h"
+#include "csv_columns.h"
+#include "string_utils.h"
+#include "date_utils.h"
+#include "evaluator/evaluator_columnar.h"
+#include "evaluator/evaluator_core.h"
+#include "evaluator/evaluator_conditions.h"
+
+int columnar_column_index(QueryContext* ctx, const char* name) {
+    if (!ctx || ctx->table_count < 1 || !name) return -1;
+    
+    CsvTable* table = ctx->tables[0].table;
+    int col = csv_get_column_index(table, name);
+    if (col >= 0) return col;
+    
+    // alias.column, only when the alias names the first table itself
+    const char* dot = strchr(name, '.');
+    if (!dot) return -1;
+    
+    char* alias = cq_strndup(name, dot - name);
+    TableRef* table_ref = context_get_table(ctx, alias);
+    free(alias);
+    
+    if (!table_ref || table_ref->table != table) return -1;
+    return csv_get_column_index(table, dot + 1);
+}
+
+const ColumnVector* columnar_vector(QueryContext* ctx, int col) {
+    const ColumnVector* vector = csv_column_vector(ctx->tables[0].table, col);
+    return vector && vector->typed ? vector : NULL;
+}
+
+const ColumnVector* columnar_vector_for(QueryContext* ctx, int col, int row_count) {
+    CsvTable* table = ctx->tables[0].table;
+    if (col < 0 || col >= table->column_count) return NULL;
+    
+    // a few rows left by a selective filter are cheaper to read from the rows
+    bool built = table->vectors && table->vectors[col];
+    if (!built && (long long)row_count * 2 < table->row_count) return NULL;
+    
+    return columnar_vector(ctx, col);
+}
+
+/* ===== filtering ===== */
+
+/* values of an expression for the selected rows of a batch, entry k belongs to the k-th
+ * selected row. a constant holds one value for every row at index 0 */
+typedef struct {
+    ValueType type;       // type of every non NULL entry, VALUE_TYPE_NULL if all are NULL
+    bool constant;
+    bool mixed;           // doubles some of which evaluate_expression would type as integers
+    bool has_nulls;
+    unsigned char nulls[COLUMNAR_BATCH_SIZE];
+    union {
+        long long ints[COLUMNAR_BATCH_SIZE];
+        double doubles[COLUMNAR_BATCH_SIZE];
+        DateValue dates[COLUMNAR_BATCH_SIZE];
+        StringRef strings[COLUMNAR_BATCH_SIZE];
+    };
+} BatchVector;
+
+/* rows of the first table covered by the batch being filtered */
+typedef struct {
+    QueryContext* ctx;
+    int start;
+} Batch;
+
+/* helper to map a comparison operator */
+static bool comparison_op(const char* op, RowFilterOp* out) {
+    if (strcmp(op, "=") == 0) *out = ROW_FILTER_EQ;
+    else if (strcmp(op, "!=") == 0 || strcmp(op, "<>") == 0) *out = ROW_FILTER_NE;
+    else if (strcmp(op, "<") == 0) *out = ROW_FILTER_LT;
+    else if (strcmp(op, "<=") == 0) *out = ROW_FILTER_LE;
+    else if (strcmp(op, ">") == 0) *out = ROW_FILTER_GT;
+    else if (strcmp(op, ">=") == 0) *out = ROW_FILTER_GE;
+    else return false;
+    return true;
+}
+
+/* the same comparison with its operands swapped */
+static RowFilterOp mirror_op(RowFilterOp op) {
+    switch (op) {
+        case ROW_FILTER_LT: return ROW_FILTER_GT;
+        case ROW_FILTER_LE: return ROW_FILTER_GE;
+        case ROW_FILTER_GT: return ROW_FILTER_LT;
+        case ROW_FILTER_GE: return ROW_FILTER_LE;
+        default: return op;
+    }
+}
+
+static inline bool comparison_holds(RowFilterOp op, int cmp) {
+    switch (op) {
+        case ROW_FILTER_EQ: return cmp == 0;
+        case ROW_FILTER_NE: return cmp != 0;
+        case ROW_FILTER_LT: return cmp < 0;
+        case ROW_FILTER_LE: return cmp <= 0;
+        case ROW_FILTER_GT: return cmp > 0;
+        case ROW_FILTER_GE: return cmp >= 0;
+        default: return false;
+    }
+}
+
+static bool is_arithmetic_op(const char* op) {
+    return strcmp(op, "+") == 0 || strcmp(op, "-") == 0 || strcmp(op, "*") == 0 ||
+           strcmp(op, "/") == 0 || strcmp(op, "%") == 0 || strcmp(op, "&") == 0 ||
+           strcmp(op, "|") == 0 || strcmp(op, "^") == 0;
+}
+
+/* check if an expression is made of literals, columns of the first table and arithmetic,
+ * without building any column vector */
+static bool batch_expression_supported(QueryContext* ctx, ASTNode* expr) {
+    if (!expr) return false;
+    
+    switch (expr->type) {
+        case NODE_TYPE_LITERAL:
+            return true;
+        case NODE_TYPE_IDENTIFIER:
+            return columnar_column_index(ctx, expr->identifier) >= 0;
+        case NODE_TYPE_BINARY_OP:
+            if (!expr->binary_op.left) {
+                const char* op = expr->binary_op.operator;
+                return (strcmp(op, "-") == 0 || strcmp(op, "+") == 0) &&
+                       batch_expression_supported(ctx, expr->binary_op.right);
+            }
+            return expr->binary_op.right && is_arithmetic_op(expr->binary_op.operator) &&
+                   batch_expression_supported(ctx, expr->binary_op.left) &&
+                   batch_expression_supported(ctx, expr->binary_op.right);
+        default:
+            return false;
+    }
+}
+
+static BatchVector* batch_vector_new(void) {
+    BatchVector* vector = malloc(sizeof(BatchVector));
+    vector->type = VALUE_TYPE_NULL;
+    vector->constant = false;
+    vector->mixed = false;
+    vector->has_nulls = false;
+    return vector;
+}
+
+static void batch_constant(BatchVector* out, const Value* value) {
+    out->constant = true;
+    out->type = value->type;
+    out->nulls[0] = value->type == VALUE_TYPE_NULL;
+    out->has_nulls = out->nulls[0];
+    
+    switch (value->type) {
+        case VALUE_TYPE_INTEGER: out->ints[0] = value->int_value; break;
+        case VALUE_TYPE_DOUBLE: out->doubles[0] = value->double_value; break;
+        case VALUE_TYPE_DATE: out->dates[0] = value->date_value; break;
+        case VALUE_TYPE_STRING:
+            out->strings[0].data = value->string_value;
+            out->strings[0].length = value->string_length;
+            break;
+        default: break;
+    }
+}
+
+/* helper to gather the selected entries of a column vector */
+static void batch_gather(BatchVector* out, const ColumnVector* column, int start, const int* sel, int count) {
+    out->type = column->type;
+    out->mixed = column->widened;
+    out->has_nulls = column->null_count > 0;
+    
+    for (int k = 0; k < count; k++) {
+        out->nulls[k] = !column_vector_valid(column, start + sel[k]);
+    }
+    
+    switch (column->type) {
+        case VALUE_TYPE_INTEGER:
+            for (int k = 0; k < count; k++) out->ints[k] = column->ints[start + sel[k]];
+            break;
+        case VALUE_TYPE_DOUBLE:
+            for (int k = 0; k < count; k++) out->doubles[k] = column->doubles[start + sel[k]];
+            break;
+        case VALUE_TYPE_DATE:
+            for (int k = 0; k < count; k++) out->dates[k] = column->dates[start + sel[k]];
+            break;
+        case VALUE_TYPE_STRING:
+            for (int k = 0; k < count; k++) out->strings[k] = column->strings[start + sel[k]];
+            break;
+        default:
+            break;
+    }
+}
+
+static inline bool batch_numeric(const BatchVector* vector) {
+    return vector->type == VALUE_TYPE_INTEGER || vector->type == VALUE_TYPE_DOUBLE;
+}
+
+/* helper to read the numbers of a numeric batch as doubles */
+static void batch_numbers(const BatchVector* vector, int count, double* out) {
+    int n = vector->constant ? 1 : count;
+    if (vector->type == VALUE_TYPE_INTEGER) {
+        for (int k = 0; k < n; k++) out[k] = (double)vector->ints[k];
+    } else {
+        memcpy(out, vector->doubles, sizeof(double) * n);
+    }
+}
+
+static inline bool batch_null(const BatchVector* vector, int k) {
+    return vector->nulls[vector->constant ? 0 : k];
+}
+
+static bool batch_expression(Batch* batch, ASTNode* expr, const int* sel, int count, BatchVector* out);
+
+/* unary minus and plus, the same as evaluate_expression */
+static bool batch_unary(Batch* batch, ASTNode* expr, const int* sel, int count, BatchVector* out) {
+    if (!batch_expression(batch, expr->binary_op.right, sel, count, out)) return false;
+    if (strcmp(expr->binary_op.operator, "+") == 0) return true;
+    
+    int n = out->constant ? 1 : count;
+    if (out->type == VALUE_TYPE_INTEGER) {
+        for (int k = 0; k < n; k++) out->ints[k] = -out->ints[k];
+    } else if (out->type == VALUE_TYPE_DOUBLE) {
+        for (int k = 0; k < n; k++) out->doubles[k] = -out->doubles[k];
+    } else {
+        // anything else is NULL
+        out->type = VALUE_TYPE_NULL;
+        out->has_nulls = true;
+        memset(out->nulls, 1, n);
+    }
+    return true;
+}
+
+/* binary arithmetic, the same as evaluate_expression: numbers are combined as doubles and
+ * the result of two integers is an integer when it is integral. operators needing integers
+ * are only run on integer batches, the type of each entry of a mixed batch is unknown */
+static bool batch_arithmetic(Batch* batch, ASTNode* expr, const int* sel, int count, BatchVector* out) {
+    const char* op = expr->binary_op.operator;
+    BatchVector* right = batch_vector_new();
+    
+    if (!batch_expression(batch, expr->binary_op.left, sel, count, out) ||
+        !batch_expression(batch, expr->binary_op.right, sel, count, right)) {
+        free(right);
+        return false;
+    }
+    
+    bool constant = out->constant && right->constant;
+    int n = constant ? 1 : count;
+    
+    // a non numeric operand makes every entry NULL
+    if (!batch_numeric(out) || !batch_numeric(right)) {
+        out->type = VALUE_TYPE_NULL;
+        out->constant = constant;
+        out->has_nulls = true;
+        memset(out->nulls, 1, n);
+        free(right);
+        return true;
+    }
+    
+    bool ints = out->type == VALUE_TYPE_INTEGER && right->type == VALUE_TYPE_INTEGER;
+    bool integer_op = strcmp(op, "%") == 0 || strcmp(op, "&") == 0 || strcmp(op, "|") == 0 ||
+                      strcmp(op, "^") == 0;
+    if (integer_op && !ints) {
+        free(right);
+        return false;
+    }
+    
+    unsigned char nulls[COLUMNAR_BATCH_SIZE];
+    for (int k = 0; k < n; k++) {
+        nulls[k] = batch_null(out, k) || batch_null(right, k);
+    }
+    
+    if (integer_op) {
+        char c = op[0];
+        long long a0 = out->ints[0];
+        for (int k = 0; k < n; k++) {
+            long long a = out->constant ? a0 : out->ints[k];
+            long long b = right->ints[right->constant ? 0 : k];
+            if (c == '%') {
+                if (b == 0) nulls[k] = 1;
+                else if (!nulls[k]) out->ints[k] = a % b;
+            } else {
+                out->ints[k] = c == '&' ? (a & b) : c == '|' ? (a | b) : (a ^ b);
+            }
+        }
+    } else {
+        double a[COLUMNAR_BATCH_SIZE];
+        double b[COLUMNAR_BATCH_SIZE];
+        batch_numbers(out, n, a);
+        batch_numbers(right, n, b);
+        
+        char c = op[0];
+        int ia = out->constant ? 0 : 1;
+        int ib = right->constant ? 0 : 1;
+        double* r = out->doubles;
+        switch (c) {
+            case '+': for (int k = 0; k < n; k++) r[k] = a[k * ia] + b[k * ib]; break;
+            case '-': for (int k = 0; k < n; k++) r[k] = a[k * ia] - b[k * ib]; break;
+            case '*': for (int k = 0; k < n; k++) r[k] = a[k * ia] * b[k * ib]; break;
+            default:
+                for (int k = 0; k < n; k++) {
+                    if (b[k * ib] == 0) nulls[k] = 1;
+                    else r[k] = a[k * ia] / b[k * ib];
+                }
+                break;
+        }
+        
+        out->type = VALUE_TYPE_DOUBLE;
+        out->mixed = out->mixed || right->mixed;
+        if (ints) {
+            // integral results of two integers are integers
+            bool integral = true;
+            for (int k = 0; k < n && integral; k++) {
+                integral = nulls[k] || (fabs(r[k]) < 9.2e18 && r[k] == (double)(long long)r[k]);
+            }
+            if (integral) {
+                for (int k = 0; k < n; k++) out->ints[k] = nulls[k] ? 0 : (long long)r[k];
+                out->type = VALUE_TYPE_INTEGER;
+            } else {
+                out->mixed = true;
+            }
+        }
+    }
+    
+    out->constant = constant;
+    out->has_nulls = false;
+    for (int k = 0; k < n; k++) {
+        out->nulls[k] = nulls[k];
+        out->has_nulls |= nulls[k];
+    }
+    free(right);
+    return true;
+}
+
+/* values of an expression for the selected rows, false if it needs evaluate_expression */
+static bool batch_expression(Batch* batch, ASTNode* expr, const int* sel, int count, BatchVector* out) {
+    out->type = VALUE_TYPE_NULL;
+    out->constant = false;
+    out->mixed = false;
+    out->has_nulls = false;
+    
+    switch (expr->type) {
+        case NODE_TYPE_LITERAL: {
+            Value literal = parse_value_borrowed(expr->literal, strlen(expr->literal));
+            batch_constant(out, &literal);
+            return true;
+        }
+        case NODE_TYPE_IDENTIFIER: {
+            int col = columnar_column_index(batch->ctx, expr->identifier);
+            const ColumnVector* column = col >= 0 ? columnar_vector(batch->ctx, col) : NULL;
+            if (!column) return false;
+            batch_gather(out, column, batch->start, sel, count);
+            return true;
+        }
+        case NODE_TYPE_BINARY_OP:
+            if (!expr->binary_op.left) return batch_unary(batch, expr, sel, count, out);
+            return batch_arithmetic(batch, expr, sel, count, out);
+        default:
+            return false;
+    }
+}
+
+static int compare_strings(const StringRef* a, const StringRef* b) {
+    size_t len = a->length < b->length ? a->length : b->length;
+    int cmp = len > 0 ? memcmp(a->data, b->data, len) : 0;
+    if (cmp != 0) return cmp;
+    if (a->length == b->length) return 0;
+    return a->length < b->length ? -1 : 1;
+}
+
+/* value_compare of two non NULL entries */
+static int compare_entries(const BatchVector* a, int ka, const BatchVector* b, int kb) {
+    if (batch_numeric(a) && batch_numeric(b)) {
+        double x = a->type == VALUE_TYPE_INTEGER ? (double)a->ints[ka] : a->doubles[ka];
+        double y = b->type == VALUE_TYPE_INTEGER ? (double)b->ints[kb] : b->doubles[kb];
+        return (x > y) - (x < y);
+    }
+    if (a->type != b->type) return 0;
+    if (a->type == VALUE_TYPE_DATE) return compare_dates(a->dates[ka], b->dates[kb]);
+    if (a->type == VALUE_TYPE_STRING) return compare_strings(&a->strings[ka], &b->strings[kb]);
+    return 0;
+}
+
+/* keep the selected rows whose numbers compare as op with y */
+#define COMPARE_SCALAR(test) \
+    for (int k = 0; k < count; k++) { \
+        double x = a[k]; \
+        out[kept] = sel[k]; \
+        kept += (test); \
+    }
+
+static int compare_numbers_scalar(const double* a, double y, RowFilterOp op, const int* sel, int count, int* out) {
+    int kept = 0;
+    switch (op) {
+        case ROW_FILTER_EQ: COMPARE_SCALAR(x == y); break;
+        case ROW_FILTER_NE: COMPARE_SCALAR(x != y); break;
+        case ROW_FILTER_LT: COMPARE_SCALAR(x < y); break;
+        case ROW_FILTER_LE: COMPARE_SCALAR(x <= y); break;
+        case ROW_FILTER_GT: COMPARE_SCALAR(x > y); break;
+        case ROW_FILTER_GE: COMPARE_SCALAR(x >= y); break;
+        default: break;
+    }
+    return kept;
+}
+
+/* keep the selected rows where left op right holds, written to out in order */
+static int compare_batches(BatchVector* left, BatchVector* right, RowFilterOp op,
+                           const int* sel, int count, int* out) {
+    // a constant goes on the right
+    if (left->constant && !right->constant) {
+        BatchVector* tmp = left;
+        left = right;
+        right = tmp;
+        op = mirror_op(op);
+    }
+    
+    // numbers against a number without NULLs, the common `column < literal`
+    if (!left->constant && right->constant && batch_numeric(left) && batch_numeric(right) &&
+        !left->has_nulls && !right->has_nulls) {
+        double a[COLUMNAR_BATCH_SIZE];
+        double y;
+        batch_numbers(left, count, a);
+        batch_numbers(right, 1, &y);
+        return compare_numbers_scalar(a, y, op, sel, count, out);
+    }
+    
+    int kept = 0;
+    for (int k = 0; k < count; k++) {
+        int ka = left->constant ? 0 : k;
+        int kb = right->constant ? 0 : k;
+        bool null_a = left->nulls[ka];
+        bool null_b = right->nulls[kb];
+        
+        int cmp;
+        if (null_a || null_b) cmp = null_a && null_b ? 0 : (null_a ? -1 : 1);
+        else cmp = compare_entries(left, ka, right, kb);
+        
+        out[kept] = sel[k];
+        kept += comparison_holds(op, cmp);
+    }
+    return kept;
+}
+
+/* helper to run evaluate_condition on each selected row */
+static int filter_by_row(Batch* batch, ASTNode* condition, const int* sel, int count, int* out) {
+    Row* rows = batch->ctx->tables[0].table->rows + batch->start;
+    int kept = 0;
+    for (int k = 0; k < count; k++) {
+        if (evaluate_condition(batch->ctx, condition, &rows[sel[k]], 0)) out[kept++] = sel[k];
+    }
+    return kept;
+}
+
+static int filter_condition(Batch* batch, ASTNode* condition, const int* sel, int count, int* out);
+
+/* the selected rows for which a comparison holds */
+static int filter_comparison(Batch* batch, ASTNode* condition, RowFilterOp op, const int* sel, int count,
+                             int* out) {
+    ASTNode* left_expr = condition->condition.left;
+    ASTNode* right_expr = condition->condition.right;
+    if (!batch_expression_supported(batch->ctx, left_expr) ||
+        !batch_expression_supported(batch->ctx, right_expr)) {
+        return filter_by_row(batch, condition, sel, count, out);
+    }
+    
+    BatchVector* left = batch_vector_new();
+    BatchVector* right = batch_vector_new();
+    int kept;
+    
+    if (batch_expression(batch, left_expr, sel, count, left) &&
+        batch_expression(batch, right_expr, sel, count, right)) {
+        kept = compare_batches(left, right, op, sel, count, out);
+    } else {
+        kept = filter_by_row(batch, condition, sel, count, out);
+    }
+    
+    free(left);
+    free(right);
+    return kept;
+}
+
+/* the selected rows for which an IN or NOT IN list holds */
+static int filter_in_list(Batch* batch, ASTNode* condition, bool is_not_in, const int* sel, int count,
+                          int* out) {
+    ASTNode* list = condition->condition.right;
+    bool supported = batch_expression_supported(batch->ctx, condition->condition.left);
+    for (int i = 0; supported && i < list->list.node_count; i++) {
+        supported = batch_expression_supported(batch->ctx, list->list.nodes[i]);
+    }
+    
+    BatchVector* left = batch_vector_new();
+    BatchVector* item = batch_vector_new();
+    if (!supported || !batch_expression(batch, condition->condition.left, sel, count, left)) {
+        free(left);
+        free(item);
+        return filter_by_row(batch, condition, sel, count, out);
+    }
+    
+    // every entry is compared with each item of the list, IN holds when one is equal
+    int entries[COLUMNAR_BATCH_SIZE];
+    int matched[COLUMNAR_BATCH_SIZE];
+    unsigned char found[COLUMNAR_BATCH_SIZE];
+    memset(found, 0, count);
+    for (int k = 0; k < count; k++) entries[k] = k;
+    
+    for (int i = 0; i < list->list.node_count; i++) {
+        if (!batch_expression(batch, list->list.nodes[i], sel, count, item)) {
+            free(left);
+            free(item);
+            return filter_by_row(batch, condition, sel, count, out);
+        }
+        
+        int n = compare_batches(left, item, ROW_FILTER_EQ, entries, count, matched);
+        for (int m = 0; m < n; m++) found[matched[m]] = 1;
+    }
+    
+    int kept = 0;
+    for (int k = 0; k < count; k++) {
+        if (found[k] != is_not_in) out[kept++] = sel[k];
+    }
+    
+    free(left);
+    free(item);
+    return kept;
+}
+
+/* helper to keep the rows of sel missing from the ordered subset matched */
+static int filter_complement(const int* sel, int count, const int* matched, int matched_count, int* out) {
+    int kept = 0;
+    int m = 0;
+    for (int k = 0; k < count; k++) {
+        if (m < matched_count && matched[m] == sel[k]) m++;
+        else out[kept++] = sel[k];
+    }
+    return kept;
+}
+
+/* the selected rows for which a condition holds, the same rows evaluate_condition accepts.
+ * AND hands the rows kept by its left side to its right side, OR only evaluates its right
+ * side on the rows its left side rejected */
+static int filter_condition(Batch* batch, ASTNode* condition, const int* sel, int count, int* out) {
+    if (count == 0) return 0;
+    if (!condition || condition->type != NODE_TYPE_CONDITION) {
+        return filter_by_row(batch, condition, sel, count, out);
+    }
+    
+    const char* op = condition->condition.operator;
+    ASTNode* left = condition->condition.left;
+    ASTNode* right = condition->condition.right;
+    
+    if (strcasecmp(op, "NOT") == 0) {
+        int matched[COLUMNAR_BATCH_SIZE];
+        int matched_count = filter_condition(batch, left, sel, count, matched);
+        return filter_complement(sel, count, matched, matched_count, out);
+    }
+    
+    if (strcasecmp(op, "AND") == 0) {
+        int kept[COLUMNAR_BATCH_SIZE];
+        int kept_count = filter_condition(batch, left, sel, count, kept);
+        return filter_condition(batch, right, kept, kept_count, out);
+    }
+    
+    if (strcasecmp(op, "OR") == 0) {
+        int first[COLUMNAR_BATCH_SIZE];
+        int rest[COLUMNAR_BATCH_SIZE];
+        int second[COLUMNAR_BATCH_SIZE];
+        int first_count = filter_condition(batch, left, sel, count, first);
+        int rest_count = filter_complement(sel, count, first, first_count, rest);
+        int second_count = filter_condition(batch, right, rest, rest_count, second);
+        
+        // merge the two ordered lists
+        int kept = 0, i = 0, j = 0;
+        while (i < first_count || j < second_count) {
+            if (j >= second_count || (i < first_count && first[i] < second[j])) out[kept++] = first[i++];
+            else out[kept++] = second[j++];
+        }
+        return kept;
+    }
+    
+    if (!left || !right) return filter_by_row(batch, condition, sel, count, out);
+    
+    RowFilterOp filter_op;
+    if (comparison_op(op, &filter_op)) {
+        return filter_comparison(batch, condition, filter_op, sel, count, out);
+    }
+    
+    if ((strcasecmp(op, "IN") == 0 || strcasecmp(op, "NOT IN") == 0) && right->type == NODE_TYPE_LIST) {
+        return filter_in_list(batch, condition, strcasecmp(op, "NOT IN") == 0, sel, count, out);
+    }
+    
+    return filter_by_row(batch, condition, sel, count, out);
+}
+
+int columnar_filter_batch(QueryContext* ctx, ASTNode* where, int start, int count, int* sel) {
+    int all[COLUMNAR_BATCH_SIZE];
+    for (int k = 0; k < count; k++) all[k] = k;
+    
+    if (!where) {
+        memcpy(sel, all, sizeof(int) * count);
+        return count;
+    }
+    
+    Batch batch = { ctx, start };
+    return filter_condition(&batch, where, all, count, sel);
+}
+
+/* ===== sorting ===== */
+
+typedef struct {
+    double number;
+    int index;
+} NumberKey;
+
+static int compare_number_keys(const void* a, const void* b) {
+    const NumberKey* ka = a;
+    const NumberKey* kb = b;
+    if (ka->number != kb->number) return ka->number < kb->number ? -1 : 1;
+    return ka->index - kb->index;
+}
+
+static int compare_number_keys_desc(const void* a, const void* b) {
+    const NumberKey* ka = a;
+    const NumberKey* kb = b;
+    if (ka->number != kb->number) return ka->number > kb->number ? -1 : 1;
+    return ka->index - kb->index;
+}
+
+typedef struct {
+    const ColumnVector* vector;
+    bool descending;
+} IndexSortContext;
+
+/* global context for index sorting */
+static IndexSortContext* g_index_sort_ctx = NULL;
+
+static int compare_entry_indices(const void* a, const void* b) {
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    int cmp = column_vector_compare(g_index_sort_ctx->vector, ia, ib);
+    if (cmp != 0) return g_index_sort_ctx->descending ? -cmp : cmp;
+    return ia - ib;
+}
+
+/* helper to sort the non NULL entries into order, ties keep their order */
+static void sort_entries(const ColumnVector* vector, bool descending, int* order, int count) {
+    if (vector->type == VALUE_TYPE_INTEGER || vector->type == VALUE_TYPE_DOUBLE) {
+        NumberKey* keys = malloc(sizeof(NumberKey) * (count > 0 ? count : 1));
+        for (int i = 0; i < count; i++) {
+            keys[i].number = column_vector_number(vector, order[i]);
+            keys[i].index = order[i];
+        }
+        qsort(keys, count, sizeof(NumberKey), descending ? compare_number_keys_desc : compare_number_keys);
+        for (int i = 0; i < count; i++) order[i] = keys[i].index;
+        free(keys);
+        return;
+    }
+    
+    IndexSortContext sort_ctx = { vector, descending };
+    g_index_sort_ctx = &sort_ctx;
+    qsort(order, count, sizeof(int), compare_entry_indices);
+    g_index_sort_ctx = NULL;
+}
+
+bool columnar_sort_rows(Row* rows, int row_count, int col, bool descending) {
+    for (int i = 0; i < row_count; i++) {
+        if (col >= rows[i].column_count) return false;
+    }
+    
+    ColumnVector* vector = column_vector_build(rows, row_count, col);
+    if (!vector->typed) {
+        column_vector_free(vector);
+        return false;
+    }
+    
+    // NULL sorts before every value, so NULL rows lead ascending and trail descending
+    int* order = malloc(sizeof(int) * (row_count > 0 ? row_count : 1));
+    int null_count = vector->null_count;
+    int value_count = row_count - null_count;
+    int* values = descending ? order : order + null_count;
+    int* nulls = descending ? order + value_count : order;
+    int v = 0, z = 0;
+    
+    for (int i = 0; i < row_count; i++) {
+        if (column_vector_valid(vector, i)) values[v++] = i;
+        else nulls[z++] = i;
+    }
+    sort_entries(vector, descending, values, value_count);
+    column_vector_free(vector);
+    
+    Row* sorted = malloc(sizeof(Row) * (row_count > 0 ? row_count : 1));
+    for (int i = 0; i < row_count; i++) sorted[i] = rows[order[i]];
+    memcpy(rows, sorted, sizeof(Row) * row_count);
+    
+    free(sorted);
+    free(order);
+    return true;
+}
@@ -2,64 +2,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
-#include <ctype.h>
 #include "evaluator.h"
 #include "parser.h"
 #include "csv_reader.h"
+#include "like.h"
 #include "evaluator/evaluator_conditions.h"
 #include "evaluator/evaluator_expressions.h"
+#include "evaluator/evaluator_program.h"
+#include "evaluator/evaluator_subquery.h"
 
-// forward declarations
-ResultSet* evaluate_query(ASTNode* query_ast);
-
-// pattern matching helper for like/ilike operators
-static bool match_pattern(const char* str, const char* pattern, bool case_sensitive) {
-    if (!str || !pattern) return false;
-    
-    const char* s = str;
-    const char* p = pattern;
-    const char* star = NULL;
-    const char* ss = NULL;
-    
-    while (*s) {
-        if (*p == '%') {
-            // remember position for backtracking
-            star = p++;
-            ss = s;
-        } else if (*p == '_') {
-            // single character wildcard
-            s++;
-            p++;
-        } else {
-            // check character match
-            bool match;
-            if (case_sensitive) {
-                match = (*s == *p);
-            } else {
-                match = (tolower((unsigned char)*s) == tolower((unsigned char)*p));
-            }
-            
-            if (match) {
-                s++;
-                p++;
-            } else if (star) {
-                // backtrack to last %
-                p = star + 1;
-                s = ++ss;
-            } else {
-                return false;
-            }
-        }
-    }
-    
-    // consume remaining % at end of pattern
-    while (*p == '%') p++;
+// evaluate condition expressions, compound conditions run as bytecode compiled on first use
+bool evaluate_condition(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index) {
+    bool result;
+    if (program_check(ctx, condition, current_row, table_index, &result)) return result;
     
-    return *p == '\0';
+    return evaluate_condition_tree(ctx, condition, current_row, table_index);
 }
 
-// evaluate condition expressions, handles logical operators and comparisons
-bool evaluate_condition(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index) {
+// the same walking the tree, handles logical operators and comparisons
+bool evaluate_condition_tree(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index) {
     if (!condition) return true;
     
     if (condition->type != NODE_TYPE_CONDITION) return false;
@@ -85,52 +46,18 @@ bool evaluate_condition(QueryContext* ctx, ASTNode* condition, Row* current_row,
         return left || right;
     }
     
-    // handle comparison operators
     Value left = evaluate_expression(ctx, condition->condition.left, current_row, table_index);
-    Value right = evaluate_expression(ctx, condition->condition.right, current_row, table_index);
-    
-    int cmp = value_compare(&left, &right);
-    
-    if (strcmp(op, "=") == 0) return cmp == 0;
-    if (strcmp(op, "!=") == 0) return cmp != 0;
-    if (strcmp(op, "<>") == 0) return cmp != 0;
-    if (strcmp(op, ">") == 0) return cmp > 0;
-    if (strcmp(op, "<") == 0) return cmp < 0;
-    if (strcmp(op, ">=") == 0) return cmp >= 0;
-    if (strcmp(op, "<=") == 0) return cmp <= 0;
     
-    // handle IN and NOT IN operators
+    // handle IN and NOT IN operators, their right side is a list or a subquery rather than a value
     if (strcasecmp(op, "IN") == 0 || strcasecmp(op, "NOT IN") == 0) {
         bool is_not_in = (strcasecmp(op, "NOT IN") == 0);
         ASTNode* right_node = condition->condition.right;
         
         // check if it's a subquery or a list
         if (right_node->type == NODE_TYPE_SUBQUERY) {
-            // evaluate the subquery
-            if (!right_node->subquery.query) return is_not_in; // NOT IN empty = true
-            
-            ResultSet* subquery_result = evaluate_query(right_node->subquery.query);
-            if (!subquery_result) return is_not_in;
-            
-            // the subquery should return a single column
-            if (subquery_result->column_count != 1) {
-                fprintf(stderr, "Error: IN subquery must return exactly one column\n");
-                csv_free(subquery_result);
-                return false;
-            }
-            
-            // check if left value matches any value in the subquery result
-            bool found = false;
-            for (int i = 0; i < subquery_result->row_count; i++) {
-                Value* subquery_val = &subquery_result->rows[i].values[0];
-                if (value_compare(&left, subquery_val) == 0) {
-                    found = true;
-                    break;
-                }
-            }
-            
-            csv_free(subquery_result);
-            return is_not_in ? !found : found;
+            bool result = evaluate_in_subquery(ctx, right_node, &left, is_not_in, current_row, table_index);
+            value_free(&left);
+            return result;
         } else if (right_node->type == NODE_TYPE_LIST) {
             // list-based IN operator
             ASTNode* list = right_node;
@@ -148,6 +75,19 @@ bool evaluate_condition(QueryContext* ctx, ASTNode* condition, Row* current_row,
         return is_not_in; // empty list: NOT IN = true, IN = false
     }
     
+    // handle comparison operators
+    Value right = evaluate_expression(ctx, condition->condition.right, current_row, table_index);
+    
+    int cmp = value_compare(&left, &right);
+    
+    if (strcmp(op, "=") == 0) return cmp == 0;
+    if (strcmp(op, "!=") == 0) return cmp != 0;
+    if (strcmp(op, "<>") == 0) return cmp != 0;
+    if (strcmp(op, ">") == 0) return cmp > 0;
+    if (strcmp(op, "<") == 0) return cmp < 0;
+    if (strcmp(op, ">=") == 0) return cmp >= 0;
+    if (strcmp(op, "<=") == 0) return cmp <= 0;
+    
     // handle LIKE and ILIKE operators
     if (strcasecmp(op, "LIKE") == 0 || strcasecmp(op, "ILIKE") == 0) {
         bool case_sensitive = (strcasecmp(op, "LIKE") == 0);
@@ -157,7 +97,8 @@ bool evaluate_condition(QueryContext* ctx, ASTNode* condition, Row* current_row,
             return false;
         }
         
-        return match_pattern(left.string_value, right.string_value, case_sensitive);
+        return match_pattern(left.string_value, left.string_length,
+                             right.string_value, right.string_length, case_sensitive);
     }
     
     return false;
@@ -11,6 +11,7 @@
 #include "string_utils.h"
 #include "evaluator/evaluator_core.h"
 #include "evaluator/evaluator_expressions.h"
+#include "evaluator/evaluator_subquery.h"
 
 // forward declarations
 extern CsvConfig global_csv_config;
@@ -22,6 +23,9 @@ QueryContext* context_create(ASTNode* query_ast) {
     ctx->table_count = 0;
     ctx->outer_row = NULL;
     ctx->outer_table = NULL;
+    ctx->outer_refs = NULL;
+    ctx->subqueries = NULL;
+    context_new_scope(ctx);
     return ctx;
 }
 
@@ -34,6 +38,7 @@ void context_free(QueryContext* ctx) {
         csv_free(ctx->tables[i].table);
     }
     free(ctx->tables);
+    subquery_cache_free(ctx->subqueries);
     free(ctx);
 }
 
@@ -48,7 +53,9 @@ CsvTable* load_table_from_string(const char* filename) {
     
     char* clean_filename = cq_strndup(start, end - start);
     
+    // DML statements edit the loaded rows in place
     CsvConfig config = global_csv_config;
+    config.editable = true;
     CsvTable* table = csv_load(clean_filename, config);
     
     free(clean_filename);
@@ -66,102 +73,150 @@ TableRef* context_get_table(QueryContext* ctx, const char* alias) {
     return NULL;
 }
 
-/* function to resolve column by name */
-Value* resolve_column(QueryContext* ctx, const char* column_name, Row* current_row, int table_index) {
-    if (!ctx || !column_name || !current_row) return NULL;
+/* scope 0 is never handed out, it marks unbound identifiers */
+static unsigned int next_scope = 0;
+
+void context_new_scope(QueryContext* ctx) {
+    if (++next_scope == 0) next_scope = 1;
+    ctx->scope = next_scope;
+}
+
+/* helper: table of an alias given by its first alias_len characters */
+static TableRef* context_get_table_n(QueryContext* ctx, const char* alias, size_t alias_len) {
+    for (int i = 0; i < ctx->table_count; i++) {
+        const char* name = ctx->tables[i].alias;
+        if (strlen(name) == alias_len && strncasecmp(name, alias, alias_len) == 0) {
+            return &ctx->tables[i];
+        }
+    }
+    return NULL;
+}
+
+/* helper: column of the outer row of a correlated subquery, if there is one */
+static bool bind_outer(QueryContext* ctx, const char* col_name, ColumnBinding* binding) {
+    if (!ctx->outer_row || !ctx->outer_table) return false;
+    
+    int col_index = csv_get_column_index(ctx->outer_table, col_name);
+    if (col_index < 0) return false;
+    
+    binding->kind = BINDING_OUTER;
+    binding->index = col_index;
+    
+    // bindings are made before the first read of every scope, so this sees all the reads
+    if (ctx->outer_refs) outer_refs_add(ctx->outer_refs, col_index);
+    return true;
+}
+
+/* helper: find what a column name refers to when evaluated against a table of the context.
+ * none of it depends on the row, so the result holds for the whole scope */
+static void bind_column(QueryContext* ctx, const char* column_name, int table_index, ColumnBinding* binding) {
+    binding->scope = ctx->scope;
+    binding->table_index = table_index;
+    binding->kind = BINDING_NONE;
+    binding->index = -1;
     
-    if (table_index < 0 || table_index >= ctx->table_count) return NULL;
     CsvTable* table = ctx->tables[table_index].table;
     
+    // an exact match covers joined tables, whose columns carry the alias prefix
+    int col_index = csv_get_column_index(table, column_name);
+    if (col_index >= 0) {
+        binding->kind = BINDING_ROW;
+        binding->index = col_index;
+        return;
+    }
+    
     // check if it's a qualified name like table.column
     const char* dot = strchr(column_name, '.');
     
     if (dot) {
-        // if qualified try exact match first for joined tables
-        int col_index = csv_get_column_index(table, column_name);
-        if (col_index >= 0) {
-            return &current_row->values[col_index];
-        }
-        
-        // if not found, try traditional resolution for table alias lookup
-        size_t alias_len = dot - column_name;
-        char* table_alias = cq_strndup(column_name, alias_len);
         const char* col_name = dot + 1;
+        TableRef* table_ref = context_get_table_n(ctx, column_name, dot - column_name);
         
-        // find the table
-        TableRef* table_ref = context_get_table(ctx, table_alias);
-        free(table_alias);
-        
-        if (!table_ref) {
-            // if not found in current query check if it's referencing outer table in correlated subquery
-            if (ctx->outer_row && ctx->outer_table) {
-                col_index = csv_get_column_index(ctx->outer_table, col_name);
-                if (col_index >= 0) {
-                    return &ctx->outer_row->values[col_index];
-                }
+        if (table_ref) {
+            col_index = csv_get_column_index(table_ref->table, col_name);
+            if (col_index >= 0) {
+                binding->kind = BINDING_ROW;
+                binding->index = col_index;
+                return;
             }
-            return NULL;
         }
         
-        // get column index
-        col_index = csv_get_column_index(table_ref->table, col_name);
-        if (col_index < 0) {
-            // if not found in current query check outer context for correlated subquery
-            if (ctx->outer_row && ctx->outer_table) {
-                col_index = csv_get_column_index(ctx->outer_table, col_name);
-                if (col_index >= 0) {
-                    return &ctx->outer_row->values[col_index];
-                }
-            }
-            return NULL;
-        }
-        
-        return &current_row->values[col_index];
-    } else {
-        // if unqualified look in current table
-        int col_index = csv_get_column_index(table, column_name);
-        if (col_index < 0) {
-            // if not found in current query check outer context for correlated subquery
-            if (ctx->outer_row && ctx->outer_table) {
-                col_index = csv_get_column_index(ctx->outer_table, column_name);
-                if (col_index >= 0) {
-                    return &ctx->outer_row->values[col_index];
-                }
-            }
-            
-            // EXTENSION: if still not found, check if it's a SELECT alias (non-standard SQL)
-            // this allows WHERE to reference computed columns from SELECT
-            if (ctx->query && ctx->query->query.select) {
-                ASTNode* select_node = ctx->query->query.select;
-                if (select_node->type == NODE_TYPE_SELECT && select_node->select.column_nodes) {
-                    // look for alias in SELECT columns
-                    for (int i = 0; i < select_node->select.column_count; i++) {
-                        const char* col_str = select_node->select.columns[i];
-                        if (!col_str) continue;
-                        
-                        // check for " AS alias" pattern
-                        const char* as_pos = cq_strcasestr(col_str, " AS ");
-                        if (as_pos) {
-                            const char* alias_start = as_pos + 4;
-                            while (*alias_start && isspace(*alias_start)) alias_start++;
-                            
-                            // check if this alias matches column_name
-                            if (strcasecmp(alias_start, column_name) == 0) {
-                                // found the alias! evaluate the expression and store in context
-                                // we need to store this temporarily for WHERE evaluation
-                                static Value computed_value;
-                                computed_value = evaluate_expression(ctx, select_node->select.column_nodes[i], 
-                                                                    current_row, table_index);
-                                return &computed_value;
-                            }
-                        }
+        // if not found in current query check if it's referencing outer table in correlated subquery
+        bind_outer(ctx, col_name, binding);
+        return;
+    }
+    
+    // if not found in current query check outer context for correlated subquery
+    if (bind_outer(ctx, column_name, binding)) return;
+    
+    // EXTENSION: if still not found, check if it's a SELECT alias (non-standard SQL)
+    // this allows WHERE to reference computed columns from SELECT
+    if (ctx->query && ctx->query->query.select) {
+        ASTNode* select_node = ctx->query->query.select;
+        if (select_node->type == NODE_TYPE_SELECT && select_node->select.column_nodes) {
+            // look for alias in SELECT columns
+            for (int i = 0; i < select_node->select.column_count; i++) {
+                const char* col_str = select_node->select.columns[i];
+                if (!col_str) continue;
+                
+                // check for " AS alias" pattern
+                const char* as_pos = cq_strcasestr(col_str, " AS ");
+                if (as_pos) {
+                    const char* alias_start = as_pos + 4;
+                    while (*alias_start && isspace(*alias_start)) alias_start++;
+                    
+                    if (strcasecmp(alias_start, column_name) == 0) {
+                        binding->kind = BINDING_SELECT_ALIAS;
+                        binding->index = i;
+                        return;
                     }
                 }
             }
-            
-            return NULL;
         }
-        
-        return &current_row->values[col_index];
     }
 }
+
+/* helper: value a binding reads from the row */
+static const Value* bound_value(QueryContext* ctx, const ColumnBinding* binding, Row* current_row, int table_index) {
+    switch (binding->kind) {
+        case BINDING_ROW:
+            return row_value(current_row, binding->index);
+        case BINDING_OUTER:
+            return row_value(ctx->outer_row, binding->index);
+        case BINDING_SELECT_ALIAS: {
+            // evaluate the aliased expression, stored until the next alias is read
+            static Value computed_value;
+            computed_value = evaluate_expression(ctx, ctx->query->query.select->select.column_nodes[binding->index],
+                                                 current_row, table_index);
+            return &computed_value;
+        }
+        default:
+            return NULL;
+    }
+}
+
+/* function to resolve column by name */
+const Value* resolve_column(QueryContext* ctx, const char* column_name, Row* current_row, int table_index) {
+    if (!ctx || !column_name || !current_row) return NULL;
+    if (table_index < 0 || table_index >= ctx->table_count) return NULL;
+    
+    ColumnBinding binding;
+    bind_column(ctx, column_name, table_index, &binding);
+    return bound_value(ctx, &binding, current_row, table_index);
+}
+
+const ColumnBinding* bind_column_node(QueryContext* ctx, ASTNode* node, int table_index) {
+    // name lookups happen once per scope and table, every other row indexes the row directly
+    ColumnBinding* binding = &node->binding;
+    if (binding->scope != ctx->scope || binding->table_index != table_index || ctx->scope == 0) {
+        bind_column(ctx, node->identifier, table_index, binding);
+    }
+    return binding;
+}
+
+const Value* resolve_column_node(QueryContext* ctx, ASTNode* node, Row* current_row, int table_index) {
+    if (!ctx || !current_row) return NULL;
+    if (table_index < 0 || table_index >= ctx->table_count) return NULL;
+    
+    return bound_value(ctx, bind_column_node(ctx, node, table_index), current_row, table_index);
+}
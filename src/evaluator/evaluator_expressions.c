@@ -19,8 +19,131 @@
 #include "evaluator/evaluator_conditions.h"
 #include "evaluator/evaluator_utils.h"
 #include "evaluator/evaluator_internal.h"
+#include "evaluator/evaluator_program.h"
+#include "evaluator/evaluator_subquery.h"
+
+char arithmetic_operator(const char* op) {
+    if (!op || !op[0] || op[1]) return 0;
+    return strchr("+-*/%&|^", op[0]) ? op[0] : 0;
+}
+
+Value unary_value(const char* op, const Value* operand) {
+    Value result;
+    result.type = VALUE_TYPE_NULL;
+    
+    if (strcmp(op, "-") == 0) {
+        // unary minus
+        if (operand->type == VALUE_TYPE_INTEGER) {
+            result.type = VALUE_TYPE_INTEGER;
+            result.int_value = -operand->int_value;
+        } else if (operand->type == VALUE_TYPE_DOUBLE) {
+            result.type = VALUE_TYPE_DOUBLE;
+            result.double_value = -operand->double_value;
+        }
+    } else if (strcmp(op, "+") == 0) {
+        // unary plus (no-op)
+        return *operand;
+    }
+    return result;
+}
+
+Value arithmetic_value(char op, const Value* left, const Value* right) {
+    Value result;
+    result.type = VALUE_TYPE_NULL;
+    
+    // convert to numeric values
+    double left_val = 0, right_val = 0;
+    long long left_int = 0, right_int = 0;
+    bool left_is_int = false, right_is_int = false;
+    
+    if (left->type == VALUE_TYPE_INTEGER) {
+        left_val = (double)left->int_value;
+        left_int = left->int_value;
+        left_is_int = true;
+    } else if (left->type == VALUE_TYPE_DOUBLE) {
+        left_val = left->double_value;
+    } else {
+        return result;
+    }
+    
+    if (right->type == VALUE_TYPE_INTEGER) {
+        right_val = (double)right->int_value;
+        right_int = right->int_value;
+        right_is_int = true;
+    } else if (right->type == VALUE_TYPE_DOUBLE) {
+        right_val = right->double_value;
+    } else {
+        return result;
+    }
+    
+    // perform the operation
+    double result_val = 0;
+    long long result_int = 0;
+    bool result_is_int = false;
+    
+    switch (op) {
+        case '+':
+            result_val = left_val + right_val;
+            break;
+        case '-':
+            result_val = left_val - right_val;
+            break;
+        case '*':
+            result_val = left_val * right_val;
+            break;
+        case '/':
+            if (right_val == 0) return result;
+            result_val = left_val / right_val;
+            break;
+        case '%':
+            // % requires integers
+            if (left_is_int && right_is_int) {
+                if (right_int == 0) return result;
+                result_int = left_int % right_int;
+                result_is_int = true;
+            } else {
+                // doubles use fmod
+                if (right_val == 0) return result;
+                result_val = fmod(left_val, right_val);
+            }
+            break;
+        case '&':
+        case '|':
+        case '^':
+            // bitwise operators require integers
+            if (!left_is_int || !right_is_int) return result;
+            result_int = op == '&' ? (left_int & right_int) : op == '|' ? (left_int | right_int) : (left_int ^ right_int);
+            result_is_int = true;
+            break;
+        default:
+            break;
+    }
+    
+    // return result
+    if (result_is_int) {
+        result.type = VALUE_TYPE_INTEGER;
+        result.int_value = result_int;
+    } else if (left->type == VALUE_TYPE_INTEGER && right->type == VALUE_TYPE_INTEGER && 
+               result_val == (long long)result_val) {
+        result.type = VALUE_TYPE_INTEGER;
+        result.int_value = (long long)result_val;
+    } else {
+        result.type = VALUE_TYPE_DOUBLE;
+        result.double_value = result_val;
+    }
+    
+    return result;
+}
 
 Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index) {
+    // compound expressions run as bytecode compiled on first use
+    Value result;
+    if (program_evaluate(ctx, expr, current_row, table_index, &result)) return result;
+    
+    return evaluate_expression_tree(ctx, expr, current_row, table_index);
+}
+
+Value evaluate_expression_tree(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index) {
     Value result;
     result.type = VALUE_TYPE_NULL;
     
@@ -28,45 +151,22 @@ Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, in
     
     switch (expr->type) {
         case NODE_TYPE_LITERAL:
-            return parse_value(expr->literal, strlen(expr->literal));
+            // string literals borrow from the AST, which outlives every value of the query
+            return parse_value_borrowed(expr->literal, strlen(expr->literal));
             
         case NODE_TYPE_IDENTIFIER: {
             // resolve column value
-            Value* val = resolve_column(ctx, expr->identifier, current_row, table_index);
+            const Value* val = resolve_column_node(ctx, expr, current_row, table_index);
             if (val) {
-                // do a deep copy to avoid freeing shared string pointers
-                value_deep_copy(&result, val);
-                return result;
+                // borrow strings from the row instead of copying them, value_free leaves them alone
+                return value_borrow(val);
             }
             break;
         }
         
-        case NODE_TYPE_SUBQUERY: {
-            // evaluate scalar subquery, that may be correlated
-            // Note: This is for scalar contexts (SELECT, comparison ops)
-            // IN operator handles multi-row subqueries separately in evaluate_condition
-            if (!expr->subquery.query) break;
-            
-            // pass the outer context for correlated subqueries
-            ResultSet* subquery_result = evaluate_query_internal(expr->subquery.query, 
-                current_row, ctx->tables[table_index].table);
-            
-            if (!subquery_result) break;
-            
-            // validation only in scalar context (not for IN operator)
-            // IN operator is handled separately and allows multi-row results
-            if (subquery_result->row_count != 1 || subquery_result->column_count != 1) {
-                // only report error if it's truly being used as scalar
-                // don't report for IN operator which is handled elsewhere
-                csv_free(subquery_result);
-                break;
-            }
-            
-            // copy the single value from subquery result
-            value_deep_copy(&result, &subquery_result->rows[0].values[0]);
-            csv_free(subquery_result);
-            return result;
-        }
+        case NODE_TYPE_SUBQUERY:
+            // scalar subquery, that may be correlated. IN handles multi-row subqueries in evaluate_condition
+            return evaluate_scalar_subquery(ctx, expr, current_row, ctx->tables[table_index].table, false);
         
         case NODE_TYPE_FUNCTION: {
             // evaluate function call in WHERE clause
@@ -83,9 +183,7 @@ Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, in
             
             // free temporary string values allocated during argument evaluation
             for (int i = 0; i < func_arg_count; i++) {
-                if (func_args[i].type == VALUE_TYPE_STRING && func_args[i].string_value) {
-                    free((char*)func_args[i].string_value);
-                }
+                value_free(&func_args[i]);
             }
             
             return result;
@@ -106,26 +204,8 @@ Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, in
                     return result;
                 }
                 
-                const char* op = expr->binary_op.operator;
                 Value operand = evaluate_expression(ctx, expr->binary_op.right, current_row, table_index);
-                
-                if (strcmp(op, "-") == 0) {
-                    // unary minus
-                    if (operand.type == VALUE_TYPE_INTEGER) {
-                        result.type = VALUE_TYPE_INTEGER;
-                        result.int_value = -operand.int_value;
-                        return result;
-                    } else if (operand.type == VALUE_TYPE_DOUBLE) {
-                        result.type = VALUE_TYPE_DOUBLE;
-                        result.double_value = -operand.double_value;
-                        return result;
-                    }
-                } else if (strcmp(op, "+") == 0) {
-                    // unary plus (no-op)
-                    return operand;
-                }
-                result.type = VALUE_TYPE_NULL;
-                return result;
+                return unary_value(expr->binary_op.operator, &operand);
             }
             
             // evaluate binary arithmetic operation
@@ -133,133 +213,11 @@ Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, in
             
             // check for unary operator (right is NULL), shouldn't happen with current parser
             if (!expr->binary_op.right) {
-                const char* op = expr->binary_op.operator;
-                if (strcmp(op, "-") == 0) {
-                    // unary minus
-                    if (left.type == VALUE_TYPE_INTEGER) {
-                        result.type = VALUE_TYPE_INTEGER;
-                        result.int_value = -left.int_value;
-                        return result;
-                    } else if (left.type == VALUE_TYPE_DOUBLE) {
-                        result.type = VALUE_TYPE_DOUBLE;
-                        result.double_value = -left.double_value;
-                        return result;
-                    }
-                } else if (strcmp(op, "+") == 0) {
-                    // unary plus (no-op)
-                    return left;
-                }
-                result.type = VALUE_TYPE_NULL;
-                return result;
+                return unary_value(expr->binary_op.operator, &left);
             }
             
             Value right = evaluate_expression(ctx, expr->binary_op.right, current_row, table_index);
-            const char* op = expr->binary_op.operator;
-            
-            // convert to numeric values
-            double left_val = 0, right_val = 0;
-            long long left_int = 0, right_int = 0;
-            bool left_is_int = false, right_is_int = false;
-            
-            if (left.type == VALUE_TYPE_INTEGER) {
-                left_val = (double)left.int_value;
-                left_int = left.int_value;
-                left_is_int = true;
-            } else if (left.type == VALUE_TYPE_DOUBLE) {
-                left_val = left.double_value;
-            } else {
-                result.type = VALUE_TYPE_NULL;
-                return result;
-            }
-            
-            if (right.type == VALUE_TYPE_INTEGER) {
-                right_val = (double)right.int_value;
-                right_int = right.int_value;
-                right_is_int = true;
-            } else if (right.type == VALUE_TYPE_DOUBLE) {
-                right_val = right.double_value;
-            } else {
-                result.type = VALUE_TYPE_NULL;
-                return result;
-            }
-            
-            // perform the operation
-            double result_val = 0;
-            long long result_int = 0;
-            bool result_is_int = false;
-            
-            if (strcmp(op, "+") == 0) {
-                result_val = left_val + right_val;
-            } else if (strcmp(op, "-") == 0) {
-                result_val = left_val - right_val;
-            } else if (strcmp(op, "*") == 0) {
-                result_val = left_val * right_val;
-            } else if (strcmp(op, "/") == 0) {
-                if (right_val == 0) {
-                    result.type = VALUE_TYPE_NULL;
-                    return result;
-                }
-                result_val = left_val / right_val;
-            } else if (strcmp(op, "%") == 0) {
-                // % requires integers
-                if (left_is_int && right_is_int) {
-                    if (right_int == 0) {
-                        result.type = VALUE_TYPE_NULL;
-                        return result;
-                    }
-                    result_int = left_int % right_int;
-                    result_is_int = true;
-                } else {
-                    // doubles use fmod
-                    if (right_val == 0) {
-                        result.type = VALUE_TYPE_NULL;
-                        return result;
-                    }
-                    result_val = fmod(left_val, right_val);
-                }
-            } else if (strcmp(op, "&") == 0) {
-                // bitwise AND requires integers
-                if (left_is_int && right_is_int) {
-                    result_int = left_int & right_int;
-                    result_is_int = true;
-                } else {
-                    result.type = VALUE_TYPE_NULL;
-                    return result;
-                }
-            } else if (strcmp(op, "|") == 0) {
-                // bitwise OR requires integers
-                if (left_is_int && right_is_int) {
-                    result_int = left_int | right_int;
-                    result_is_int = true;
-                } else {
-                    result.type = VALUE_TYPE_NULL;
-                    return result;
-                }
-            } else if (strcmp(op, "^") == 0) {
-                // bitwise XOR requires integers
-                if (left_is_int && right_is_int) {
-                    result_int = left_int ^ right_int;
-                    result_is_int = true;
-                } else {
-                    result.type = VALUE_TYPE_NULL;
-                    return result;
-                }
-            }
-            
-            // return result
-            if (result_is_int) {
-                result.type = VALUE_TYPE_INTEGER;
-                result.int_value = result_int;
-            } else if (left.type == VALUE_TYPE_INTEGER && right.type == VALUE_TYPE_INTEGER && 
-                       result_val == (long long)result_val) {
-                result.type = VALUE_TYPE_INTEGER;
-                result.int_value = (long long)result_val;
-            } else {
-                result.type = VALUE_TYPE_DOUBLE;
-                result.double_value = result_val;
-            }
-            
-            return result;
+            return arithmetic_value(arithmetic_operator(expr->binary_op.operator), &left, &right);
         }
             
         case NODE_TYPE_CASE: {
@@ -288,9 +246,7 @@ Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, in
                     when_matches = (value_compare(&case_value, &when_value) == 0);
                     
                     // free string values if needed
-                    if (when_value.type == VALUE_TYPE_STRING && when_value.string_value) {
-                        free((char*)when_value.string_value);
-                    }
+                    value_free(&when_value);
                 } else {
                     // searched CASE: WHEN clause is a condition node (age > 30, etc.)
                     when_matches = evaluate_condition(ctx, expr->case_expr.when_exprs[i], current_row, table_index);
@@ -301,9 +257,7 @@ Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, in
                     result = evaluate_expression(ctx, expr->case_expr.then_exprs[i], current_row, table_index);
                     
                     // free case_value string if needed
-                    if (is_simple_case && case_value.type == VALUE_TYPE_STRING && case_value.string_value) {
-                        free((char*)case_value.string_value);
-                    }
+                    if (is_simple_case) value_free(&case_value);
                     return result;
                 }
             }
@@ -316,9 +270,7 @@ Value evaluate_expression(QueryContext* ctx, ASTNode* expr, Row* current_row, in
             }
             
             // free case_value string if needed
-            if (is_simple_case && case_value.type == VALUE_TYPE_STRING && case_value.string_value) {
-                free((char*)case_value.string_value);
-            }
+            if (is_simple_case) value_free(&case_value);
             return result;
         }
             
@@ -0,0 +1,333 @@
+/* evaluator_hash.c - typed value hashing shared by hash based operators */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "csv_reader.h"
+#include "evaluator/evaluator_hash.h"
+#include "evaluator/evaluator_utils.h"
+
+#define HASH_SEED_NULL   0x9e3779b97f4a7c15ULL
+#define HASH_SEED_DATE   0xc2b2ae3d27d4eb4fULL
+#define HASH_SEED_DOUBLE 0x165667b19e3779f9ULL
+#define HASH_SEED_STRING 0x27d4eb2f165667c5ULL
+
+/* finalizer from splitmix64, cheap and with good avalanche */
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/* hash a byte range a word at a time */
+static uint64_t hash_bytes(const char* data, size_t len, uint64_t seed) {
+    uint64_t h = seed ^ (len * 0xff51afd7ed558ccdULL);
+
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        h = (h ^ mix64(word)) * 0x9fb21c651e98df25ULL;
+        data += 8;
+        len -= 8;
+    }
+
+    if (len > 0) {
+        uint64_t word = 0;
+        memcpy(&word, data, len);
+        h = (h ^ mix64(word)) * 0x9fb21c651e98df25ULL;
+    }
+
+    return mix64(h);
+}
+
+uint64_t hash_combine(uint64_t seed, uint64_t hash) {
+    return mix64(seed ^ (hash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+uint64_t value_hash(const Value* value) {
+    if (!value) return HASH_SEED_NULL;
+
+    switch (value->type) {
+        case VALUE_TYPE_NULL:
+            return HASH_SEED_NULL;
+        case VALUE_TYPE_INTEGER:
+            return mix64((uint64_t)value->int_value);
+        case VALUE_TYPE_DOUBLE: {
+            double d = value->double_value;
+
+            // integral doubles must hash like integers, 2.0 = 2 in value_compare
+            if (d == floor(d) && fabs(d) < 9.2e18) {
+                return mix64((uint64_t)(long long)d);
+            }
+
+            if (isnan(d)) return HASH_SEED_DOUBLE;
+
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            return mix64(bits ^ HASH_SEED_DOUBLE);
+        }
+        case VALUE_TYPE_DATE: {
+            uint64_t packed = (uint64_t)value->date_value.year * 10000 +
+                              (uint64_t)value->date_value.month * 100 +
+                              (uint64_t)value->date_value.day;
+            return mix64(packed ^ HASH_SEED_DATE);
+        }
+        case VALUE_TYPE_STRING: {
+            if (!value->string_value) return hash_bytes("", 0, HASH_SEED_STRING);
+            return hash_bytes(value->string_value, value->string_length, HASH_SEED_STRING);
+        }
+    }
+
+    return HASH_SEED_NULL;
+}
+
+bool value_equal(const Value* a, const Value* b) {
+    if (!a || !b) return a == b;
+
+    if (a->type == VALUE_TYPE_NULL || b->type == VALUE_TYPE_NULL) {
+        return a->type == b->type;
+    }
+
+    bool a_numeric = (a->type == VALUE_TYPE_INTEGER || a->type == VALUE_TYPE_DOUBLE);
+    bool b_numeric = (b->type == VALUE_TYPE_INTEGER || b->type == VALUE_TYPE_DOUBLE);
+
+    if (a_numeric && b_numeric) {
+        if (a->type == VALUE_TYPE_INTEGER && b->type == VALUE_TYPE_INTEGER) {
+            return a->int_value == b->int_value;
+        }
+        double a_val = a->type == VALUE_TYPE_INTEGER ? (double)a->int_value : a->double_value;
+        double b_val = b->type == VALUE_TYPE_INTEGER ? (double)b->int_value : b->double_value;
+        return a_val == b_val;
+    }
+
+    if (a->type != b->type) return false;
+
+    if (a->type == VALUE_TYPE_DATE) {
+        return a->date_value.year == b->date_value.year &&
+               a->date_value.month == b->date_value.month &&
+               a->date_value.day == b->date_value.day;
+    }
+
+    // strings, a NULL pointer reads as the empty string
+    size_t len_a = a->string_value ? a->string_length : 0;
+    size_t len_b = b->string_value ? b->string_length : 0;
+    return len_a == len_b && (len_a == 0 || memcmp(a->string_value, b->string_value, len_a) == 0);
+}
+
+uint64_t value_tuple_hash(const Value* values, int count) {
+    uint64_t h = 0;
+    for (int i = 0; i < count; i++) {
+        h = hash_combine(h, value_hash(&values[i]));
+    }
+    return h;
+}
+
+bool value_tuple_equal(const Value* a, const Value* b, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!value_equal(&a[i], &b[i])) return false;
+    }
+    return true;
+}
+
+void value_hash_table_init(ValueHashTable* table, int key_count) {
+    table->slot_count = 16;
+    table->slots = malloc(sizeof(int) * table->slot_count);
+    for (int i = 0; i < table->slot_count; i++) table->slots[i] = -1;
+    
+    table->key_count = key_count;
+    table->entry_count = 0;
+    table->entry_capacity = 8;
+    table->hashes = malloc(sizeof(uint64_t) * table->entry_capacity);
+    table->keys = malloc(sizeof(Value) * table->entry_capacity * (key_count > 0 ? key_count : 1));
+}
+
+void value_hash_table_free(ValueHashTable* table) {
+    if (!table) return;
+    
+    for (size_t i = 0; i < (size_t)table->entry_count * table->key_count; i++) {
+        value_free(&table->keys[i]);
+    }
+    free(table->keys);
+    free(table->hashes);
+    free(table->slots);
+    table->keys = NULL;
+    table->hashes = NULL;
+    table->slots = NULL;
+    table->entry_count = 0;
+}
+
+/* linear probing, returns the slot holding the key or the empty slot where it belongs */
+static int probe_slot(const ValueHashTable* table, const Value* key, uint64_t h) {
+    int mask = table->slot_count - 1;
+    int slot = (int)(h & (uint64_t)mask);
+    
+    while (table->slots[slot] >= 0) {
+        int entry = table->slots[slot];
+        if (table->hashes[entry] == h &&
+            value_tuple_equal(value_hash_table_key(table, entry), key, table->key_count)) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    
+    return slot;
+}
+
+/* double the slot array once the load factor passes 1/2 */
+static void grow_slots(ValueHashTable* table) {
+    free(table->slots);
+    table->slot_count *= 2;
+    table->slots = malloc(sizeof(int) * table->slot_count);
+    for (int i = 0; i < table->slot_count; i++) table->slots[i] = -1;
+    
+    int mask = table->slot_count - 1;
+    for (int entry = 0; entry < table->entry_count; entry++) {
+        int slot = (int)(table->hashes[entry] & (uint64_t)mask);
+        while (table->slots[slot] >= 0) slot = (slot + 1) & mask;
+        table->slots[slot] = entry;
+    }
+}
+
+int value_hash_table_find(const ValueHashTable* table, const Value* key) {
+    uint64_t h = value_tuple_hash(key, table->key_count);
+    return table->slots[probe_slot(table, key, h)];
+}
+
+int value_hash_table_insert(ValueHashTable* table, const Value* key, bool* inserted) {
+    uint64_t h = value_tuple_hash(key, table->key_count);
+    int slot = probe_slot(table, key, h);
+    
+    if (table->slots[slot] >= 0) {
+        if (inserted) *inserted = false;
+        return table->slots[slot];
+    }
+    
+    if (table->entry_count >= table->entry_capacity) {
+        table->entry_capacity *= 2;
+        table->hashes = realloc(table->hashes, sizeof(uint64_t) * table->entry_capacity);
+        table->keys = realloc(table->keys, sizeof(Value) * table->entry_capacity *
+                                           (table->key_count > 0 ? table->key_count : 1));
+    }
+    
+    int entry = table->entry_count++;
+    table->hashes[entry] = h;
+    for (int k = 0; k < table->key_count; k++) {
+        value_deep_copy(&table->keys[(size_t)entry * table->key_count + k], &key[k]);
+    }
+    table->slots[slot] = entry;
+    
+    if (table->entry_count * 2 > table->slot_count) {
+        grow_slots(table);
+    }
+    
+    if (inserted) *inserted = true;
+    return entry;
+}
+
+/* ===== row sets ===== */
+
+static uint64_t row_hash(Row* row, int column_count) {
+    uint64_t h = 0;
+    for (int col = 0; col < column_count; col++) {
+        h = hash_combine(h, value_hash(row_value(row, col)));
+    }
+    return h;
+}
+
+static bool rows_equal(Row* a, Row* b, int column_count) {
+    for (int col = 0; col < column_count; col++) {
+        if (!value_equal(row_value(a, col), row_value(b, col))) return false;
+    }
+    return true;
+}
+
+void row_hash_set_init(RowHashSet* set, int column_count) {
+    set->slot_count = 16;
+    set->slots = malloc(sizeof(int) * set->slot_count);
+    for (int i = 0; i < set->slot_count; i++) set->slots[i] = -1;
+    
+    set->column_count = column_count;
+    set->entry_count = 0;
+    set->entry_capacity = 8;
+    set->hashes = malloc(sizeof(uint64_t) * set->entry_capacity);
+    set->rows = malloc(sizeof(Row*) * set->entry_capacity);
+}
+
+void row_hash_set_free(RowHashSet* set) {
+    if (!set) return;
+    
+    free(set->slots);
+    free(set->hashes);
+    free(set->rows);
+    set->slots = NULL;
+    set->hashes = NULL;
+    set->rows = NULL;
+    set->entry_count = 0;
+}
+
+/* linear probing, returns the slot holding a row equal to row or the empty slot where it belongs */
+static int probe_row_slot(const RowHashSet* set, Row* row, uint64_t h) {
+    int mask = set->slot_count - 1;
+    int slot = (int)(h & (uint64_t)mask);
+    
+    while (set->slots[slot] >= 0) {
+        int entry = set->slots[slot];
+        if (set->hashes[entry] == h && rows_equal(set->rows[entry], row, set->column_count)) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    
+    return slot;
+}
+
+/* double the slot array once the load factor passes 1/2 */
+static void grow_row_slots(RowHashSet* set) {
+    free(set->slots);
+    set->slot_count *= 2;
+    set->slots = malloc(sizeof(int) * set->slot_count);
+    for (int i = 0; i < set->slot_count; i++) set->slots[i] = -1;
+    
+    int mask = set->slot_count - 1;
+    for (int entry = 0; entry < set->entry_count; entry++) {
+        int slot = (int)(set->hashes[entry] & (uint64_t)mask);
+        while (set->slots[slot] >= 0) slot = (slot + 1) & mask;
+        set->slots[slot] = entry;
+    }
+}
+
+int row_hash_set_find(const RowHashSet* set, Row* row) {
+    return set->slots[probe_row_slot(set, row, row_hash(row, set->column_count))];
+}
+
+int row_hash_set_insert(RowHashSet* set, Row* row, bool* inserted) {
+    uint64_t h = row_hash(row, set->column_count);
+    int slot = probe_row_slot(set, row, h);
+    
+    if (set->slots[slot] >= 0) {
+        if (inserted) *inserted = false;
+        return set->slots[slot];
+    }
+    
+    if (set->entry_count >= set->entry_capacity) {
+        set->entry_capacity *= 2;
+        set->hashes = realloc(set->hashes, sizeof(uint64_t) * set->entry_capacity);
+        set->rows = realloc(set->rows, sizeof(Row*) * set->entry_capacity);
+    }
+    
+    int entry = set->entry_count++;
+    set->hashes[entry] = h;
+    set->rows[entry] = row;
+    set->slots[slot] = entry;
+    
+    if (set->entry_count * 2 > set->slot_count) {
+        grow_row_slots(set);
+    }
+    
+    if (inserted) *inserted = true;
+    return entry;
+}
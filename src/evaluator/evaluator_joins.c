@@ -10,29 +10,67 @@
 #include "evaluator/evaluator_conditions.h"
 #include "evaluator/evaluator_utils.h"
 #include "evaluator/evaluator_internal.h"
+#include "evaluator/evaluator_hash.h"
+#include "evaluator/evaluator_projection.h"
+#include "evaluator/evaluator_pushdown.h"
 
-/* helper to set values to NULL */
-static void set_null_values(Value* values, int start, int count) {
-    for (int i = start; i < start + count; i++) {
-        values[i].type = VALUE_TYPE_NULL;
+/* join output as (left row, right row) index pairs, -1 stands for the NULL padded side */
+typedef struct {
+    int* left;
+    int* right;
+    int count;
+    int capacity;
+} JoinPairs;
+
+static void join_pairs_add(JoinPairs* pairs, int left_idx, int right_idx) {
+    if (pairs->count >= pairs->capacity) {
+        pairs->capacity = pairs->capacity == 0 ? 64 : pairs->capacity * 2;
+        pairs->left = realloc(pairs->left, sizeof(int) * pairs->capacity);
+        pairs->right = realloc(pairs->right, sizeof(int) * pairs->capacity);
     }
+    pairs->left[pairs->count] = left_idx;
+    pairs->right[pairs->count] = right_idx;
+    pairs->count++;
 }
 
-/* helper to create a joined row with allocated values */
-static Row* create_joined_row(CsvTable* result, int column_count) {
-    Row* new_row = &result->rows[result->row_count++];
-    new_row->column_count = column_count;
-    new_row->values = malloc(sizeof(Value) * column_count);
-    return new_row;
+/* source column of the joined schema, side 0 is the left table and side 1 the right one */
+typedef struct {
+    int side;
+    int index;
+} JoinColumn;
+
+/* helper to add a table column to the result with alias prefix */
+static void add_column_with_prefix(CsvTable* result, CsvTable* table, int col_idx, const char* alias) {
+    char prefixed_name[256];
+    snprintf(prefixed_name, sizeof(prefixed_name), "%s.%s", alias, table->columns[col_idx].name);
+    result->columns[result->column_count].name = strdup(prefixed_name);
+    result->columns[result->column_count].inferred_type = table->columns[col_idx].inferred_type;
+    result->column_count++;
 }
 
-/* helper to copy table columns to result with alias prefix */
-static void copy_columns_with_prefix(Column* dest, int dest_offset, CsvTable* table, const char* alias) {
-    for (int i = 0; i < table->column_count; i++) {
-        char prefixed_name[256];
-        snprintf(prefixed_name, sizeof(prefixed_name), "%s.%s", alias, table->columns[i].name);
-        dest[dest_offset + i].name = strdup(prefixed_name);
-        dest[dest_offset + i].inferred_type = table->columns[i].inferred_type;
+/* copy only the projected columns of every pair into the result rows */
+static void materialize_join_pairs(CsvTable* result, JoinColumn* sources, JoinPairs* pairs,
+                                   CsvTable* left_table, CsvTable* right_table) {
+    result->row_capacity = pairs->count > 0 ? pairs->count : 1;
+    result->rows = calloc(result->row_capacity, sizeof(Row));
+    result->row_count = pairs->count;
+    
+    for (int p = 0; p < pairs->count; p++) {
+        Row* new_row = &result->rows[p];
+        Row* left_row = pairs->left[p] >= 0 ? &left_table->rows[pairs->left[p]] : NULL;
+        Row* right_row = pairs->right[p] >= 0 ? &right_table->rows[pairs->right[p]] : NULL;
+        
+        new_row->column_count = result->column_count;
+        new_row->values = csv_alloc_values(result, result->column_count);
+        
+        for (int c = 0; c < result->column_count; c++) {
+            Row* src = sources[c].side == 0 ? left_row : right_row;
+            if (src) {
+                csv_copy_value(result, &new_row->values[c], row_value(src, sources[c].index));
+            } else {
+                new_row->values[c].type = VALUE_TYPE_NULL;
+            }
+        }
     }
 }
 
@@ -46,10 +84,8 @@ static bool evaluate_join_condition(QueryContext* ctx, ASTNode* on_condition,
         on_condition->condition.left->type == NODE_TYPE_IDENTIFIER &&
         on_condition->condition.right->type == NODE_TYPE_IDENTIFIER) {
         
-        Value* left_val = resolve_column(ctx, on_condition->condition.left->identifier,
-                                         left_row, 0);
-        Value* right_val = resolve_column(ctx, on_condition->condition.right->identifier,
-                                          right_row, 1);
+        const Value* left_val = resolve_column_node(ctx, on_condition->condition.left, left_row, 0);
+        const Value* right_val = resolve_column_node(ctx, on_condition->condition.right, right_row, 1);
         
         if (left_val && right_val) {
             return (value_compare(left_val, right_val) == 0);
@@ -59,115 +95,235 @@ static bool evaluate_join_condition(QueryContext* ctx, ASTNode* on_condition,
     return false;
 }
 
-/* simple JOIN implementation that creates a temporary joined table */
-static CsvTable* perform_join(QueryContext* ctx, CsvTable* left_table, const char* left_alias,
-                               CsvTable* right_table, const char* right_alias,
-                               ASTNode* on_condition, JoinType join_type) {
-    // create result table with combined columns
-    CsvTable* result = calloc(1, sizeof(CsvTable));
-    result->filename = strdup("joined_result");
-    result->has_header = true;
-    result->delimiter = ',';
+/* equi-join keys extracted from an ON condition, column indices per side */
+typedef struct {
+    int* left_cols;
+    int* right_cols;
+    int key_count;
+    int key_capacity;
+} JoinKeys;
+
+/* resolve a column name against one side of the join, -1 if it doesn't belong to it */
+static int resolve_join_side_column(const char* name, CsvTable* table, const char* alias) {
+    // exact match covers already joined tables whose columns carry the alias prefix
+    int col_idx = csv_get_column_index(table, name);
+    if (col_idx >= 0) return col_idx;
     
-    // combine column names with table prefixes
-    result->column_count = left_table->column_count + right_table->column_count;
-    result->columns = malloc(sizeof(Column) * result->column_count);
+    const char* dot = strchr(name, '.');
+    if (!dot) return -1;
     
-    copy_columns_with_prefix(result->columns, 0, left_table, left_alias);
-    copy_columns_with_prefix(result->columns, left_table->column_count, right_table, right_alias);
+    size_t alias_len = dot - name;
+    if (!alias || strlen(alias) != alias_len || strncasecmp(name, alias, alias_len) != 0) {
+        return -1;
+    }
     
-    // allocate rows
-    result->row_capacity = left_table->row_count * right_table->row_count;
-    result->rows = malloc(sizeof(Row) * result->row_capacity);
-    result->row_count = 0;
+    return csv_get_column_index(table, dot + 1);
+}
+
+/* collect a conjunction of `a.col = b.col` equalities, false if the condition has any other shape */
+static bool collect_join_keys(ASTNode* condition, CsvTable* left_table, const char* left_alias,
+                              CsvTable* right_table, const char* right_alias, JoinKeys* keys) {
+    if (!condition || condition->type != NODE_TYPE_CONDITION) return false;
     
-    // extend querycontext to include both tables temporarily for condition evaluation
-    int orig_table_count = ctx->table_count;
-    TableRef* orig_tables = ctx->tables;
+    const char* op = condition->condition.operator;
     
-    ctx->table_count = 2;
-    ctx->tables = malloc(sizeof(TableRef) * 2);
-    ctx->tables[0].alias = strdup(left_alias);
-    ctx->tables[0].table = left_table;
-    ctx->tables[1].alias = strdup(right_alias);
-    ctx->tables[1].table = right_table;
+    if (strcasecmp(op, "AND") == 0) {
+        return collect_join_keys(condition->condition.left, left_table, left_alias, right_table, right_alias, keys) &&
+               collect_join_keys(condition->condition.right, left_table, left_alias, right_table, right_alias, keys);
+    }
+    
+    if (strcmp(op, "=") != 0) return false;
+    
+    ASTNode* a = condition->condition.left;
+    ASTNode* b = condition->condition.right;
+    if (!a || !b || a->type != NODE_TYPE_IDENTIFIER || b->type != NODE_TYPE_IDENTIFIER) return false;
+    
+    // the equality may be written in either order
+    int left_col = resolve_join_side_column(a->identifier, left_table, left_alias);
+    int right_col = resolve_join_side_column(b->identifier, right_table, right_alias);
+    if (left_col < 0 || right_col < 0) {
+        left_col = resolve_join_side_column(b->identifier, left_table, left_alias);
+        right_col = resolve_join_side_column(a->identifier, right_table, right_alias);
+    }
+    if (left_col < 0 || right_col < 0) return false;
+    
+    if (keys->key_count >= keys->key_capacity) {
+        keys->key_capacity = keys->key_capacity == 0 ? 4 : keys->key_capacity * 2;
+        keys->left_cols = realloc(keys->left_cols, sizeof(int) * keys->key_capacity);
+        keys->right_cols = realloc(keys->right_cols, sizeof(int) * keys->key_capacity);
+    }
+    keys->left_cols[keys->key_count] = left_col;
+    keys->right_cols[keys->key_count] = right_col;
+    keys->key_count++;
+    
+    return true;
+}
+
+/* hash the key columns of a row, returns false if any key is NULL (never matches) */
+static bool hash_join_key(Row* row, const int* cols, int key_count, uint64_t* out_hash) {
+    uint64_t h = 0;
+    for (int k = 0; k < key_count; k++) {
+        const Value* val = row_value(row, cols[k]);
+        if (val->type == VALUE_TYPE_NULL) return false;
+        h = hash_combine(h, value_hash(val));
+    }
+    *out_hash = h;
+    return true;
+}
+
+static bool join_keys_equal(Row* left_row, Row* right_row, JoinKeys* keys) {
+    for (int k = 0; k < keys->key_count; k++) {
+        if (!value_equal(row_value(left_row, keys->left_cols[k]), row_value(right_row, keys->right_cols[k]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#define BITMAP_SET(bits, i) ((bits)[(i) >> 3] |= (unsigned char)(1u << ((i) & 7)))
+#define BITMAP_TEST(bits, i) (((bits)[(i) >> 3] >> ((i) & 7)) & 1u)
+
+/* build/probe hash join: build on the right table, probe with left rows in order */
+static void hash_join_rows(JoinPairs* pairs, CsvTable* left_table, CsvTable* right_table,
+                           JoinKeys* keys, JoinType join_type, unsigned char* right_matched) {
+    int right_count = right_table->row_count;
+    
+    // power of two bucket count, at least twice the build side
+    int bucket_count = 16;
+    while (bucket_count < right_count * 2) bucket_count <<= 1;
+    
+    int* buckets = malloc(sizeof(int) * bucket_count);
+    int* next = malloc(sizeof(int) * (right_count > 0 ? right_count : 1));
+    uint64_t* hashes = malloc(sizeof(uint64_t) * (right_count > 0 ? right_count : 1));
+    for (int i = 0; i < bucket_count; i++) buckets[i] = -1;
+    
+    // insert in reverse so every chain lists right rows in file order
+    for (int r = right_count - 1; r >= 0; r--) {
+        uint64_t h;
+        if (!hash_join_key(&right_table->rows[r], keys->right_cols, keys->key_count, &h)) {
+            continue;
+        }
+        hashes[r] = h;
+        int b = (int)(h & (uint64_t)(bucket_count - 1));
+        next[r] = buckets[b];
+        buckets[b] = r;
+    }
+    
+    for (int l = 0; l < left_table->row_count; l++) {
+        Row* left_row = &left_table->rows[l];
+        bool found_match = false;
+        uint64_t h;
+        
+        if (hash_join_key(left_row, keys->left_cols, keys->key_count, &h)) {
+            for (int r = buckets[h & (uint64_t)(bucket_count - 1)]; r >= 0; r = next[r]) {
+                if (hashes[r] != h || !join_keys_equal(left_row, &right_table->rows[r], keys)) {
+                    continue;
+                }
+                found_match = true;
+                if (right_matched) BITMAP_SET(right_matched, r);
+                join_pairs_add(pairs, l, r);
+            }
+        }
+        
+        if (!found_match && (join_type == JOIN_TYPE_LEFT || join_type == JOIN_TYPE_FULL)) {
+            join_pairs_add(pairs, l, -1);
+        }
+    }
     
-    // perform join
+    free(buckets);
+    free(next);
+    free(hashes);
+}
+
+/* nested loop join for ON conditions that are not plain equalities */
+static void nested_loop_join_rows(QueryContext* ctx, JoinPairs* pairs, CsvTable* left_table,
+                                  CsvTable* right_table, ASTNode* on_condition, JoinType join_type,
+                                  unsigned char* right_matched) {
     for (int l = 0; l < left_table->row_count; l++) {
         bool found_match = false;
         
         for (int r = 0; r < right_table->row_count; r++) {
-            // create temporary combined row for condition evaluation
-            // for condition evaluation we need to check if rows match
-            
             bool matches = evaluate_join_condition(ctx, on_condition,
                                                     &left_table->rows[l], &right_table->rows[r]);
             
             if (matches || (join_type == JOIN_TYPE_INNER && on_condition == NULL)) {
                 found_match = true;
-                
-                // create combined row
-                Row* new_row = create_joined_row(result, result->column_count);
-                
-                // copy left table values
-                for (int i = 0; i < left_table->column_count; i++) {
-                    value_deep_copy(&new_row->values[i], &left_table->rows[l].values[i]);
-                }
-                
-                // copy right table values
-                for (int i = 0; i < right_table->column_count; i++) {
-                    value_deep_copy(&new_row->values[left_table->column_count + i], &right_table->rows[r].values[i]);
-                }
-                
-                if (result->row_count == 1) {
-                    // debug
-                }
+                if (right_matched) BITMAP_SET(right_matched, r);
+                join_pairs_add(pairs, l, r);
             }
         }
         
         // left/full join if no match found add left row with nulls for right
         if (!found_match && (join_type == JOIN_TYPE_LEFT || join_type == JOIN_TYPE_FULL)) {
-            Row* new_row = create_joined_row(result, result->column_count);
-            
-            // copy left table values
-            for (int i = 0; i < left_table->column_count; i++) {
-                value_deep_copy(&new_row->values[i], &left_table->rows[l].values[i]);
-            }
-            
-            // null values for right table
-            set_null_values(new_row->values, left_table->column_count, right_table->column_count);
+            join_pairs_add(pairs, l, -1);
         }
     }
+}
+
+/* JOIN implementation that creates a temporary joined table, uses a hash join for equi-joins.
+ * the join itself only records matching row index pairs, values are copied afterwards and only
+ * for the columns in refs so memory scales with output size and projected width */
+static CsvTable* perform_join(QueryContext* ctx, CsvTable* left_table, const char* left_alias,
+                               CsvTable* right_table, const char* right_alias,
+                               ASTNode* on_condition, JoinType join_type, const ColumnRefs* refs) {
+    // create result table with the referenced columns of both sides
+    CsvTable* result = calloc(1, sizeof(CsvTable));
+    result->arena = arena_create();
+    result->filename = strdup("joined_result");
+    result->has_header = true;
+    result->delimiter = ',';
     
-    // right/full join: add unmatched rows from right table with nulls for left
+    int max_columns = left_table->column_count + right_table->column_count;
+    result->columns = malloc(sizeof(Column) * (max_columns > 0 ? max_columns : 1));
+    JoinColumn* sources = malloc(sizeof(JoinColumn) * (max_columns > 0 ? max_columns : 1));
+    
+    for (int i = 0; i < left_table->column_count; i++) {
+        if (!column_refs_match(refs, left_table->columns[i].name)) continue;
+        sources[result->column_count] = (JoinColumn){0, i};
+        add_column_with_prefix(result, left_table, i, left_alias);
+    }
+    for (int i = 0; i < right_table->column_count; i++) {
+        if (!column_refs_match(refs, right_table->columns[i].name)) continue;
+        sources[result->column_count] = (JoinColumn){1, i};
+        add_column_with_prefix(result, right_table, i, right_alias);
+    }
+    
+    // extend querycontext to include both tables temporarily for condition evaluation
+    int orig_table_count = ctx->table_count;
+    TableRef* orig_tables = ctx->tables;
+    
+    ctx->table_count = 2;
+    ctx->tables = malloc(sizeof(TableRef) * 2);
+    ctx->tables[0].alias = strdup(left_alias);
+    ctx->tables[0].table = left_table;
+    ctx->tables[1].alias = strdup(right_alias);
+    ctx->tables[1].table = right_table;
+    context_new_scope(ctx);
+    
+    // right/full joins track which right rows found a partner instead of rescanning left
+    unsigned char* right_matched = NULL;
     if (join_type == JOIN_TYPE_RIGHT || join_type == JOIN_TYPE_FULL) {
+        right_matched = calloc((right_table->row_count + 7) / 8 + 1, 1);
+    }
+    
+    JoinPairs pairs = {0};
+    JoinKeys keys = {0};
+    if (on_condition && collect_join_keys(on_condition, left_table, left_alias, right_table, right_alias, &keys)) {
+        hash_join_rows(&pairs, left_table, right_table, &keys, join_type, right_matched);
+    } else {
+        nested_loop_join_rows(ctx, &pairs, left_table, right_table, on_condition, join_type, right_matched);
+    }
+    free(keys.left_cols);
+    free(keys.right_cols);
+    
+    // right/full join: add unmatched rows from right table with nulls for left
+    if (right_matched) {
         for (int r = 0; r < right_table->row_count; r++) {
-            bool found_match = false;
-            
-            // check if this right row matched any left row
-            for (int l = 0; l < left_table->row_count; l++) {
-                bool matches = evaluate_join_condition(ctx, on_condition,
-                                                        &left_table->rows[l], &right_table->rows[r]);
-                
-                if (matches) {
-                    found_match = true;
-                    break;
-                }
-            }
-            
-            // if no match add right row with nulls for left
-            if (!found_match) {
-                Row* new_row = create_joined_row(result, result->column_count);
-                
-                // null values for left table
-                set_null_values(new_row->values, 0, left_table->column_count);
-                
-                // copy right table values
-                for (int i = 0; i < right_table->column_count; i++) {
-                    value_deep_copy(&new_row->values[left_table->column_count + i], &right_table->rows[r].values[i]);
-                }
+            if (!BITMAP_TEST(right_matched, r)) {
+                join_pairs_add(&pairs, -1, r);
             }
         }
+        free(right_matched);
     }
     
     // restore original context
@@ -176,14 +332,40 @@ static CsvTable* perform_join(QueryContext* ctx, CsvTable* left_table, const cha
     free(ctx->tables);
     ctx->tables = orig_tables;
     ctx->table_count = orig_table_count;
+    context_new_scope(ctx);
+    
+    materialize_join_pairs(result, sources, &pairs, left_table, right_table);
+    
+    free(pairs.left);
+    free(pairs.right);
+    free(sources);
     
     return result;
 }
 
+/* tables read by a query are loaded lazily, only the fields the query touches get parsed,
+ * columns it never names are left as NULL and rows failing a pushed down filter are skipped */
+CsvConfig query_load_config(const ColumnRefs* refs, const PushdownFilters* filters) {
+    CsvConfig config = global_csv_config;
+    config.lazy = true;
+    if (refs && !refs->all_columns) {
+        config.projection = refs->names;
+        config.projection_count = refs->count;
+    }
+    if (filters) {
+        config.filters = filters->filters;
+        config.filter_count = filters->count;
+    }
+    return config;
+}
+
+static CsvTable* load_query_table(const char* filename, const ColumnRefs* refs,
+                                  const PushdownFilters* filters) {
+    return csv_load(filename, query_load_config(refs, filters));
+}
+
 /* load table from FROM clause */
 CsvTable* load_from_table(ASTNode* from_clause, const char** out_alias, QueryContext* ctx) {
-    (void)ctx; // unused parameter kept for future extensions
-    
     if (!from_clause || from_clause->type != NODE_TYPE_FROM) {
         fprintf(stderr, "Error: FROM clause is required\n");
         return NULL;
@@ -216,14 +398,25 @@ CsvTable* load_from_table(ASTNode* from_clause, const char** out_alias, QueryCon
         table_alias = from_clause->from.alias ? from_clause->from.alias : "subquery";
     } else if (from_clause->from.table) {
         const char* filename = from_clause->from.table;
-        source_table = csv_load(filename, global_csv_config);
+        table_alias = from_clause->from.alias ? from_clause->from.alias : "main";
+        
+        ColumnRefs refs = {0};
+        PushdownFilters filters = {0};
+        column_refs_collect(&refs, ctx ? ctx->query : NULL);
+        
+        // WHERE applies to the joined rows, it can only be pushed into a lone table
+        if (ctx && ctx->query && ctx->query->query.join_count == 0) {
+            pushdown_collect(&filters, ctx->query->query.where, table_alias);
+        }
+        
+        source_table = load_query_table(filename, ctx ? &refs : NULL, &filters);
+        column_refs_free(&refs);
+        pushdown_free(&filters);
         
         if (!source_table) {
             fprintf(stderr, "Failed to load table from '%s'\n", filename);
             return NULL;
         }
-        
-        table_alias = from_clause->from.alias ? from_clause->from.alias : "main";
     } else {
         fprintf(stderr, "Error: FROM clause must specify a table or subquery\n");
         return NULL;
@@ -243,11 +436,15 @@ CsvTable* process_joins(ASTNode* query_ast, QueryContext* ctx, CsvTable* base_ta
     const char* working_alias = base_alias;
     bool joined = false;
     
+    // columns the query needs from the joined table, everything else is never copied
+    ColumnRefs refs = {0};
+    column_refs_collect(&refs, query_ast);
+    
     for (int j = 0; j < query_ast->query.join_count; j++) {
         ASTNode* join_node = query_ast->query.joins[j];
         if (join_node->type != NODE_TYPE_JOIN) continue;
         
-        CsvTable* right_table = csv_load(join_node->join.table, global_csv_config);
+        CsvTable* right_table = load_query_table(join_node->join.table, &refs, NULL);
         if (!right_table) {
             fprintf(stderr, "Failed to load join table from '%s'\n", join_node->join.table);
             continue;
@@ -258,7 +455,7 @@ CsvTable* process_joins(ASTNode* query_ast, QueryContext* ctx, CsvTable* base_ta
         CsvTable* joined_table = perform_join(ctx, working_table, working_alias,
                                                right_table, right_alias,
                                                join_node->join.condition,
-                                               join_node->join.join_type);
+                                               join_node->join.join_type, &refs);
         
         if (joined) {
             csv_free(working_table);
@@ -270,5 +467,7 @@ CsvTable* process_joins(ASTNode* query_ast, QueryContext* ctx, CsvTable* base_ta
         joined = true;
     }
     
+    column_refs_free(&refs);
+    
     return joined ? working_table : base_table;
 }
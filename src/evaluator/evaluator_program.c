@@ -0,0 +1,675 @@
+/* evaluator_program.c - expressions and conditions compiled to register bytecode */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "evaluator.h"
+#include "parser.h"
+#include "csv_reader.h"
+#include "like.h"
+#include "evaluator/evaluator_program.h"
+#include "evaluator/evaluator_core.h"
+#include "evaluator/evaluator_expressions.h"
+#include "evaluator/evaluator_conditions.h"
+#include "evaluator/evaluator_functions.h"
+
+/* evaluate_expression passes functions at most this many arguments */
+#define PROGRAM_MAX_ARGS 10
+
+typedef enum {
+    OP_COLUMN,       // r[dst] = value of the identifier nodes[a]
+    OP_EXPRESSION,   // r[dst] = nodes[a] evaluated by walking the tree
+    OP_CONDITION,    // r[dst] = condition nodes[a] evaluated by walking the tree
+    OP_NEGATE,       // r[dst] = -r[a]
+    OP_ARITHMETIC,   // r[dst] = r[a] <mode> r[b], mode is the operator character
+    OP_CALL,         // r[dst] = function aux of the b registers listed at operands[a]
+    OP_COMPARE,      // r[dst] = r[a] <mode> r[b], mode is a CompareMode
+    OP_IN,           // r[dst] = r[a] equal to one of the b registers listed at operands[aux], negated if mode is set
+    OP_LIKE,         // r[dst] = r[a] LIKE r[b], ignoring case if mode is set
+    OP_MATCH,        // r[dst] = r[a] matching the compiled pattern likes[aux]
+    OP_NOT,          // r[dst] = !r[a]
+    OP_MOVE,         // r[dst] = r[a]
+    OP_TAKE,         // r[dst] = r[a] leaving r[a] NULL, moves a value the program owns
+    OP_JUMP,         // continue at aux
+    OP_JUMP_FALSE,   // continue at aux if r[a] is false
+    OP_JUMP_TRUE,    // continue at aux if r[a] is true
+} Opcode;
+
+typedef enum {
+    CMP_EQ,
+    CMP_NE,
+    CMP_LT,
+    CMP_GT,
+    CMP_LE,
+    CMP_GE,
+} CompareMode;
+
+typedef struct {
+    unsigned char op;
+    unsigned char mode;
+    int dst;
+    int a;
+    int b;
+    int aux;
+} Instruction;
+
+struct Program {
+    Instruction* code;
+    int length;
+    int capacity;
+    
+    Value* registers;      // constants keep the value they were compiled with, booleans are 0/1 integers
+    bool* owned;           // registers that may hold a string the program has to free
+    bool* constant;        // registers no instruction writes, their value is known at compile time
+    int register_count;
+    int register_capacity;
+    
+    int* operands;         // register lists of calls and IN lists
+    int operand_count;
+    int operand_capacity;
+    
+    ASTNode** nodes;       // identifiers and the nodes left to the tree walkers
+    int node_count;
+    int node_capacity;
+    
+    int* cleanup;          // owned registers other than the result, freed after every run
+    int cleanup_count;
+    
+    char** folded;         // strings made while folding constants, freed with the program
+    int folded_count;
+    int folded_capacity;
+    
+    LikePattern** likes;   // LIKE patterns known at compile time
+    int like_count;
+    int like_capacity;
+    
+    int result;
+    bool running;          // a nested evaluation of the same node walks the tree instead
+};
+
+/* helper: grow an array to hold one more element */
+static void* grow(void* array, int count, int* capacity, size_t size) {
+    if (count < *capacity) return array;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    return realloc(array, size * (size_t)*capacity);
+}
+
+static int new_register(Program* program, bool owned) {
+    if (program->register_count == program->register_capacity) {
+        program->register_capacity = program->register_capacity ? program->register_capacity * 2 : 16;
+        program->registers = realloc(program->registers, sizeof(Value) * program->register_capacity);
+        program->owned = realloc(program->owned, sizeof(bool) * program->register_capacity);
+        program->constant = realloc(program->constant, sizeof(bool) * program->register_capacity);
+    }
+    
+    int reg = program->register_count++;
+    memset(&program->registers[reg], 0, sizeof(Value));
+    program->registers[reg].type = VALUE_TYPE_NULL;
+    program->owned[reg] = owned;
+    program->constant[reg] = false;
+    return reg;
+}
+
+static int constant_register(Program* program, Value value) {
+    int reg = new_register(program, false);
+    program->registers[reg] = value;
+    program->constant[reg] = true;
+    return reg;
+}
+
+static int null_register(Program* program) {
+    Value value = {0};
+    value.type = VALUE_TYPE_NULL;
+    return constant_register(program, value);
+}
+
+static int boolean_register(Program* program, bool value) {
+    Value constant = {0};
+    constant.type = VALUE_TYPE_INTEGER;
+    constant.int_value = value;
+    return constant_register(program, constant);
+}
+
+/* helper: register of a value computed at compile time. a string it owns stays with the
+ * program and every run lends it out */
+static int folded_register(Program* program, Value value) {
+    if (value.type == VALUE_TYPE_STRING && !value.borrowed && value.string_value) {
+        program->folded = grow(program->folded, program->folded_count, &program->folded_capacity, sizeof(char*));
+        program->folded[program->folded_count++] = value.string_value;
+        value.borrowed = true;
+    }
+    return constant_register(program, value);
+}
+
+static inline bool is_constant(const Program* program, int reg) {
+    return program->constant[reg];
+}
+
+/* helper: a constant register holding a boolean, or -1 */
+static int constant_truth(const Program* program, int reg) {
+    if (!is_constant(program, reg)) return -1;
+    return program->registers[reg].int_value != 0;
+}
+
+/* helper: append an instruction, returns its position for patching jumps */
+static int emit(Program* program, Opcode op, int mode, int dst, int a, int b, int aux) {
+    program->code = grow(program->code, program->length, &program->capacity, sizeof(Instruction));
+    program->code[program->length] = (Instruction){(unsigned char)op, (unsigned char)mode, dst, a, b, aux};
+    return program->length++;
+}
+
+static void emit_move(Program* program, int dst, int src) {
+    emit(program, program->owned[src] ? OP_TAKE : OP_MOVE, 0, dst, src, 0, 0);
+}
+
+static int add_node(Program* program, ASTNode* node) {
+    program->nodes = grow(program->nodes, program->node_count, &program->node_capacity, sizeof(ASTNode*));
+    program->nodes[program->node_count] = node;
+    return program->node_count++;
+}
+
+static int add_operands(Program* program, const int* regs, int count) {
+    int offset = program->operand_count;
+    for (int i = 0; i < count; i++) {
+        program->operands = grow(program->operands, program->operand_count, &program->operand_capacity, sizeof(int));
+        program->operands[program->operand_count++] = regs[i];
+    }
+    return offset;
+}
+
+static int add_like(Program* program, LikePattern* like) {
+    program->likes = grow(program->likes, program->like_count, &program->like_capacity, sizeof(LikePattern*));
+    program->likes[program->like_count] = like;
+    return program->like_count++;
+}
+
+static int compile_expression(Program* program, ASTNode* expr);
+static int compile_condition(Program* program, ASTNode* condition);
+
+/* helper: operators with a single operand have it on either side */
+static int compile_arithmetic(Program* program, ASTNode* expr) {
+    ASTNode* left = expr->binary_op.left;
+    ASTNode* right = expr->binary_op.right;
+    const char* op = expr->binary_op.operator;
+    
+    if (!left || !right) {
+        ASTNode* operand = left ? left : right;
+        if (!operand) return null_register(program);
+        
+        // unary plus is the operand itself
+        if (strcmp(op, "+") == 0) return compile_expression(program, operand);
+        if (strcmp(op, "-") != 0) return null_register(program);
+        
+        int src = compile_expression(program, operand);
+        if (is_constant(program, src)) {
+            return folded_register(program, unary_value(op, &program->registers[src]));
+        }
+        
+        int dst = new_register(program, false);
+        emit(program, OP_NEGATE, 0, dst, src, 0, 0);
+        return dst;
+    }
+    
+    int a = compile_expression(program, left);
+    int b = compile_expression(program, right);
+    if (is_constant(program, a) && is_constant(program, b)) {
+        return folded_register(program, arithmetic_value(arithmetic_operator(op), &program->registers[a],
+                                                         &program->registers[b]));
+    }
+    
+    int dst = new_register(program, false);
+    emit(program, OP_ARITHMETIC, arithmetic_operator(op), dst, a, b, 0);
+    return dst;
+}
+
+static int compile_call(Program* program, ASTNode* expr) {
+    ScalarFunction function = scalar_function_lookup(expr->function.name);
+    if (function == SCALAR_UNKNOWN) return null_register(program);
+    
+    int args[PROGRAM_MAX_ARGS];
+    int count = expr->function.arg_count < PROGRAM_MAX_ARGS ? expr->function.arg_count : PROGRAM_MAX_ARGS;
+    bool constant_args = true;
+    for (int i = 0; i < count; i++) {
+        args[i] = compile_expression(program, expr->function.args[i]);
+        constant_args = constant_args && is_constant(program, args[i]);
+    }
+    
+    // CURRENT_DATE is the only function whose value is not decided by its arguments
+    if (constant_args && function != SCALAR_CURRENT_DATE) {
+        Value values[PROGRAM_MAX_ARGS];
+        for (int i = 0; i < count; i++) {
+            values[i] = program->registers[args[i]];
+        }
+        return folded_register(program, evaluate_scalar_function_id(function, values, count));
+    }
+    
+    int dst = new_register(program, true);
+    emit(program, OP_CALL, 0, dst, add_operands(program, args, count), count, function);
+    return dst;
+}
+
+/* helper: every WHEN jumps over the rest once it matches. a WHEN that never matches is
+ * dropped and one that always matches ends the CASE, so a CASE deciding at compile time
+ * leaves no code behind */
+static int compile_case(Program* program, ASTNode* expr) {
+    if (!expr->case_expr.when_exprs || !expr->case_expr.then_exprs) return null_register(program);
+    
+    int when_count = expr->case_expr.when_count;
+    int* exits = malloc(sizeof(int) * (when_count > 0 ? when_count : 1));
+    int exit_count = 0;
+    
+    // simple CASE compares its value with each WHEN value, searched CASE checks conditions
+    int case_value = expr->case_expr.case_expr ? compile_expression(program, expr->case_expr.case_expr) : -1;
+    int dst = -1;
+    int result = -1;
+    
+    for (int i = 0; i < when_count; i++) {
+        int matched;
+        if (case_value >= 0) {
+            int when_value = compile_expression(program, expr->case_expr.when_exprs[i]);
+            if (is_constant(program, case_value) && is_constant(program, when_value)) {
+                matched = boolean_register(program, value_compare(&program->registers[case_value],
+                                                                  &program->registers[when_value]) == 0);
+            } else {
+                matched = new_register(program, false);
+                emit(program, OP_COMPARE, CMP_EQ, matched, case_value, when_value, 0);
+            }
+        } else {
+            matched = compile_condition(program, expr->case_expr.when_exprs[i]);
+        }
+        
+        int truth = constant_truth(program, matched);
+        if (truth == 0) continue;
+        if (truth == 1) {
+            result = compile_expression(program, expr->case_expr.then_exprs[i]);
+            break;
+        }
+        
+        if (dst < 0) dst = new_register(program, true);
+        int skip = emit(program, OP_JUMP_FALSE, 0, 0, matched, 0, 0);
+        emit_move(program, dst, compile_expression(program, expr->case_expr.then_exprs[i]));
+        exits[exit_count++] = emit(program, OP_JUMP, 0, 0, 0, 0, 0);
+        program->code[skip].aux = program->length;
+    }
+    
+    if (result < 0) {
+        result = expr->case_expr.else_expr ? compile_expression(program, expr->case_expr.else_expr)
+                                           : null_register(program);
+    }
+    
+    // nothing was left to decide at run time, the CASE is its only remaining branch
+    if (exit_count == 0) {
+        free(exits);
+        return result;
+    }
+    
+    emit_move(program, dst, result);
+    for (int i = 0; i < exit_count; i++) {
+        program->code[exits[i]].aux = program->length;
+    }
+    free(exits);
+    return dst;
+}
+
+/* lower an expression, returns the register holding its value */
+static int compile_expression(Program* program, ASTNode* expr) {
+    if (!expr) return null_register(program);
+    
+    switch (expr->type) {
+        case NODE_TYPE_LITERAL:
+            // string literals borrow from the AST, which outlives the program
+            return constant_register(program, parse_value_borrowed(expr->literal, strlen(expr->literal)));
+        
+        case NODE_TYPE_IDENTIFIER: {
+            int dst = new_register(program, false);
+            emit(program, OP_COLUMN, 0, dst, add_node(program, expr), 0, 0);
+            return dst;
+        }
+        
+        case NODE_TYPE_BINARY_OP:
+            return compile_arithmetic(program, expr);
+        
+        case NODE_TYPE_FUNCTION:
+            return compile_call(program, expr);
+        
+        case NODE_TYPE_CASE:
+            return compile_case(program, expr);
+        
+        case NODE_TYPE_CONDITION:
+            // a condition has no value outside WHERE
+            return null_register(program);
+        
+        default: {
+            // subqueries and window functions are left to the tree walker
+            int dst = new_register(program, true);
+            emit(program, OP_EXPRESSION, 0, dst, add_node(program, expr), 0, 0);
+            return dst;
+        }
+    }
+}
+
+static int compare_mode(const char* op) {
+    if (strcmp(op, "=") == 0) return CMP_EQ;
+    if (strcmp(op, "!=") == 0 || strcmp(op, "<>") == 0) return CMP_NE;
+    if (strcmp(op, "<") == 0) return CMP_LT;
+    if (strcmp(op, ">") == 0) return CMP_GT;
+    if (strcmp(op, "<=") == 0) return CMP_LE;
+    if (strcmp(op, ">=") == 0) return CMP_GE;
+    return -1;
+}
+
+static inline bool like_holds(const Value* str, const Value* pattern, bool ignore_case) {
+    return str->type == VALUE_TYPE_STRING && pattern->type == VALUE_TYPE_STRING &&
+           match_pattern(str->string_value, str->string_length, pattern->string_value,
+                         pattern->string_length, !ignore_case);
+}
+
+static inline bool compare_holds(CompareMode mode, int cmp) {
+    switch (mode) {
+        case CMP_EQ: return cmp == 0;
+        case CMP_NE: return cmp != 0;
+        case CMP_LT: return cmp < 0;
+        case CMP_GT: return cmp > 0;
+        case CMP_LE: return cmp <= 0;
+        default: return cmp >= 0;
+    }
+}
+
+/* lower a condition, returns the register holding its boolean */
+static int compile_condition(Program* program, ASTNode* condition) {
+    if (!condition) return boolean_register(program, true);
+    if (condition->type != NODE_TYPE_CONDITION) return boolean_register(program, false);
+    
+    const char* op = condition->condition.operator;
+    ASTNode* left = condition->condition.left;
+    ASTNode* right = condition->condition.right;
+    
+    if (strcasecmp(op, "NOT") == 0) {
+        int src = compile_condition(program, left);
+        int truth = constant_truth(program, src);
+        if (truth >= 0) return boolean_register(program, !truth);
+        
+        int dst = new_register(program, false);
+        emit(program, OP_NOT, 0, dst, src, 0, 0);
+        return dst;
+    }
+    
+    // AND and OR skip their right side once the left side decides
+    bool is_and = strcasecmp(op, "AND") == 0;
+    if (is_and || strcasecmp(op, "OR") == 0) {
+        // a constant left side either decides or leaves the right side alone
+        int first = compile_condition(program, left);
+        int truth = constant_truth(program, first);
+        if (truth >= 0) {
+            return truth == is_and ? compile_condition(program, right) : boolean_register(program, truth);
+        }
+        
+        int dst = new_register(program, false);
+        emit_move(program, dst, first);
+        int skip = emit(program, is_and ? OP_JUMP_FALSE : OP_JUMP_TRUE, 0, 0, dst, 0, 0);
+        emit_move(program, dst, compile_condition(program, right));
+        program->code[skip].aux = program->length;
+        return dst;
+    }
+    
+    int mode = compare_mode(op);
+    if (mode >= 0) {
+        int a = compile_expression(program, left);
+        int b = compile_expression(program, right);
+        if (is_constant(program, a) && is_constant(program, b)) {
+            int cmp = value_compare(&program->registers[a], &program->registers[b]);
+            return boolean_register(program, compare_holds((CompareMode)mode, cmp));
+        }
+        
+        int dst = new_register(program, false);
+        emit(program, OP_COMPARE, mode, dst, a, b, 0);
+        return dst;
+    }
+    
+    bool is_not_in = strcasecmp(op, "NOT IN") == 0;
+    if (is_not_in || strcasecmp(op, "IN") == 0) {
+        int dst = new_register(program, false);
+        
+        if (!right || right->type != NODE_TYPE_LIST) {
+            // subqueries are left to the tree walker
+            emit(program, OP_CONDITION, 0, dst, add_node(program, condition), 0, 0);
+            return dst;
+        }
+        
+        int a = compile_expression(program, left);
+        int count = right->list.node_count;
+        int* items = malloc(sizeof(int) * (count > 0 ? count : 1));
+        bool constant_list = is_constant(program, a);
+        for (int i = 0; i < count; i++) {
+            items[i] = compile_expression(program, right->list.nodes[i]);
+            constant_list = constant_list && is_constant(program, items[i]);
+        }
+        
+        if (constant_list) {
+            bool found = false;
+            for (int i = 0; i < count && !found; i++) {
+                found = value_compare(&program->registers[a], &program->registers[items[i]]) == 0;
+            }
+            free(items);
+            return boolean_register(program, is_not_in ? !found : found);
+        }
+        emit(program, OP_IN, is_not_in, dst, a, count, add_operands(program, items, count));
+        free(items);
+        return dst;
+    }
+    
+    bool is_ilike = strcasecmp(op, "ILIKE") == 0;
+    if (is_ilike || strcasecmp(op, "LIKE") == 0) {
+        int a = compile_expression(program, left);
+        int b = compile_expression(program, right);
+        if (is_constant(program, a) && is_constant(program, b)) {
+            return boolean_register(program, like_holds(&program->registers[a], &program->registers[b], is_ilike));
+        }
+        
+        // a literal pattern is prepared once instead of being read again for every row
+        const Value* pattern = &program->registers[b];
+        if (is_constant(program, b)) {
+            if (pattern->type != VALUE_TYPE_STRING || !pattern->string_value) return boolean_register(program, false);
+            
+            int dst = new_register(program, false);
+            LikePattern* like = like_compile(pattern->string_value, pattern->string_length, !is_ilike);
+            emit(program, OP_MATCH, 0, dst, a, 0, add_like(program, like));
+            return dst;
+        }
+        
+        int dst = new_register(program, false);
+        emit(program, OP_LIKE, is_ilike, dst, a, b, 0);
+        return dst;
+    }
+    
+    return boolean_register(program, false);
+}
+
+static Program* program_compile(ASTNode* node, bool condition) {
+    Program* program = calloc(1, sizeof(Program));
+    program->result = condition ? compile_condition(program, node) : compile_expression(program, node);
+    
+    program->cleanup = malloc(sizeof(int) * (program->register_count > 0 ? program->register_count : 1));
+    for (int reg = 0; reg < program->register_count; reg++) {
+        if (program->owned[reg] && reg != program->result) {
+            program->cleanup[program->cleanup_count++] = reg;
+        }
+    }
+    return program;
+}
+
+void program_free(Program* program) {
+    if (!program) return;
+    
+    free(program->code);
+    free(program->registers);
+    free(program->owned);
+    free(program->operands);
+    free(program->nodes);
+    free(program->cleanup);
+    for (int i = 0; i < program->folded_count; i++) {
+        free(program->folded[i]);
+    }
+    free(program->folded);
+    for (int i = 0; i < program->like_count; i++) {
+        like_free(program->likes[i]);
+    }
+    free(program->likes);
+    free(program->constant);
+    free(program);
+}
+
+static inline void set_boolean(Value* dst, bool value) {
+    dst->type = VALUE_TYPE_INTEGER;
+    dst->int_value = value;
+}
+
+/* helper: identifier value, reading the row directly while its binding holds */
+static inline const Value* column_value(QueryContext* ctx, ASTNode* node, Row* row, int table_index) {
+    const ColumnBinding* binding = &node->binding;
+    if (row && binding->kind == BINDING_ROW && binding->scope != 0 && binding->scope == ctx->scope &&
+        binding->table_index == table_index) {
+        return row_value(row, binding->index);
+    }
+    return resolve_column_node(ctx, node, row, table_index);
+}
+
+static void program_run(Program* program, QueryContext* ctx, Row* row, int table_index) {
+    Value* r = program->registers;
+    const Instruction* code = program->code;
+    
+    for (int pc = 0; pc < program->length; pc++) {
+        const Instruction* in = &code[pc];
+        Value* dst = &r[in->dst];
+        
+        switch ((Opcode)in->op) {
+            case OP_COLUMN: {
+                const Value* value = column_value(ctx, program->nodes[in->a], row, table_index);
+                if (value) {
+                    *dst = value_borrow(value);
+                } else {
+                    dst->type = VALUE_TYPE_NULL;
+                }
+                break;
+            }
+            case OP_EXPRESSION:
+                *dst = evaluate_expression_tree(ctx, program->nodes[in->a], row, table_index);
+                break;
+            case OP_CONDITION:
+                set_boolean(dst, evaluate_condition_tree(ctx, program->nodes[in->a], row, table_index));
+                break;
+            case OP_NEGATE: {
+                const Value* operand = &r[in->a];
+                if (operand->type == VALUE_TYPE_INTEGER) {
+                    dst->type = VALUE_TYPE_INTEGER;
+                    dst->int_value = -operand->int_value;
+                } else if (operand->type == VALUE_TYPE_DOUBLE) {
+                    dst->type = VALUE_TYPE_DOUBLE;
+                    dst->double_value = -operand->double_value;
+                } else {
+                    dst->type = VALUE_TYPE_NULL;
+                }
+                break;
+            }
+            case OP_ARITHMETIC:
+                *dst = arithmetic_value((char)in->mode, &r[in->a], &r[in->b]);
+                break;
+            case OP_CALL: {
+                Value args[PROGRAM_MAX_ARGS];
+                for (int i = 0; i < in->b; i++) {
+                    args[i] = r[program->operands[in->a + i]];
+                }
+                *dst = evaluate_scalar_function_id((ScalarFunction)in->aux, args, in->b);
+                break;
+            }
+            case OP_COMPARE: {
+                set_boolean(dst, compare_holds((CompareMode)in->mode, value_compare(&r[in->a], &r[in->b])));
+                break;
+            }
+            case OP_IN: {
+                bool found = false;
+                const int* items = &program->operands[in->aux];
+                for (int i = 0; i < in->b && !found; i++) {
+                    found = value_compare(&r[in->a], &r[items[i]]) == 0;
+                }
+                set_boolean(dst, in->mode ? !found : found);
+                break;
+            }
+            case OP_LIKE:
+                set_boolean(dst, like_holds(&r[in->a], &r[in->b], in->mode));
+                break;
+            case OP_MATCH:
+                set_boolean(dst, r[in->a].type == VALUE_TYPE_STRING &&
+                                 like_match(program->likes[in->aux], r[in->a].string_value, r[in->a].string_length));
+                break;
+            case OP_NOT:
+                set_boolean(dst, !r[in->a].int_value);
+                break;
+            case OP_MOVE:
+                *dst = r[in->a];
+                break;
+            case OP_TAKE:
+                *dst = r[in->a];
+                r[in->a].type = VALUE_TYPE_NULL;
+                break;
+            case OP_JUMP:
+                pc = in->aux - 1;
+                break;
+            case OP_JUMP_FALSE:
+                if (!r[in->a].int_value) pc = in->aux - 1;
+                break;
+            case OP_JUMP_TRUE:
+                if (r[in->a].int_value) pc = in->aux - 1;
+                break;
+        }
+    }
+    
+    // strings made by this run are freed, the result is handed to the caller
+    for (int i = 0; i < program->cleanup_count; i++) {
+        Value* value = &r[program->cleanup[i]];
+        value_free(value);
+        value->type = VALUE_TYPE_NULL;
+    }
+}
+
+/* helper: program of a node, compiling it on first use. NULL while it is running */
+static Program* node_program(ASTNode* node, bool condition) {
+    if (!node->program) node->program = program_compile(node, condition);
+    return node->program->running ? NULL : node->program;
+}
+
+bool program_evaluate(QueryContext* ctx, ASTNode* expr, Row* current_row, int table_index, Value* result) {
+    if (!expr || !ctx) return false;
+    if (expr->type != NODE_TYPE_BINARY_OP && expr->type != NODE_TYPE_FUNCTION && expr->type != NODE_TYPE_CASE &&
+        expr->type != NODE_TYPE_LITERAL) {
+        return false;
+    }
+    
+    Program* program = node_program(expr, false);
+    if (!program) return false;
+    
+    program->running = true;
+    program_run(program, ctx, current_row, table_index);
+    program->running = false;
+    
+    *result = program->registers[program->result];
+    if (program->owned[program->result]) {
+        program->registers[program->result].type = VALUE_TYPE_NULL;
+    }
+    return true;
+}
+
+bool program_check(QueryContext* ctx, ASTNode* condition, Row* current_row, int table_index, bool* result) {
+    if (!condition || !ctx || condition->type != NODE_TYPE_CONDITION) return false;
+    
+    Program* program = node_program(condition, true);
+    if (!program) return false;
+    
+    program->running = true;
+    program_run(program, ctx, current_row, table_index);
+    program->running = false;
+    
+    *result = program->registers[program->result].int_value != 0;
+    return true;
+}
@@ -0,0 +1,186 @@
+/* evaluator_projection.c - find which columns a query actually references */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include "parser.h"
+#include "string_utils.h"
+#include "evaluator/evaluator_projection.h"
+
+/* helper to get the unqualified part of a column name */
+static const char* unqualified_name(const char* name) {
+    const char* dot = strrchr(name, '.');
+    return dot ? dot + 1 : name;
+}
+
+static void column_refs_add(ColumnRefs* refs, const char* name, size_t len) {
+    if (len == 0) return;
+    
+    for (int i = 0; i < refs->count; i++) {
+        if (strlen(refs->names[i]) == len && strncasecmp(refs->names[i], name, len) == 0) {
+            return;
+        }
+    }
+    
+    if (refs->count >= refs->capacity) {
+        refs->capacity = refs->capacity == 0 ? 16 : refs->capacity * 2;
+        refs->names = realloc(refs->names, sizeof(char*) * refs->capacity);
+    }
+    refs->names[refs->count++] = cq_strndup(name, len);
+}
+
+/* collect identifier-like words from a string based column spec such as "AVG(t.height)" */
+static void column_refs_add_words(ColumnRefs* refs, const char* spec) {
+    if (!spec) return;
+    
+    const char* p = spec;
+    while (*p) {
+        // skip quoted literals
+        if (*p == '\'' || *p == '"') {
+            char quote = *p++;
+            while (*p && *p != quote) p++;
+            if (*p) p++;
+            continue;
+        }
+        
+        if (isalpha((unsigned char)*p) || *p == '_' || *p == '$') {
+            const char* start = p;
+            while (*p && (isalnum((unsigned char)*p) || *p == '_' || *p == '$' || *p == '.')) p++;
+            
+            size_t len = p - start;
+            while (len > 0 && start[len - 1] == '.') len--;
+            
+            // keep only the column part of qualified names
+            const char* word = start;
+            for (size_t i = 0; i < len; i++) {
+                if (start[i] == '.') word = start + i + 1;
+            }
+            column_refs_add(refs, word, len - (word - start));
+            continue;
+        }
+        
+        p++;
+    }
+}
+
+void column_refs_collect(ColumnRefs* refs, ASTNode* node) {
+    if (!refs || !node) return;
+    
+    switch (node->type) {
+        case NODE_TYPE_QUERY:
+            column_refs_collect(refs, node->query.select);
+            column_refs_collect(refs, node->query.from);
+            for (int i = 0; i < node->query.join_count; i++) {
+                column_refs_collect(refs, node->query.joins[i]);
+            }
+            column_refs_collect(refs, node->query.where);
+            column_refs_collect(refs, node->query.group_by);
+            column_refs_collect(refs, node->query.having);
+            column_refs_collect(refs, node->query.order_by);
+            break;
+        case NODE_TYPE_SELECT:
+            for (int i = 0; i < node->select.column_count; i++) {
+                ASTNode* col_node = node->select.column_nodes ? node->select.column_nodes[i] : NULL;
+                if (col_node) {
+                    column_refs_collect(refs, col_node);
+                } else if (strcmp(node->select.columns[i], "*") == 0) {
+                    refs->all_columns = true;
+                } else {
+                    column_refs_add_words(refs, node->select.columns[i]);
+                }
+            }
+            break;
+        case NODE_TYPE_FROM:
+            column_refs_collect(refs, node->from.subquery);
+            break;
+        case NODE_TYPE_JOIN:
+            column_refs_collect(refs, node->join.condition);
+            break;
+        case NODE_TYPE_GROUP_BY:
+            for (int i = 0; i < node->group_by.column_count; i++) {
+                column_refs_add_words(refs, node->group_by.columns[i]);
+            }
+            break;
+        case NODE_TYPE_ORDER_BY:
+            for (int i = 0; i < node->order_by.column_count; i++) {
+                column_refs_add_words(refs, node->order_by.columns[i]);
+            }
+            break;
+        case NODE_TYPE_CONDITION:
+            column_refs_collect(refs, node->condition.left);
+            column_refs_collect(refs, node->condition.right);
+            break;
+        case NODE_TYPE_BINARY_OP:
+            column_refs_collect(refs, node->binary_op.left);
+            column_refs_collect(refs, node->binary_op.right);
+            break;
+        case NODE_TYPE_FUNCTION:
+            for (int i = 0; i < node->function.arg_count; i++) {
+                column_refs_collect(refs, node->function.args[i]);
+            }
+            break;
+        case NODE_TYPE_WINDOW_FUNCTION:
+            for (int i = 0; i < node->window_function.arg_count; i++) {
+                column_refs_collect(refs, node->window_function.args[i]);
+            }
+            for (int i = 0; i < node->window_function.partition_count; i++) {
+                column_refs_add_words(refs, node->window_function.partition_by[i]);
+            }
+            column_refs_add_words(refs, node->window_function.order_by_column);
+            break;
+        case NODE_TYPE_LIST:
+            for (int i = 0; i < node->list.node_count; i++) {
+                column_refs_collect(refs, node->list.nodes[i]);
+            }
+            break;
+        case NODE_TYPE_CASE:
+            column_refs_collect(refs, node->case_expr.case_expr);
+            for (int i = 0; i < node->case_expr.when_count; i++) {
+                column_refs_collect(refs, node->case_expr.when_exprs[i]);
+                column_refs_collect(refs, node->case_expr.then_exprs[i]);
+            }
+            column_refs_collect(refs, node->case_expr.else_expr);
+            break;
+        case NODE_TYPE_SUBQUERY:
+            column_refs_collect(refs, node->subquery.query);
+            break;
+        case NODE_TYPE_SET_OP:
+            column_refs_collect(refs, node->set_op.left);
+            column_refs_collect(refs, node->set_op.right);
+            break;
+        case NODE_TYPE_IDENTIFIER: {
+            const char* name = unqualified_name(node->identifier);
+            column_refs_add(refs, name, strlen(name));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void column_refs_free(ColumnRefs* refs) {
+    if (!refs) return;
+    
+    for (int i = 0; i < refs->count; i++) {
+        free(refs->names[i]);
+    }
+    free(refs->names);
+    refs->names = NULL;
+    refs->count = 0;
+    refs->capacity = 0;
+}
+
+bool column_refs_match(const ColumnRefs* refs, const char* column_name) {
+    if (!refs || refs->all_columns) return true;
+    if (!column_name) return false;
+    
+    const char* name = unqualified_name(column_name);
+    for (int i = 0; i < refs->count; i++) {
+        if (strcasecmp(refs->names[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
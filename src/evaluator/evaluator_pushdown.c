@@ -0,0 +1,149 @@
+/* evaluator_pushdown.c - WHERE conjuncts checked by the loader before a row is stored */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "parser.h"
+#include "csv_reader.h"
+#include "evaluator/evaluator_pushdown.h"
+
+/* helper to get the column of an identifier, NULL if it is qualified with another table */
+static const char* filter_column(ASTNode* node, const char* table_alias) {
+    if (!node || node->type != NODE_TYPE_IDENTIFIER) return NULL;
+    
+    const char* name = node->identifier;
+    const char* dot = strchr(name, '.');
+    if (!dot) return name;
+    
+    size_t alias_len = dot - name;
+    if (!table_alias || strlen(table_alias) != alias_len ||
+        strncasecmp(name, table_alias, alias_len) != 0) {
+        return NULL;
+    }
+    return dot + 1;
+}
+
+/* literals are parsed the same way evaluate_expression does */
+static Value literal_value(ASTNode* node) {
+    return parse_value(node->literal, strlen(node->literal));
+}
+
+static void add_filter(PushdownFilters* filters, const char* column, RowFilterOp op,
+                       Value* values, int value_count) {
+    if (filters->count >= filters->capacity) {
+        filters->capacity = filters->capacity == 0 ? 4 : filters->capacity * 2;
+        filters->filters = realloc(filters->filters, sizeof(RowFilter) * filters->capacity);
+    }
+    
+    RowFilter* filter = &filters->filters[filters->count++];
+    filter->column = column;
+    filter->column_index = -1;
+    filter->op = op;
+    filter->values = values;
+    filter->value_count = value_count;
+    filter->like = NULL;
+}
+
+/* helper to map a comparison operator, mirrored when the literal is on the left */
+static bool comparison_op(const char* op, bool mirrored, RowFilterOp* out) {
+    if (strcmp(op, "=") == 0) *out = ROW_FILTER_EQ;
+    else if (strcmp(op, "!=") == 0 || strcmp(op, "<>") == 0) *out = ROW_FILTER_NE;
+    else if (strcmp(op, "<") == 0) *out = mirrored ? ROW_FILTER_GT : ROW_FILTER_LT;
+    else if (strcmp(op, "<=") == 0) *out = mirrored ? ROW_FILTER_GE : ROW_FILTER_LE;
+    else if (strcmp(op, ">") == 0) *out = mirrored ? ROW_FILTER_LT : ROW_FILTER_GT;
+    else if (strcmp(op, ">=") == 0) *out = mirrored ? ROW_FILTER_LE : ROW_FILTER_GE;
+    else return false;
+    return true;
+}
+
+static void collect_in_list(PushdownFilters* filters, const char* column, ASTNode* list) {
+    if (list->type != NODE_TYPE_LIST) return;
+    
+    int count = list->list.node_count;
+    if (count <= 0) return;
+    
+    for (int i = 0; i < count; i++) {
+        if (!list->list.nodes[i] || list->list.nodes[i]->type != NODE_TYPE_LITERAL) return;
+    }
+    
+    Value* values = malloc(sizeof(Value) * (size_t)count);
+    for (int i = 0; i < count; i++) {
+        values[i] = literal_value(list->list.nodes[i]);
+    }
+    add_filter(filters, column, ROW_FILTER_IN, values, count);
+}
+
+/* a literal pattern is matched by the loader with the same matcher the WHERE clause uses */
+static void collect_like(PushdownFilters* filters, const char* column, ASTNode* pattern_node, bool case_sensitive) {
+    if (pattern_node->type != NODE_TYPE_LITERAL) return;
+    
+    Value pattern = literal_value(pattern_node);
+    if (pattern.type != VALUE_TYPE_STRING) {
+        value_free(&pattern);
+        return;
+    }
+    
+    Value* values = malloc(sizeof(Value));
+    values[0] = pattern;
+    add_filter(filters, column, case_sensitive ? ROW_FILTER_LIKE : ROW_FILTER_ILIKE, values, 1);
+}
+
+void pushdown_collect(PushdownFilters* filters, ASTNode* where, const char* table_alias) {
+    if (!filters || !where || where->type != NODE_TYPE_CONDITION) return;
+    
+    const char* op = where->condition.operator;
+    ASTNode* left = where->condition.left;
+    ASTNode* right = where->condition.right;
+    
+    if (strcasecmp(op, "AND") == 0) {
+        pushdown_collect(filters, left, table_alias);
+        pushdown_collect(filters, right, table_alias);
+        return;
+    }
+    
+    if (!left || !right) return;
+    
+    const char* column = filter_column(left, table_alias);
+    
+    if (strcasecmp(op, "IN") == 0) {
+        if (column) collect_in_list(filters, column, right);
+        return;
+    }
+    
+    if (strcasecmp(op, "LIKE") == 0 || strcasecmp(op, "ILIKE") == 0) {
+        if (column) collect_like(filters, column, right, strcasecmp(op, "LIKE") == 0);
+        return;
+    }
+    
+    // column <op> literal, or literal <op> column
+    RowFilterOp filter_op;
+    if (column && right->type == NODE_TYPE_LITERAL && comparison_op(op, false, &filter_op)) {
+        Value* values = malloc(sizeof(Value));
+        values[0] = literal_value(right);
+        add_filter(filters, column, filter_op, values, 1);
+        return;
+    }
+    
+    column = filter_column(right, table_alias);
+    if (column && left->type == NODE_TYPE_LITERAL && comparison_op(op, true, &filter_op)) {
+        Value* values = malloc(sizeof(Value));
+        values[0] = literal_value(left);
+        add_filter(filters, column, filter_op, values, 1);
+    }
+}
+
+void pushdown_free(PushdownFilters* filters) {
+    if (!filters) return;
+    
+    for (int i = 0; i < filters->count; i++) {
+        for (int j = 0; j < filters->filters[i].value_count; j++) {
+            value_free(&filters->filters[i].values[j]);
+        }
+        free(filters->filters[i].values);
+    }
+    free(filters->filters);
+    filters->filters = NULL;
+    filters->count = 0;
+    filters->capacity = 0;
+}
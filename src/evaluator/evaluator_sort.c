@@ -0,0 +1,183 @@
+/* evaluator_sort.c - ORDER BY on normalized, memcmp comparable sort keys */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "csv_reader.h"
+#include "arena.h"
+#include "evaluator/evaluator_sort.h"
+
+/* first byte of an encoded key, NULL uses 0x00 or 0xff depending on where it goes */
+#define SORT_TAG_NULL_FIRST 0x00
+#define SORT_TAG_NUMBER     0x01
+#define SORT_TAG_DATE       0x02
+#define SORT_TAG_STRING     0x03
+#define SORT_TAG_NULL_LAST  0xff
+
+void sort_key_init(SortKey* key) {
+    key->capacity = 64;
+    key->data = malloc(key->capacity);
+    key->length = 0;
+}
+
+void sort_key_free(SortKey* key) {
+    if (!key) return;
+    
+    free(key->data);
+    key->data = NULL;
+    key->length = 0;
+    key->capacity = 0;
+}
+
+static void sort_key_reserve(SortKey* key, size_t extra) {
+    if (key->length + extra <= key->capacity) return;
+    
+    while (key->length + extra > key->capacity) key->capacity *= 2;
+    key->data = realloc(key->data, key->capacity);
+}
+
+static void put_u64(SortKey* key, uint64_t x) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        key->data[key->length++] = (unsigned char)(x >> shift);
+    }
+}
+
+void sort_key_append(SortKey* key, const Value* value, bool descending, bool nulls_first) {
+    // NULL placement is absolute, it is not flipped by DESC
+    if (!value || value->type == VALUE_TYPE_NULL) {
+        sort_key_reserve(key, 1);
+        key->data[key->length++] = nulls_first ? SORT_TAG_NULL_FIRST : SORT_TAG_NULL_LAST;
+        return;
+    }
+    
+    size_t start = key->length;
+    
+    switch (value->type) {
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_DOUBLE: {
+            // integers and doubles compare as doubles like value_compare does
+            double d = value->type == VALUE_TYPE_INTEGER ? (double)value->int_value : value->double_value;
+            if (d == 0) d = 0.0;
+            
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            bits = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+            
+            sort_key_reserve(key, 9);
+            key->data[key->length++] = SORT_TAG_NUMBER;
+            put_u64(key, bits);
+            break;
+        }
+        case VALUE_TYPE_DATE: {
+            uint64_t packed = ((uint64_t)((uint32_t)value->date_value.year ^ 0x80000000u) << 16) |
+                              ((uint64_t)(value->date_value.month & 0xff) << 8) |
+                              (uint64_t)(value->date_value.day & 0xff);
+            
+            sort_key_reserve(key, 9);
+            key->data[key->length++] = SORT_TAG_DATE;
+            put_u64(key, packed);
+            break;
+        }
+        case VALUE_TYPE_STRING: {
+            // bytes in order with 0x00 escaped as 0x00 0xff and a 0x00 0x00 terminator,
+            // so a string sorts before every longer string it is a prefix of
+            const unsigned char* s = (const unsigned char*)value->string_value;
+            size_t len = s ? value->string_length : 0;
+            
+            sort_key_reserve(key, 2 * len + 3);
+            key->data[key->length++] = SORT_TAG_STRING;
+            for (size_t i = 0; i < len; i++) {
+                key->data[key->length++] = s[i];
+                if (s[i] == 0x00) key->data[key->length++] = 0xff;
+            }
+            key->data[key->length++] = 0x00;
+            key->data[key->length++] = 0x00;
+            break;
+        }
+        case VALUE_TYPE_NULL:
+            break;
+    }
+    
+    // the encodings are prefix free, flipping every byte reverses their order
+    if (descending) {
+        for (size_t i = start; i < key->length; i++) {
+            key->data[i] = (unsigned char)~key->data[i];
+        }
+    }
+}
+
+int sort_key_compare(const unsigned char* a, size_t a_length, const unsigned char* b, size_t b_length) {
+    size_t len = a_length < b_length ? a_length : b_length;
+    int cmp = len > 0 ? memcmp(a, b, len) : 0;
+    if (cmp != 0) return cmp;
+    if (a_length == b_length) return 0;
+    return a_length < b_length ? -1 : 1;
+}
+
+/* a row to sort, its key leading 8 bytes kept inline so most comparisons stop there */
+typedef struct {
+    uint64_t prefix;
+    const unsigned char* data;
+    size_t length;
+    int row;
+} SortEntry;
+
+static int compare_sort_entries(const void* a, const void* b) {
+    const SortEntry* x = a;
+    const SortEntry* y = b;
+    
+    if (x->prefix != y->prefix) return x->prefix < y->prefix ? -1 : 1;
+    
+    if (x->length > 8 || y->length > 8) {
+        size_t x_rest = x->length > 8 ? x->length - 8 : 0;
+        size_t y_rest = y->length > 8 ? y->length - 8 : 0;
+        int cmp = sort_key_compare(x->data + 8, x_rest, y->data + 8, y_rest);
+        if (cmp != 0) return cmp;
+    }
+    
+    // equal keys keep the order of the rows
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+void sort_rows_by_keys(Row* rows, int row_count, const SortKeySpec* keys, int key_count) {
+    if (row_count <= 1 || key_count <= 0) return;
+    
+    // encode the keys of every row once, the encodings live in one arena
+    Arena* arena = arena_create();
+    SortEntry* entries = malloc(sizeof(SortEntry) * row_count);
+    SortKey key;
+    sort_key_init(&key);
+    
+    for (int i = 0; i < row_count; i++) {
+        key.length = 0;
+        for (int k = 0; k < key_count; k++) {
+            const Value* value = keys[k].column < rows[i].column_count ? row_value(&rows[i], keys[k].column) : NULL;
+            sort_key_append(&key, value, keys[k].descending, keys[k].nulls_first);
+        }
+        
+        unsigned char* data = arena_alloc(arena, key.length);
+        memcpy(data, key.data, key.length);
+        
+        uint64_t prefix = 0;
+        for (size_t b = 0; b < 8; b++) {
+            prefix = (prefix << 8) | (b < key.length ? data[b] : 0);
+        }
+        
+        entries[i].prefix = prefix;
+        entries[i].data = data;
+        entries[i].length = key.length;
+        entries[i].row = i;
+    }
+    sort_key_free(&key);
+    
+    qsort(entries, row_count, sizeof(SortEntry), compare_sort_entries);
+    
+    Row* sorted = malloc(sizeof(Row) * row_count);
+    for (int i = 0; i < row_count; i++) sorted[i] = rows[entries[i].row];
+    memcpy(rows, sorted, sizeof(Row) * row_count);
+    
+    free(sorted);
+    free(entries);
+    arena_free(arena);
+}
@@ -14,6 +14,7 @@
 #include "evaluator/evaluator_statements.h"
 #include "evaluator/evaluator_core.h"
 #include "evaluator/evaluator_expressions.h"
+#include "evaluator/evaluator_subquery.h"
 
 extern CsvConfig global_csv_config;
 
@@ -47,7 +48,7 @@ ResultSet* evaluate_insert(ASTNode* insert_node) {
     }
     
     // create new row
-    Row new_row;
+    Row new_row = {0};
     new_row.column_count = table->column_count;
     new_row.values = calloc(table->column_count, sizeof(Value));
     
@@ -108,7 +109,7 @@ ResultSet* evaluate_insert(ASTNode* insert_node) {
     }
     
     // return result message
-    ResultSet* result = malloc(sizeof(ResultSet));
+    ResultSet* result = calloc(1, sizeof(ResultSet));
     result->filename = strdup("INSERT result");
     result->data = NULL;
     result->file_size = 0;
@@ -119,12 +120,12 @@ ResultSet* evaluate_insert(ASTNode* insert_node) {
     result->columns[0].inferred_type = VALUE_TYPE_STRING;
     result->row_count = 1;
     result->row_capacity = 1;
-    result->rows = malloc(sizeof(Row));
+    result->rows = calloc(1, sizeof(Row));
     result->rows[0].column_count = 1;
     result->rows[0].values = malloc(sizeof(Value));
-    result->rows[0].values[0].type = VALUE_TYPE_STRING;
-    result->rows[0].values[0].string_value = malloc(100);
-    snprintf(result->rows[0].values[0].string_value, 100, "Inserted 1 row");
+    char message[100];
+    snprintf(message, sizeof(message), "Inserted 1 row");
+    result->rows[0].values[0] = value_string(strdup(message));
     result->has_header = true;
     result->delimiter = ',';
     result->quote = '"';
@@ -151,6 +152,9 @@ ResultSet* evaluate_update(ASTNode* update_node) {
     ctx.query = NULL;
     ctx.outer_row = NULL;
     ctx.outer_table = NULL;
+    ctx.outer_refs = NULL;
+    ctx.subqueries = NULL;
+    context_new_scope(&ctx);
     
     int updated_count = 0;
     
@@ -187,6 +191,8 @@ ResultSet* evaluate_update(ASTNode* update_node) {
                     table->rows[row].values[col_idx] = parsed;
                 } else {
                     Value result = evaluate_expression(&ctx, val_node, &table->rows[row], 0);
+                    // the table keeps the value, a string borrowed from the row is copied
+                    if (result.borrowed) result = value_copy(&result);
                     table->rows[row].values[col_idx] = result;
                 }
             }
@@ -194,6 +200,10 @@ ResultSet* evaluate_update(ASTNode* update_node) {
         }
     }
     
+    // subqueries of the WHERE clause are done with
+    subquery_cache_free(ctx.subqueries);
+    ctx.subqueries = NULL;
+    
     // save table back to file
     if (!csv_save(update_node->update.table, table)) {
         fprintf(stderr, "Error: Could not save table '%s'\n", update_node->update.table);
@@ -204,7 +214,7 @@ ResultSet* evaluate_update(ASTNode* update_node) {
     }
     
     // return result message
-    ResultSet* result = malloc(sizeof(ResultSet));
+    ResultSet* result = calloc(1, sizeof(ResultSet));
     result->filename = strdup("UPDATE result");
     result->data = NULL;
     result->file_size = 0;
@@ -215,12 +225,12 @@ ResultSet* evaluate_update(ASTNode* update_node) {
     result->columns[0].inferred_type = VALUE_TYPE_STRING;
     result->row_count = 1;
     result->row_capacity = 1;
-    result->rows = malloc(sizeof(Row));
+    result->rows = calloc(1, sizeof(Row));
     result->rows[0].column_count = 1;
     result->rows[0].values = malloc(sizeof(Value));
-    result->rows[0].values[0].type = VALUE_TYPE_STRING;
-    result->rows[0].values[0].string_value = malloc(100);
-    snprintf(result->rows[0].values[0].string_value, 100, "Updated %d row(s)", updated_count);
+    char message[100];
+    snprintf(message, sizeof(message), "Updated %d row(s)", updated_count);
+    result->rows[0].values[0] = value_string(strdup(message));
     result->has_header = true;
     result->delimiter = ',';
     result->quote = '"';
@@ -250,6 +260,9 @@ ResultSet* evaluate_delete(ASTNode* delete_node) {
     ctx.query = NULL;
     ctx.outer_row = NULL;
     ctx.outer_table = NULL;
+    ctx.outer_refs = NULL;
+    ctx.subqueries = NULL;
+    context_new_scope(&ctx);
     
     // find rows to delete
     Row** rows_to_keep = malloc(sizeof(Row*) * table->row_count);
@@ -266,14 +279,16 @@ ResultSet* evaluate_delete(ASTNode* delete_node) {
             // delete this row - free string values
             deleted_count++;
             for (int col = 0; col < table->rows[row].column_count; col++) {
-                if (table->rows[row].values[col].type == VALUE_TYPE_STRING) {
-                    free(table->rows[row].values[col].string_value);
-                }
+                value_free(&table->rows[row].values[col]);
             }
             free(table->rows[row].values);
         }
     }
     
+    // subqueries of the WHERE clause are done with
+    subquery_cache_free(ctx.subqueries);
+    ctx.subqueries = NULL;
+    
     // rebuild rows array
     Row* new_rows = malloc(sizeof(Row) * keep_count);
     for (int i = 0; i < keep_count; i++) {
@@ -295,7 +310,7 @@ ResultSet* evaluate_delete(ASTNode* delete_node) {
     }
     
     // return result message
-    ResultSet* result = malloc(sizeof(ResultSet));
+    ResultSet* result = calloc(1, sizeof(ResultSet));
     result->filename = strdup("DELETE result");
     result->data = NULL;
     result->file_size = 0;
@@ -306,12 +321,12 @@ ResultSet* evaluate_delete(ASTNode* delete_node) {
     result->columns[0].inferred_type = VALUE_TYPE_STRING;
     result->row_count = 1;
     result->row_capacity = 1;
-    result->rows = malloc(sizeof(Row));
+    result->rows = calloc(1, sizeof(Row));
     result->rows[0].column_count = 1;
     result->rows[0].values = malloc(sizeof(Value));
-    result->rows[0].values[0].type = VALUE_TYPE_STRING;
-    result->rows[0].values[0].string_value = malloc(100);
-    snprintf(result->rows[0].values[0].string_value, 100, "Deleted %d row(s)", deleted_count);
+    char message[100];
+    snprintf(message, sizeof(message), "Deleted %d row(s)", deleted_count);
+    result->rows[0].values[0] = value_string(strdup(message));
     result->has_header = true;
     result->delimiter = ',';
     result->quote = '"';
@@ -335,7 +350,7 @@ ResultSet* evaluate_create_table(ASTNode* create_node) {
         }
         
         // create empty CSV table with just header
-        CsvTable* table = malloc(sizeof(CsvTable));
+        CsvTable* table = calloc(1, sizeof(CsvTable));
         table->filename = strdup(filepath);
         table->data = NULL;
         table->file_size = 0;
@@ -365,7 +380,7 @@ ResultSet* evaluate_create_table(ASTNode* create_node) {
         csv_free(table);
         
         // return success message
-        ResultSet* result = malloc(sizeof(ResultSet));
+        ResultSet* result = calloc(1, sizeof(ResultSet));
         result->filename = strdup("CREATE TABLE result");
         result->data = NULL;
         result->file_size = 0;
@@ -376,14 +391,14 @@ ResultSet* evaluate_create_table(ASTNode* create_node) {
         result->columns[0].inferred_type = VALUE_TYPE_STRING;
         result->row_count = 1;
         result->row_capacity = 1;
-        result->rows = malloc(sizeof(Row));
+        result->rows = calloc(1, sizeof(Row));
         result->rows[0].column_count = 1;
         result->rows[0].values = malloc(sizeof(Value));
-        result->rows[0].values[0].type = VALUE_TYPE_STRING;
-        result->rows[0].values[0].string_value = malloc(100);
-        snprintf(result->rows[0].values[0].string_value, 100, 
+        char message[100];
+        snprintf(message, sizeof(message), 
                 "Created table '%s' with %d column(s)", 
                 filepath, create_node->create_table.column_count);
+        result->rows[0].values[0] = value_string(strdup(message));
         result->has_header = true;
         result->delimiter = ',';
         result->quote = '"';
@@ -409,7 +424,7 @@ ResultSet* evaluate_create_table(ASTNode* create_node) {
         csv_free(query_result);
         
         // return success message
-        ResultSet* result = malloc(sizeof(ResultSet));
+        ResultSet* result = calloc(1, sizeof(ResultSet));
         result->filename = strdup("CREATE TABLE result");
         result->data = NULL;
         result->file_size = 0;
@@ -420,14 +435,14 @@ ResultSet* evaluate_create_table(ASTNode* create_node) {
         result->columns[0].inferred_type = VALUE_TYPE_STRING;
         result->row_count = 1;
         result->row_capacity = 1;
-        result->rows = malloc(sizeof(Row));
+        result->rows = calloc(1, sizeof(Row));
         result->rows[0].column_count = 1;
         result->rows[0].values = malloc(sizeof(Value));
-        result->rows[0].values[0].type = VALUE_TYPE_STRING;
-        result->rows[0].values[0].string_value = malloc(100);
-        snprintf(result->rows[0].values[0].string_value, 100, 
+        char message[100];
+        snprintf(message, sizeof(message), 
                 "Created table '%s' with %d row(s)", 
                 filepath, saved_rows);
+        result->rows[0].values[0] = value_string(strdup(message));
         result->has_header = true;
         result->delimiter = ',';
         result->quote = '"';
@@ -449,8 +464,9 @@ ResultSet* evaluate_create_table(ASTNode* create_node) {
 ResultSet* evaluate_alter_table(ASTNode* alter_node) {
     const char* filepath = alter_node->alter_table.table;
     
-    // load the CSV file
+    // load the CSV file, columns are added and dropped in place
     CsvConfig config = global_csv_config;
+    config.editable = true;
     CsvTable* table = csv_load(filepath, config);
     if (!table) {
         fprintf(stderr, "Error: Could not load table '%s'\n", filepath);
@@ -512,8 +528,7 @@ ResultSet* evaluate_alter_table(ASTNode* alter_node) {
             for (int i = 0; i < table->row_count; i++) {
                 table->rows[i].values = realloc(table->rows[i].values, 
                                                sizeof(Value) * table->column_count);
-                table->rows[i].values[table->column_count - 1].type = VALUE_TYPE_STRING;
-                table->rows[i].values[table->column_count - 1].string_value = strdup("");
+                table->rows[i].values[table->column_count - 1] = value_string(strdup(""));
                 table->rows[i].column_count = table->column_count;
             }
             
@@ -558,9 +573,7 @@ ResultSet* evaluate_alter_table(ASTNode* alter_node) {
             
             // remove column from all rows
             for (int i = 0; i < table->row_count; i++) {
-                if (table->rows[i].values[col_idx].type == VALUE_TYPE_STRING) {
-                    free(table->rows[i].values[col_idx].string_value);
-                }
+                value_free(&table->rows[i].values[col_idx]);
                 
                 for (int j = col_idx; j < table->rows[i].column_count - 1; j++) {
                     table->rows[i].values[j] = table->rows[i].values[j + 1];
@@ -597,7 +610,7 @@ ResultSet* evaluate_alter_table(ASTNode* alter_node) {
     csv_free(table);
     
     // return success message
-    ResultSet* result = malloc(sizeof(ResultSet));
+    ResultSet* result = calloc(1, sizeof(ResultSet));
     result->filename = strdup("ALTER TABLE result");
     result->data = NULL;
     result->file_size = 0;
@@ -608,11 +621,10 @@ ResultSet* evaluate_alter_table(ASTNode* alter_node) {
     result->columns[0].inferred_type = VALUE_TYPE_STRING;
     result->row_count = 1;
     result->row_capacity = 1;
-    result->rows = malloc(sizeof(Row));
+    result->rows = calloc(1, sizeof(Row));
     result->rows[0].column_count = 1;
     result->rows[0].values = malloc(sizeof(Value));
-    result->rows[0].values[0].type = VALUE_TYPE_STRING;
-    result->rows[0].values[0].string_value = strdup(message);
+    result->rows[0].values[0] = value_string(strdup(message));
     result->has_header = true;
     result->delimiter = ',';
     result->quote = '"';
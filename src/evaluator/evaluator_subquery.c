@@ -0,0 +1,592 @@
+/* evaluator_subquery.c - subquery results kept for the rest of a query */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "evaluator.h"
+#include "parser.h"
+#include "csv_reader.h"
+#include "evaluator/evaluator_subquery.h"
+#include "evaluator/evaluator_hash.h"
+#include "evaluator/evaluator_internal.h"
+#include "evaluator/evaluator_aggregates.h"
+#include "evaluator/evaluator_joins.h"
+
+/* what the = operator tells apart. value_compare finds values of two different classes equal,
+ * which a lookup by value cannot follow */
+typedef enum {
+    KEY_CLASS_NONE,       // no value but NULL seen
+    KEY_CLASS_NUMBER,
+    KEY_CLASS_STRING,
+    KEY_CLASS_DATE,
+    KEY_CLASS_MIXED,
+} KeyClass;
+
+static KeyClass key_class(const Value* value) {
+    switch (value->type) {
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_DOUBLE:
+            return KEY_CLASS_NUMBER;
+        case VALUE_TYPE_STRING:
+            return KEY_CLASS_STRING;
+        case VALUE_TYPE_DATE:
+            return KEY_CLASS_DATE;
+        default:
+            return KEY_CLASS_NONE;
+    }
+}
+
+typedef enum {
+    IN_SUBQUERY_SET,      // values holds the distinct non NULL values of the column
+    IN_SUBQUERY_FAILED,   // the subquery could not be evaluated, only NOT IN holds
+    IN_SUBQUERY_WIDE,     // the subquery returns more than one column, nothing holds
+} InSubqueryState;
+
+typedef struct {
+    ASTNode* node;
+    bool correlated;      // reads the outer row, evaluated again for every row
+    SubqueryRun run;      // kept for the evaluations of a correlated subquery
+    InSubqueryState state;
+    ValueHashTable values;
+    KeyClass class;       // of the non NULL values
+    bool has_null;
+} InSubquery;
+
+/* a correlated aggregate subquery decorrelated into a grouped aggregate. the inner rows passing
+ * the conditions that do not read the outer row are aggregated once, grouped by the inner side of
+ * its inner.col = outer.col conditions, and an outer row looks up the group of its outer side */
+typedef struct {
+    int key_count;
+    int* outer_columns;
+    KeyClass* classes;    // of the inner key values of all groups
+    ValueHashTable groups;  // inner key values -> index in values
+    Value* values;        // owned
+    Value empty;          // value over no rows, for outer rows matching no group
+    Value* key;           // scratch for lookups
+} GroupedSubquery;
+
+/* results of a scalar subquery evaluated against the rows of one outer table. a result holds
+ * for every row agreeing with the row it was computed for on the outer columns that evaluation
+ * read, and the memo is keyed on all the columns read so far, which only grows */
+typedef struct {
+    ASTNode* node;
+    CsvTable* outer_table;
+    unsigned int scope;   // outer column indices only mean something within the scope they were read in
+    SubqueryRun run;
+    OuterRefs keys;
+    ValueHashTable memo;  // key values -> index in results
+    Value* results;       // owned
+    int result_capacity;
+    bool planned;         // decorrelation was tried
+    GroupedSubquery* grouped;  // NULL unless it could be decorrelated
+} ScalarSubquery;
+
+struct SubqueryCache {
+    InSubquery* in_subqueries;
+    int in_count;
+    int in_capacity;
+    
+    ScalarSubquery* scalar_subqueries;
+    int scalar_count;
+    int scalar_capacity;
+};
+
+void outer_refs_add(OuterRefs* refs, int column) {
+    for (int i = 0; i < refs->count; i++) {
+        if (refs->columns[i] == column) return;
+    }
+    
+    if (refs->count == refs->capacity) {
+        refs->capacity = refs->capacity ? refs->capacity * 2 : 4;
+        refs->columns = realloc(refs->columns, sizeof(int) * refs->capacity);
+    }
+    refs->columns[refs->count++] = column;
+}
+
+void outer_refs_free(OuterRefs* refs) {
+    if (!refs) return;
+    
+    free(refs->columns);
+    refs->columns = NULL;
+    refs->count = 0;
+    refs->capacity = 0;
+}
+
+void subquery_run_free(SubqueryRun* run) {
+    if (!run) return;
+    
+    outer_refs_free(&run->refs);
+    csv_free(run->source);
+    run->source = NULL;
+    run->source_alias = NULL;
+}
+
+/* helper: forget the results of a scalar subquery, keeping the keys they are made for */
+static void clear_memo(ScalarSubquery* entry) {
+    for (int i = 0; i < entry->memo.entry_count; i++) {
+        value_free(&entry->results[i]);
+    }
+    value_hash_table_free(&entry->memo);
+    value_hash_table_init(&entry->memo, entry->keys.count);
+}
+
+static void grouped_subquery_free(GroupedSubquery* grouped) {
+    if (!grouped) return;
+    
+    for (int i = 0; grouped->values && i < grouped->groups.entry_count; i++) {
+        value_free(&grouped->values[i]);
+    }
+    value_hash_table_free(&grouped->groups);
+    value_free(&grouped->empty);
+    free(grouped->values);
+    free(grouped->outer_columns);
+    free(grouped->classes);
+    free(grouped->key);
+    free(grouped);
+}
+
+void subquery_cache_free(SubqueryCache* cache) {
+    if (!cache) return;
+    
+    for (int i = 0; i < cache->in_count; i++) {
+        if (cache->in_subqueries[i].state == IN_SUBQUERY_SET) {
+            value_hash_table_free(&cache->in_subqueries[i].values);
+        }
+        subquery_run_free(&cache->in_subqueries[i].run);
+    }
+    free(cache->in_subqueries);
+    
+    for (int i = 0; i < cache->scalar_count; i++) {
+        ScalarSubquery* entry = &cache->scalar_subqueries[i];
+        for (int r = 0; r < entry->memo.entry_count; r++) {
+            value_free(&entry->results[r]);
+        }
+        value_hash_table_free(&entry->memo);
+        free(entry->results);
+        outer_refs_free(&entry->keys);
+        grouped_subquery_free(entry->grouped);
+        subquery_run_free(&entry->run);
+    }
+    free(cache->scalar_subqueries);
+    free(cache);
+}
+
+static SubqueryCache* context_cache(QueryContext* ctx) {
+    if (!ctx->subqueries) ctx->subqueries = calloc(1, sizeof(SubqueryCache));
+    return ctx->subqueries;
+}
+
+static InSubquery* find_in_subquery(SubqueryCache* cache, ASTNode* node) {
+    for (int i = 0; i < cache->in_count; i++) {
+        if (cache->in_subqueries[i].node == node) return &cache->in_subqueries[i];
+    }
+    return NULL;
+}
+
+/* helper: state of a subquery result, the column is checked as the IN operator needs it */
+static InSubqueryState result_state(ResultSet* result) {
+    if (!result) return IN_SUBQUERY_FAILED;
+    
+    if (result->column_count != 1) {
+        fprintf(stderr, "Error: IN subquery must return exactly one column\n");
+        return IN_SUBQUERY_WIDE;
+    }
+    return IN_SUBQUERY_SET;
+}
+
+/* helper: membership the way a literal IN list tests it, with value_compare. NULL matches
+ * NULL, and a value matches any value of another class, which value_compare finds equal */
+static bool answer_from_set(const InSubquery* entry, const Value* value, bool negated) {
+    if (entry->state == IN_SUBQUERY_FAILED) return negated;
+    if (entry->state == IN_SUBQUERY_WIDE) return false;
+    
+    bool found;
+    if (value->type == VALUE_TYPE_NULL) {
+        found = entry->has_null;
+    } else {
+        KeyClass class = key_class(value);
+        found = (entry->class != KEY_CLASS_NONE && entry->class != class) ||
+                value_hash_table_find(&entry->values, value) >= 0;
+    }
+    return negated ? !found : found;
+}
+
+/* helper: same answer scanning a result used for one row only */
+static bool answer_from_result(ResultSet* result, const Value* value, bool negated) {
+    InSubqueryState state = result_state(result);
+    if (state == IN_SUBQUERY_FAILED) return negated;
+    if (state == IN_SUBQUERY_WIDE) return false;
+    
+    bool found = false;
+    for (int i = 0; i < result->row_count && !found; i++) {
+        found = value_compare(value, &result->rows[i].values[0]) == 0;
+    }
+    return negated ? !found : found;
+}
+
+/* helper: keep the result of an uncorrelated subquery as a hash set */
+static void build_set(InSubquery* entry, ResultSet* result) {
+    entry->state = result_state(result);
+    if (entry->state != IN_SUBQUERY_SET) return;
+    
+    value_hash_table_init(&entry->values, 1);
+    for (int i = 0; i < result->row_count; i++) {
+        const Value* item = &result->rows[i].values[0];
+        if (item->type == VALUE_TYPE_NULL) {
+            entry->has_null = true;
+            continue;
+        }
+        
+        KeyClass class = key_class(item);
+        if (entry->class == KEY_CLASS_NONE) {
+            entry->class = class;
+        } else if (entry->class != class) {
+            entry->class = KEY_CLASS_MIXED;
+        }
+        value_hash_table_insert(&entry->values, item, NULL);
+    }
+}
+
+bool evaluate_in_subquery(QueryContext* ctx, ASTNode* subquery, const Value* value, bool negated,
+                          Row* current_row, int table_index) {
+    if (!subquery->subquery.query) return negated;  // NOT IN empty = true
+    
+    SubqueryCache* cache = context_cache(ctx);
+    InSubquery* entry = find_in_subquery(cache, subquery);
+    if (entry && !entry->correlated) return answer_from_set(entry, value, negated);
+    
+    // run it against this row, noting whether it looks at the row at all
+    SubqueryRun first = {0};
+    SubqueryRun* run = entry ? &entry->run : &first;
+    run->refs.count = 0;
+    
+    CsvTable* outer_table = table_index >= 0 && table_index < ctx->table_count ? ctx->tables[table_index].table
+                                                                                : NULL;
+    ResultSet* result = evaluate_query_internal(subquery->subquery.query, current_row, outer_table, run);
+    bool correlated = run->refs.count > 0;
+    
+    if (!entry) {
+        if (cache->in_count == cache->in_capacity) {
+            cache->in_capacity = cache->in_capacity ? cache->in_capacity * 2 : 4;
+            cache->in_subqueries = realloc(cache->in_subqueries, sizeof(InSubquery) * cache->in_capacity);
+        }
+        entry = &cache->in_subqueries[cache->in_count++];
+        memset(entry, 0, sizeof(InSubquery));
+        entry->node = subquery;
+        entry->correlated = correlated;
+        entry->state = IN_SUBQUERY_FAILED;
+        
+        if (!correlated) {
+            subquery_run_free(&first);
+            build_set(entry, result);
+            if (result) csv_free(result);
+            return answer_from_set(entry, value, negated);
+        }
+        entry->run = first;
+    }
+    
+    bool answer = answer_from_result(result, value, negated);
+    if (result) csv_free(result);
+    return answer;
+}
+
+static ScalarSubquery* find_scalar_subquery(QueryContext* ctx, ASTNode* node, CsvTable* outer_table) {
+    SubqueryCache* cache = context_cache(ctx);
+    for (int i = 0; i < cache->scalar_count; i++) {
+        ScalarSubquery* entry = &cache->scalar_subqueries[i];
+        if (entry->node == node && entry->outer_table == outer_table && entry->scope == ctx->scope) return entry;
+    }
+    
+    if (cache->scalar_count == cache->scalar_capacity) {
+        cache->scalar_capacity = cache->scalar_capacity ? cache->scalar_capacity * 2 : 4;
+        cache->scalar_subqueries = realloc(cache->scalar_subqueries, sizeof(ScalarSubquery) * cache->scalar_capacity);
+    }
+    ScalarSubquery* entry = &cache->scalar_subqueries[cache->scalar_count++];
+    memset(entry, 0, sizeof(ScalarSubquery));
+    entry->node = node;
+    entry->outer_table = outer_table;
+    entry->scope = ctx->scope;
+    value_hash_table_init(&entry->memo, 0);
+    return entry;
+}
+
+/* helper: key values of a row and the memo entry holding them, -1 if there is none. false when
+ * the memo cannot be used for the row: it has no row to read keys from, or a value differs in
+ * type from the key it matched, since a subquery could tell 1 from 1.0 even though the memo cannot */
+static bool row_key(ScalarSubquery* entry, Row* row, Value* key, int* found) {
+    *found = -1;
+    if (!row && entry->keys.count > 0) return false;
+    
+    for (int i = 0; i < entry->keys.count; i++) {
+        key[i] = row_value_peek(row, entry->keys.columns[i]);
+    }
+    
+    *found = value_hash_table_find(&entry->memo, key);
+    if (*found < 0) return true;
+    
+    const Value* stored = value_hash_table_key(&entry->memo, *found);
+    for (int i = 0; i < entry->keys.count; i++) {
+        if (stored[i].type != key[i].type) return false;
+    }
+    return true;
+}
+
+/* helper: the single value of a scalar subquery result, NULL for any other shape */
+static Value scalar_value(ResultSet* result, bool report_errors) {
+    Value value;
+    value.type = VALUE_TYPE_NULL;
+    value.borrowed = false;
+    if (!result) return value;
+    
+    if (result->row_count != 1 || result->column_count != 1) {
+        if (report_errors) {
+            fprintf(stderr, "error: scalar subquery must return exactly one row and one column (got %d rows, %d columns)\n",
+                    result->row_count, result->column_count);
+        }
+        return value;
+    }
+    return value_copy(&result->rows[0].values[0]);
+}
+
+/* helper: split a WHERE clause into the conditions AND-ed together */
+static void collect_conjuncts(ASTNode* condition, ASTNode*** list, int* count, int* capacity) {
+    if (condition->type == NODE_TYPE_CONDITION && strcasecmp(condition->condition.operator, "AND") == 0) {
+        collect_conjuncts(condition->condition.left, list, count, capacity);
+        collect_conjuncts(condition->condition.right, list, count, capacity);
+        return;
+    }
+    
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 4;
+        *list = realloc(*list, sizeof(ASTNode*) * *capacity);
+    }
+    (*list)[(*count)++] = condition;
+}
+
+/* helper: columns of an inner.col = outer.col condition, written in either order */
+static bool correlation_key(QueryContext* inner, ASTNode* condition, int* inner_col, int* outer_col) {
+    if (condition->type != NODE_TYPE_CONDITION || strcmp(condition->condition.operator, "=") != 0) return false;
+    
+    ASTNode* a = condition->condition.left;
+    ASTNode* b = condition->condition.right;
+    if (!a || !b || a->type != NODE_TYPE_IDENTIFIER || b->type != NODE_TYPE_IDENTIFIER) return false;
+    
+    ColumnBinding left = *bind_column_node(inner, a, 0);
+    ColumnBinding right = *bind_column_node(inner, b, 0);
+    if (left.kind == BINDING_OUTER && right.kind == BINDING_ROW) {
+        ColumnBinding swap = left;
+        left = right;
+        right = swap;
+    }
+    if (left.kind != BINDING_ROW || right.kind != BINDING_OUTER) return false;
+    
+    *inner_col = left.index;
+    *outer_col = right.index;
+    return true;
+}
+
+/* helper: the groups of an aggregate result, in the order aggregate_rows made them */
+static bool build_groups(GroupedSubquery* grouped, Row** rows, int row_count, const int* inner_cols,
+                         ResultSet* result) {
+    for (int i = 0; i < row_count; i++) {
+        for (int k = 0; k < grouped->key_count; k++) {
+            grouped->key[k] = *row_value(rows[i], inner_cols[k]);
+            
+            KeyClass class = key_class(&grouped->key[k]);
+            if (grouped->classes[k] == KEY_CLASS_NONE) {
+                grouped->classes[k] = class;
+            } else if (class != KEY_CLASS_NONE && class != grouped->classes[k]) {
+                grouped->classes[k] = KEY_CLASS_MIXED;
+            }
+        }
+        value_hash_table_insert(&grouped->groups, grouped->key, NULL);
+    }
+    if (grouped->groups.entry_count != result->row_count) return false;
+    
+    grouped->values = malloc(sizeof(Value) * (result->row_count > 0 ? result->row_count : 1));
+    for (int g = 0; g < result->row_count; g++) {
+        grouped->values[g] = value_copy(&result->rows[g].values[0]);
+    }
+    return true;
+}
+
+/* helper: decorrelate a subquery made of a single aggregate over one table, whose WHERE clause
+ * compares inner columns to outer ones. NULL for any other shape, or when evaluating the rest of
+ * the subquery reads the outer row */
+static GroupedSubquery* group_subquery(ScalarSubquery* entry, ASTNode* query, Row* current_row,
+                                       CsvTable* outer_table) {
+    ASTNode* select = query->query.select;
+    if (!current_row || !outer_table || !query->query.from || !query->query.where) return NULL;
+    if (query->query.join_count > 0 || query->query.group_by || query->query.having || query->query.order_by) return NULL;
+    if (query->query.limit >= 0 || query->query.offset > 0) return NULL;
+    if (!select || select->type != NODE_TYPE_SELECT || select->select.distinct || select->select.column_count != 1) {
+        return NULL;
+    }
+    if (!has_aggregate_functions(select)) return NULL;
+    
+    // the FROM table is shared with the evaluations of the subquery, in case it is needed after all
+    QueryContext* ctx = context_create(query);
+    ctx->outer_row = current_row;
+    ctx->outer_table = outer_table;
+    if (!entry->run.source) {
+        entry->run.source = load_from_table(query->query.from, &entry->run.source_alias, ctx);
+    }
+    if (!entry->run.source) {
+        context_free(ctx);
+        return NULL;
+    }
+    CsvTable* table = entry->run.source;
+    ctx->table_count = 1;
+    ctx->tables = malloc(sizeof(TableRef));
+    ctx->tables[0].alias = strdup(entry->run.source_alias);
+    ctx->tables[0].table = table;
+    
+    // the equalities make the group key, the other conditions filter the rows
+    ASTNode** conditions = NULL;
+    int condition_count = 0;
+    int condition_capacity = 0;
+    collect_conjuncts(query->query.where, &conditions, &condition_count, &condition_capacity);
+    
+    GroupedSubquery* grouped = calloc(1, sizeof(GroupedSubquery));
+    int* inner_cols = malloc(sizeof(int) * condition_count);
+    grouped->outer_columns = malloc(sizeof(int) * condition_count);
+    int filter_count = 0;
+    for (int i = 0; i < condition_count; i++) {
+        if (correlation_key(ctx, conditions[i], &inner_cols[grouped->key_count],
+                            &grouped->outer_columns[grouped->key_count])) {
+            grouped->key_count++;
+        } else {
+            conditions[filter_count++] = conditions[i];
+        }
+    }
+    
+    Row** rows = NULL;
+    int row_count = 0;
+    ResultSet* result = NULL;
+    bool usable = grouped->key_count > 0;
+    
+    // aggregate_rows resolves group columns by name, which must lead back to the same columns
+    char** group_columns = malloc(sizeof(char*) * (grouped->key_count > 0 ? grouped->key_count : 1));
+    for (int k = 0; k < grouped->key_count && usable; k++) {
+        group_columns[k] = table->columns[inner_cols[k]].name;
+        usable = find_column_index_with_fallback(table, group_columns[k]) == inner_cols[k];
+    }
+    
+    OuterRefs refs = {0};
+    if (usable) {
+        // any read of the outer row from here on means the groups depend on it
+        ctx->outer_refs = &refs;
+        
+        rows = malloc(sizeof(Row*) * (table->row_count > 0 ? table->row_count : 1));
+        for (int i = 0; i < table->row_count; i++) {
+            bool keep = true;
+            for (int c = 0; c < filter_count && keep; c++) {
+                keep = evaluate_condition(ctx, conditions[c], &table->rows[i], 0);
+            }
+            if (keep) rows[row_count++] = &table->rows[i];
+        }
+        
+        result = aggregate_rows(ctx, rows, row_count, group_columns, NULL, grouped->key_count, select);
+        ResultSet* empty = aggregate_rows(ctx, NULL, 0, NULL, NULL, 0, select);
+        grouped->empty = scalar_value(empty, false);
+        if (empty) csv_free(empty);
+        
+        usable = result && result->column_count == 1 && refs.count == 0;
+    }
+    
+    if (usable) {
+        grouped->classes = calloc(grouped->key_count, sizeof(KeyClass));
+        grouped->key = malloc(sizeof(Value) * grouped->key_count);
+        value_hash_table_init(&grouped->groups, grouped->key_count);
+        usable = build_groups(grouped, rows, row_count, inner_cols, result);
+    }
+    
+    if (result) csv_free(result);
+    outer_refs_free(&refs);
+    free(rows);
+    free(group_columns);
+    free(inner_cols);
+    free(conditions);
+    ctx->tables[0].table = NULL;
+    context_free(ctx);
+    
+    if (!usable) {
+        grouped_subquery_free(grouped);
+        return NULL;
+    }
+    return grouped;
+}
+
+/* helper: value of a decorrelated subquery for an outer row, false when a key value of the row
+ * is of a class the groups cannot answer for */
+static bool grouped_value(GroupedSubquery* grouped, Row* row, Value* value) {
+    if (!row) return false;
+    
+    for (int k = 0; k < grouped->key_count; k++) {
+        grouped->key[k] = row_value_peek(row, grouped->outer_columns[k]);
+        
+        KeyClass class = key_class(&grouped->key[k]);
+        if (class != KEY_CLASS_NONE && grouped->classes[k] != KEY_CLASS_NONE && class != grouped->classes[k]) {
+            return false;
+        }
+    }
+    
+    int found = value_hash_table_find(&grouped->groups, grouped->key);
+    *value = value_borrow(found >= 0 ? &grouped->values[found] : &grouped->empty);
+    return true;
+}
+
+Value evaluate_scalar_subquery(QueryContext* ctx, ASTNode* subquery, Row* current_row, CsvTable* outer_table,
+                               bool report_errors) {
+    if (!subquery->subquery.query) return scalar_value(NULL, false);
+    
+    ScalarSubquery* entry = find_scalar_subquery(ctx, subquery, outer_table);
+    
+    if (!entry->planned) {
+        entry->planned = true;
+        entry->grouped = group_subquery(entry, subquery->subquery.query, current_row, outer_table);
+    }
+    Value grouped;
+    if (entry->grouped && grouped_value(entry->grouped, current_row, &grouped)) return grouped;
+    
+    Value* key = malloc(sizeof(Value) * (entry->keys.count > 0 ? entry->keys.count : 1));
+    int found;
+    bool memoizable = row_key(entry, current_row, key, &found);
+    if (found >= 0 && memoizable) {
+        free(key);
+        return value_borrow(&entry->results[found]);
+    }
+    
+    entry->run.refs.count = 0;
+    ResultSet* result = evaluate_query_internal(subquery->subquery.query, current_row, outer_table, &entry->run);
+    Value value = scalar_value(result, report_errors);
+    if (result) csv_free(result);
+    
+    if (!memoizable) {
+        free(key);
+        return value;
+    }
+    
+    // outer columns read for the first time join the key, the results keyed without them are dropped
+    int key_count = entry->keys.count;
+    for (int i = 0; i < entry->run.refs.count; i++) {
+        outer_refs_add(&entry->keys, entry->run.refs.columns[i]);
+    }
+    if (entry->keys.count != key_count) {
+        clear_memo(entry);
+        key = realloc(key, sizeof(Value) * entry->keys.count);
+        for (int i = 0; i < entry->keys.count; i++) {
+            key[i] = row_value_peek(current_row, entry->keys.columns[i]);
+        }
+    }
+    
+    int index = value_hash_table_insert(&entry->memo, key, NULL);
+    free(key);
+    if (index >= entry->result_capacity) {
+        entry->result_capacity = entry->result_capacity ? entry->result_capacity * 2 : 16;
+        entry->results = realloc(entry->results, sizeof(Value) * entry->result_capacity);
+    }
+    entry->results[index] = value;
+    return value_borrow(&entry->results[index]);
+}
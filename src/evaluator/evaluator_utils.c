@@ -14,17 +14,22 @@
 #include "evaluator/evaluator_window.h"
 #include "evaluator/evaluator_core.h"
 #include "evaluator/evaluator_functions.h"
+#include "evaluator/evaluator_columnar.h"
 #include "evaluator/evaluator_internal.h"
+#include "evaluator/evaluator_subquery.h"
+#include "evaluator/evaluator_hash.h"
+#include "evaluator/evaluator_sort.h"
 
 /* forward declarations */
 static int parse_function_arguments(const char* args_str, QueryContext* ctx, 
                                     Row* current_row, Value* out_args, int max_args);
 
-/* deep copy a value to handle string duplication */
+/* deep copy a value to handle string duplication, the copy owns its string */
 void value_deep_copy(Value* dst, const Value* src) {
     if (!dst || !src) return;
     
     dst->type = src->type;
+    dst->borrowed = false;
     
     switch (src->type) {
         case VALUE_TYPE_NULL:
@@ -40,7 +45,8 @@ void value_deep_copy(Value* dst, const Value* src) {
             dst->date_value = src->date_value;  // struct copy
             break;
         case VALUE_TYPE_STRING:
-            dst->string_value = src->string_value ? strdup(src->string_value) : NULL;
+            dst->string_value = src->string_value ? cq_strndup(src->string_value, src->string_length) : NULL;
+            dst->string_length = src->string_length;
             break;
     }
 }
@@ -106,8 +112,7 @@ static int parse_function_arguments(const char* args_str, QueryContext* ctx,
             if (*ptr == '\'') ptr++; // skip closing quote
             arg_buffer[arg_len] = '\0';
             
-            out_args[arg_count].type = VALUE_TYPE_STRING;
-            out_args[arg_count].string_value = strdup(arg_buffer);
+            out_args[arg_count] = value_string(strdup(arg_buffer));
             arg_count++;
         } else {
             // read until comma but skip commas inside parentheses for nested functions
@@ -159,9 +164,7 @@ static int parse_function_arguments(const char* args_str, QueryContext* ctx,
                 
                 // free temporary string arguments from nested call
                 for (int i = 0; i < nested_arg_count; i++) {
-                    if (nested_args[i].type == VALUE_TYPE_STRING && nested_args[i].string_value) {
-                        free((char*)nested_args[i].string_value);
-                    }
+                    value_free(&nested_args[i]);
                 }
                 arg_count++;
             }
@@ -175,7 +178,7 @@ static int parse_function_arguments(const char* args_str, QueryContext* ctx,
                 int col_idx = find_column_index(ctx->tables[0].table, arg_buffer);
                 
                 if (col_idx >= 0 && current_row) {
-                    value_deep_copy(&out_args[arg_count], &current_row->values[col_idx]);
+                    out_args[arg_count] = value_borrow(row_value(current_row, col_idx));
                 } else {
                     out_args[arg_count].type = VALUE_TYPE_NULL;
                 }
@@ -229,33 +232,84 @@ Value evaluate_column_expression(const char* col_spec, QueryContext* ctx,
         
         // free temporary string arguments
         for (int i = 0; i < arg_count; i++) {
-            if (func_args[i].type == VALUE_TYPE_STRING && func_args[i].string_value) {
-                free((char*)func_args[i].string_value);
-            }
+            value_free(&func_args[i]);
         }
     } else {
-        // regular column, get value from row
+        // regular column, borrowed from the row
         int src_col_idx = column_indices ? column_indices[col_index] : -1;
         
         if (src_col_idx >= 0 && current_row && src_col_idx < current_row->column_count) {
-            value_deep_copy(&result, &current_row->values[src_col_idx]);
+            result = value_borrow(row_value(current_row, src_col_idx));
         }
     }
     
     return result;
 }
 
-/* build result for non-aggregated queries */
-ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count) {
-    if (!ctx || !ctx->query) return NULL;
+/* helper: store a select expression of a row in the result, a bare column is copied
+ * from the source row into the result arena without an intermediate copy */
+static void store_expression_value(QueryContext* ctx, ResultSet* result, Value* dst,
+                                   ASTNode* col_node, Row* current_row) {
+    if (col_node->type == NODE_TYPE_IDENTIFIER) {
+        const Value* src = resolve_column_node(ctx, col_node, current_row, 0);
+        if (src) {
+            csv_copy_value(result, dst, src);
+        } else {
+            dst->type = VALUE_TYPE_NULL;
+            dst->int_value = 0;
+        }
+        return;
+    }
+    
+    csv_store_value(result, dst, evaluate_expression(ctx, col_node, current_row, 0));
+}
+
+/* helper: same for the string based column specs, see evaluate_column_expression */
+static void store_column_value(QueryContext* ctx, ResultSet* result, Value* dst, const char* col_spec,
+                               Row* current_row, int* column_indices, int col_index) {
+    int src_col_idx = column_indices[col_index];
+    if (src_col_idx >= 0 && !strchr(col_spec, '(')) {
+        if (current_row && src_col_idx < current_row->column_count) {
+            csv_copy_value(result, dst, row_value(current_row, src_col_idx));
+        } else {
+            dst->type = VALUE_TYPE_NULL;
+            dst->int_value = 0;
+        }
+        return;
+    }
     
-    // create result table
+    csv_store_value(result, dst, evaluate_column_expression(col_spec, ctx, current_row, column_indices, col_index));
+}
+
+/* how each column of a non-aggregated result is computed from a source row */
+typedef struct {
+    int column_count;
+    char** specs;          // select text of the column, the table column name for a column of *
+    ASTNode** nodes;       // parsed expression of the column, NULL for a column of * or a text spec
+    int* column_indices;   // source column of a bare column name, -1 otherwise
+} ResultColumns;
+
+static void result_columns_free(ResultColumns* plan) {
+    for (int i = 0; i < plan->column_count; i++) {
+        free(plan->specs[i]);
+    }
+    free(plan->specs);
+    free(plan->nodes);
+    free(plan->column_indices);
+}
+
+/* create the result of a non-aggregated query with its columns named, without rows */
+static ResultSet* create_select_result(QueryContext* ctx, ResultColumns* plan) {
+    // create result table, its values all live in one arena
     ResultSet* result = calloc(1, sizeof(ResultSet));
+    result->arena = arena_create();
     result->filename = strdup("query_result");
     result->has_header = true;
     result->delimiter = ',';
     result->quote = '"';
     
+    memset(plan, 0, sizeof(*plan));
+    
     // get selected columns from SELECT clause
     ASTNode* select_node = ctx->query->query.select;
     if (!select_node) return result;
@@ -269,33 +323,35 @@ ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count) {
         }
     }
     
+    int total_columns = select_node->select.column_count;
+    if (has_star) total_columns += ctx->tables[0].table->column_count - 1;
+    
+    result->column_count = total_columns;
+    result->columns = malloc(sizeof(Column) * total_columns);
+    plan->column_count = total_columns;
+    plan->specs = malloc(sizeof(char*) * total_columns);
+    plan->nodes = malloc(sizeof(ASTNode*) * total_columns);
+    plan->column_indices = malloc(sizeof(int) * total_columns);
+    
     if (has_star) {
         // expand * to all columns
-        int total_columns = (select_node->select.column_count - 1) + ctx->tables[0].table->column_count;
-        result->column_count = total_columns;
-        result->columns = malloc(sizeof(Column) * total_columns);
-        
-        // build column specs array with * expanded
-        char** expanded_specs = malloc(sizeof(char*) * total_columns);
-        int* column_indices = malloc(sizeof(int) * total_columns);
-        int* original_indices = malloc(sizeof(int) * total_columns); // track original column index
         int col_idx = 0;
         
         for (int i = 0; i < select_node->select.column_count; i++) {
             if (strcmp(select_node->select.columns[i], "*") == 0) {
-                // expand * to all table columns
+                // expand * to all table columns, star columns don't have AST nodes
                 for (int j = 0; j < ctx->tables[0].table->column_count; j++) {
-                    expanded_specs[col_idx] = strdup(ctx->tables[0].table->columns[j].name);
+                    plan->specs[col_idx] = strdup(ctx->tables[0].table->columns[j].name);
+                    plan->nodes[col_idx] = NULL;
                     result->columns[col_idx].name = strdup(ctx->tables[0].table->columns[j].name);
                     result->columns[col_idx].inferred_type = VALUE_TYPE_STRING;
-                    column_indices[col_idx] = j;
-                    original_indices[col_idx] = -1; // star columns don't have AST nodes
+                    plan->column_indices[col_idx] = j;
                     col_idx++;
                 }
             } else {
                 // regular column or function
-                expanded_specs[col_idx] = strdup(select_node->select.columns[i]);
-                original_indices[col_idx] = i; // track which original column this is
+                plan->specs[col_idx] = strdup(select_node->select.columns[i]);
+                plan->nodes[col_idx] = select_node->select.column_nodes ? select_node->select.column_nodes[i] : NULL;
                 
                 // parse column name for display
                 const char* col_spec = select_node->select.columns[i];
@@ -325,108 +381,23 @@ ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count) {
                 result->columns[col_idx].inferred_type = VALUE_TYPE_STRING;
                 
                 // find column index (if not a function)
-                column_indices[col_idx] = -1;
+                plan->column_indices[col_idx] = -1;
                 if (!strchr(col_name, '(')) {
-                    column_indices[col_idx] = find_column_index(ctx->tables[0].table, col_name);
+                    plan->column_indices[col_idx] = find_column_index(ctx->tables[0].table, col_name);
                 }
                 
                 col_idx++;
             }
         }
         
-        // build rows with expanded columns
-        result->row_count = row_count;
-        result->row_capacity = row_count;
-        result->rows = malloc(sizeof(Row) * row_count);
-        
-        for (int i = 0; i < row_count; i++) {
-            result->rows[i].column_count = result->column_count;
-            result->rows[i].values = malloc(sizeof(Value) * result->column_count);
-            
-            for (int j = 0; j < result->column_count; j++) {
-                // check if this column has an AST node (expression, subquery, etc.)
-                int orig_idx = original_indices[j];
-                if (orig_idx >= 0 && select_node->select.column_nodes && 
-                    select_node->select.column_nodes[orig_idx]) {
-                    ASTNode* col_node = select_node->select.column_nodes[orig_idx];
-                    
-                    if (col_node->type == NODE_TYPE_SUBQUERY) {
-                        // evaluate scalar subquery that may be correlated
-                        ResultSet* subquery_result = evaluate_query_internal(col_node->subquery.query, 
-                            filtered_rows[i], ctx->tables[0].table);
-                        
-                        if (!subquery_result) {
-                            result->rows[i].values[j].type = VALUE_TYPE_NULL;
-                        } else if (subquery_result->row_count != 1 || subquery_result->column_count != 1) {
-                            fprintf(stderr, "error: scalar subquery must return exactly one row and one column (got %d rows, %d columns)\n",
-                                    subquery_result->row_count, subquery_result->column_count);
-                            csv_free(subquery_result);
-                            result->rows[i].values[j].type = VALUE_TYPE_NULL;
-                        } else {
-                            value_deep_copy(&result->rows[i].values[j], &subquery_result->rows[0].values[0]);
-                            csv_free(subquery_result);
-                        }
-                    } else if (col_node->type == NODE_TYPE_WINDOW_FUNCTION) {
-                        // window functions evaluated separately
-                        result->rows[i].values[j].type = VALUE_TYPE_NULL;
-                    } else {
-                        // evaluate any expression like identifier, binary_op, function, etc.
-                        Value tmp = evaluate_expression(ctx, col_node, filtered_rows[i], 0);
-                        result->rows[i].values[j] = value_copy(&tmp);
-                    }
-                } else {
-                    // regular column from table or string-based expression
-                    Value tmp = evaluate_column_expression(
-                        expanded_specs[j], ctx, filtered_rows[i], column_indices, j
-                    );
-                    result->rows[i].values[j] = value_copy(&tmp);
-                }
-            }
-        }
-        
-        // evaluate window functions (after all rows are created)
-        if (select_node->select.column_nodes) {
-            for (int j = 0; j < result->column_count; j++) {
-                int orig_idx = original_indices[j];
-                if (orig_idx >= 0) {
-                    ASTNode* col_node = select_node->select.column_nodes[orig_idx];
-                    if (col_node && col_node->type == NODE_TYPE_WINDOW_FUNCTION) {
-                        Value* win_results = evaluate_window_function(col_node, ctx, filtered_rows, row_count);
-                        if (win_results) {
-                            for (int i = 0; i < row_count; i++) {
-                                value_deep_copy(&result->rows[i].values[j], &win_results[i]);
-                                if (win_results[i].type == VALUE_TYPE_STRING && win_results[i].string_value) {
-                                    free((char*)win_results[i].string_value);
-                                }
-                            }
-                            free(win_results);
-                        }
-                    }
-                }
-            }
-        }
-        
-        for (int i = 0; i < result->column_count; i++) {
-            free(expanded_specs[i]);
-        }
-        free(expanded_specs);
-        free(column_indices);
-        free(original_indices);
-        
         return result;
     }
     
-    // normal SELECT without * 
-    result->column_count = select_node->select.column_count;
-    result->columns = malloc(sizeof(Column) * result->column_count);
-    
-    // build column index mapping and extract aliases
-    int* column_indices = malloc(sizeof(int) * result->column_count);
-    char** column_specs = malloc(sizeof(char*) * result->column_count);  // store full specs for functions
-    
+    // normal SELECT without *, build column index mapping and extract aliases
     for (int i = 0; i < result->column_count; i++) {
         const char* col_spec = select_node->select.columns[i];
-        column_specs[i] = strdup(col_spec);
+        plan->specs[i] = strdup(col_spec);  // full specs for functions
+        plan->nodes[i] = select_node->select.column_nodes ? select_node->select.column_nodes[i] : NULL;
         char col_name[256];
         
         // parse "column" or "column AS alias"
@@ -457,7 +428,7 @@ ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count) {
         }
         
         result->columns[i].inferred_type = VALUE_TYPE_STRING;
-        column_indices[i] = -1;
+        plan->column_indices[i] = -1;
         
         // skip column lookup if it's a function (will be evaluated later)
         if (strchr(col_name, '(')) {
@@ -465,120 +436,82 @@ ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count) {
         }
         
         // find column in source table
-        column_indices[i] = find_column_index(ctx->tables[0].table, col_name);
+        plan->column_indices[i] = find_column_index(ctx->tables[0].table, col_name);
     }
     
-    // build rows
+    return result;
+}
+
+/* store column j of the result for a source row */
+static void store_result_value(QueryContext* ctx, ResultSet* result, ResultColumns* plan,
+                               Value* dst, int j, Row* current_row) {
+    ASTNode* col_node = plan->nodes[j];
+    
+    // check if this column has an AST node (expression, subquery, etc.)
+    if (!col_node) {
+        // regular column from table or string-based expression
+        store_column_value(ctx, result, dst, plan->specs[j], current_row, plan->column_indices, j);
+    } else if (col_node->type == NODE_TYPE_SUBQUERY) {
+        // evaluate scalar subquery that may be correlated, memoized by what it reads of the row
+        csv_store_value(result, dst, evaluate_scalar_subquery(ctx, col_node, current_row, ctx->tables[0].table, true));
+    } else if (col_node->type == NODE_TYPE_WINDOW_FUNCTION) {
+        // window functions are evaluated separately for all rows at once
+        dst->type = VALUE_TYPE_NULL;
+        dst->int_value = 0;
+    } else {
+        // evaluate any expression like identifier, binary_op, function, etc.
+        store_expression_value(ctx, result, dst, col_node, current_row);
+    }
+}
+
+/* build one result row per source row, in their order */
+static void fill_result_rows(QueryContext* ctx, ResultSet* result, ResultColumns* plan,
+                             Row** source_rows, int row_count) {
     result->row_count = row_count;
     result->row_capacity = row_count;
-    result->rows = malloc(sizeof(Row) * row_count);
+    result->rows = calloc(row_count, sizeof(Row));
+    if (!ctx->query->query.select) return;
     
     for (int i = 0; i < row_count; i++) {
         result->rows[i].column_count = result->column_count;
-        result->rows[i].values = malloc(sizeof(Value) * result->column_count);
+        result->rows[i].values = csv_alloc_values(result, result->column_count);
         
-        // copy values from filtered row based on column mapping
         for (int j = 0; j < result->column_count; j++) {
-            // check if this column has an AST node (expression, subquery, etc.)
-            if (select_node->select.column_nodes && select_node->select.column_nodes[j]) {
-                ASTNode* col_node = select_node->select.column_nodes[j];
-                
-                if (col_node->type == NODE_TYPE_SUBQUERY) {
-                    // evaluate scalar subquery that may be correlated
-                    ResultSet* subquery_result = evaluate_query_internal(col_node->subquery.query, 
-                        filtered_rows[i], ctx->tables[0].table);
-                    
-                    // validation, it must return exactly 1 row and 1 column
-                    if (!subquery_result) {
-                        result->rows[i].values[j].type = VALUE_TYPE_NULL;
-                    } else if (subquery_result->row_count != 1 || subquery_result->column_count != 1) {
-                        fprintf(stderr, "error: scalar subquery must return exactly one row and one column (got %d rows, %d columns)\n",
-                                subquery_result->row_count, subquery_result->column_count);
-                        csv_free(subquery_result);
-                        result->rows[i].values[j].type = VALUE_TYPE_NULL;
-                    } else {
-                        // copy the single value from subquery result
-                        value_deep_copy(&result->rows[i].values[j], &subquery_result->rows[0].values[0]);
-                        csv_free(subquery_result);
-                    }
-                } else if (col_node->type == NODE_TYPE_WINDOW_FUNCTION) {
-                    // window functions are evaluated separately for all rows at once
-                    // skip here, will be handled after all rows are created
-                    result->rows[i].values[j].type = VALUE_TYPE_NULL;
-                } else {
-                    // evaluate any expression like identifier, binary_op, function, etc.
-                    Value tmp = evaluate_expression(ctx, col_node, filtered_rows[i], 0);
-                    result->rows[i].values[j] = value_copy(&tmp);
-                }
-            } else {
-                Value tmp = evaluate_column_expression(
-                    column_specs[j], ctx, filtered_rows[i], column_indices, j
-                );
-                result->rows[i].values[j] = value_copy(&tmp);
-            }
+            store_result_value(ctx, result, plan, &result->rows[i].values[j], j, source_rows[i]);
         }
     }
     
-    // free temporary arrays
-    for (int i = 0; i < result->column_count; i++) {
-        free(column_specs[i]);
-    }
-    free(column_specs);
-    free(column_indices);
-    
     // evaluate window functions (after all rows are created)
-    if (select_node->select.column_nodes) {
-        for (int j = 0; j < result->column_count; j++) {
-            ASTNode* col_node = select_node->select.column_nodes[j];
-            if (col_node && col_node->type == NODE_TYPE_WINDOW_FUNCTION) {
-                Value* win_results = evaluate_window_function(col_node, ctx, filtered_rows, row_count);
-                if (win_results) {
-                    for (int i = 0; i < row_count; i++) {
-                        value_deep_copy(&result->rows[i].values[j], &win_results[i]);
-                        if (win_results[i].type == VALUE_TYPE_STRING && win_results[i].string_value) {
-                            free((char*)win_results[i].string_value);
-                        }
-                    }
-                    free(win_results);
+    for (int j = 0; j < result->column_count; j++) {
+        ASTNode* col_node = plan->nodes[j];
+        if (col_node && col_node->type == NODE_TYPE_WINDOW_FUNCTION) {
+            Value* win_results = evaluate_window_function(col_node, ctx, source_rows, row_count);
+            if (win_results) {
+                for (int i = 0; i < row_count; i++) {
+                    csv_store_value(result, &result->rows[i].values[j], win_results[i]);
                 }
+                free(win_results);
             }
         }
     }
-    
-    return result;
 }
 
-typedef struct {
-    ResultSet* result;
-    int column_index;
-    bool descending;
-} ResultSortContext;
-
-/* global context for result sorting */
-static ResultSortContext* g_result_sort_ctx = NULL;
-
-/* compare function for result sorting */
-static int compare_result_rows(const void* a, const void* b) {
-    ResultSortContext* ctx = g_result_sort_ctx;
-    Row* row_a = (Row*)a;
-    Row* row_b = (Row*)b;
-    
-    if (!ctx) return 0;
+/* build result for non-aggregated queries */
+ResultSet* build_result(QueryContext* ctx, Row** filtered_rows, int row_count) {
+    if (!ctx || !ctx->query) return NULL;
     
-    if (ctx->column_index < 0 || ctx->column_index >= row_a->column_count) {
-        return 0;
-    }
+    ResultColumns plan;
+    ResultSet* result = create_select_result(ctx, &plan);
+    if (!ctx->query->query.select) return result;
     
-    Value* val_a = &row_a->values[ctx->column_index];
-    Value* val_b = &row_b->values[ctx->column_index];
+    fill_result_rows(ctx, result, &plan, filtered_rows, row_count);
+    result_columns_free(&plan);
     
-    int cmp = value_compare(val_a, val_b);
-    return ctx->descending ? -cmp : cmp;
+    return result;
 }
 
-void sort_result(ResultSet* result, ASTNode* select_node, const char* column_spec, bool descending) {
-    if (!result || result->row_count == 0) return;
-    
+/* result column an ORDER BY column refers to, by display name or select expression, -1 if none */
+static int find_sort_column(ResultSet* result, ASTNode* select_node, const char* column_spec) {
     // parse column specification that might be a function like AVG(t.height) or simple column like t.age
     char lookup_name[256];
     
@@ -686,17 +619,205 @@ void sort_result(ResultSet* result, ASTNode* select_node, const char* column_spe
     
     if (col_idx < 0) {
         fprintf(stderr, "warning: cannot sort by unknown column '%s' (looked for '%s')\n", column_spec, lookup_name);
-        return;
     }
     
-    ResultSortContext sort_ctx;
-    sort_ctx.result = result;
-    sort_ctx.column_index = col_idx;
-    sort_ctx.descending = descending;
+    return col_idx;
+}
+
+/* resolve the ORDER BY keys to result columns, keys naming no column are left out */
+static int resolve_sort_keys(ResultSet* result, ASTNode* select_node, ASTNode* order_by, SortKeySpec* keys) {
+    int key_count = 0;
+    
+    for (int i = 0; i < order_by->order_by.column_count; i++) {
+        int col_idx = find_sort_column(result, select_node, order_by->order_by.columns[i]);
+        if (col_idx < 0) continue;
+        
+        keys[key_count].column = col_idx;
+        keys[key_count].descending = order_by->order_by.descending[i];
+        keys[key_count].nulls_first = order_by->order_by.nulls_first[i];
+        key_count++;
+    }
+    
+    return key_count;
+}
+
+void sort_result(ResultSet* result, ASTNode* select_node, ASTNode* order_by) {
+    if (!result || result->row_count == 0 || !order_by || order_by->order_by.column_count == 0) return;
+    
+    SortKeySpec* keys = malloc(sizeof(SortKeySpec) * order_by->order_by.column_count);
+    int key_count = resolve_sort_keys(result, select_node, order_by, keys);
     
-    g_result_sort_ctx = &sort_ctx;
-    qsort(result->rows, result->row_count, sizeof(Row), compare_result_rows);
-    g_result_sort_ctx = NULL;
+    // a single column of a single type with NULLs in their usual place is sorted on its typed vector
+    bool sorted = key_count == 0;
+    if (key_count == 1 && keys[0].nulls_first == !keys[0].descending) {
+        sorted = columnar_sort_rows(result->rows, result->row_count, keys[0].column, keys[0].descending);
+    }
+    
+    // otherwise on the normalized keys of the rows
+    if (!sorted) {
+        sort_rows_by_keys(result->rows, result->row_count, keys, key_count);
+    }
+    
+    free(keys);
+}
+
+/* candidate row of a top-N selection with its normalized sort key */
+typedef struct {
+    unsigned char* key;   // owned copy
+    size_t key_length;
+    int source;           // index of the source row
+} TopEntry;
+
+/* whether a comes before b in ORDER BY order, ties keep the order of the source rows */
+static bool top_entry_before(const TopEntry* a, const TopEntry* b) {
+    int cmp = sort_key_compare(a->key, a->key_length, b->key, b->key_length);
+    return cmp != 0 ? cmp < 0 : a->source < b->source;
+}
+
+/* heap ordered so that the root is the entry coming last, the first one to drop */
+static void top_heap_sift_down(TopEntry* heap, int count, int i) {
+    for (;;) {
+        int last = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < count && top_entry_before(&heap[last], &heap[left])) last = left;
+        if (right < count && top_entry_before(&heap[last], &heap[right])) last = right;
+        if (last == i) return;
+        
+        TopEntry tmp = heap[i];
+        heap[i] = heap[last];
+        heap[last] = tmp;
+        i = last;
+    }
+}
+
+static void top_heap_sift_up(TopEntry* heap, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!top_entry_before(&heap[parent], &heap[i])) return;
+        
+        TopEntry tmp = heap[i];
+        heap[i] = heap[parent];
+        heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static void top_entry_set(TopEntry* entry, const SortKey* key, int source) {
+    entry->key = realloc(entry->key, key->length > 0 ? key->length : 1);
+    memcpy(entry->key, key->data, key->length);
+    entry->key_length = key->length;
+    entry->source = source;
+}
+
+/* value of column j of the result for a source row without storing it anywhere,
+ * a column read straight from the row is borrowed. release it with value_free */
+static Value peek_result_value(QueryContext* ctx, ResultColumns* plan, int j, Row* current_row) {
+    ASTNode* col_node = plan->nodes[j];
+    Value null_value = { .type = VALUE_TYPE_NULL };
+    
+    if (!col_node) {
+        return evaluate_column_expression(plan->specs[j], ctx, current_row, plan->column_indices, j);
+    }
+    
+    if (col_node->type == NODE_TYPE_IDENTIFIER) {
+        const Value* src = resolve_column_node(ctx, col_node, current_row, 0);
+        return src ? value_borrow(src) : null_value;
+    }
+    
+    if (col_node->type == NODE_TYPE_SUBQUERY) {
+        return evaluate_scalar_subquery(ctx, col_node, current_row, ctx->tables[0].table, true);
+    }
+    
+    return evaluate_expression(ctx, col_node, current_row, 0);
+}
+
+/* build result for non-aggregated queries keeping only its first n rows in ORDER BY order.
+ * the sort columns are computed for every source row and a heap of n of them picks the
+ * winners, only those are materialized */
+ResultSet* build_result_top_n(QueryContext* ctx, Row** filtered_rows, int row_count, ASTNode* order_by, int n) {
+    if (!ctx || !ctx->query) return NULL;
+    
+    ResultColumns plan;
+    ResultSet* result = create_select_result(ctx, &plan);
+    ASTNode* select_node = ctx->query->query.select;
+    if (!select_node) return result;
+    
+    // window functions see every row, and nothing is saved when every row is kept anyway
+    bool windowed = false;
+    for (int j = 0; j < plan.column_count; j++) {
+        if (plan.nodes[j] && plan.nodes[j]->type == NODE_TYPE_WINDOW_FUNCTION) windowed = true;
+    }
+    
+    if (windowed || n >= row_count) {
+        fill_result_rows(ctx, result, &plan, filtered_rows, row_count);
+        result_columns_free(&plan);
+        sort_result(result, select_node, order_by);
+        return result;
+    }
+    
+    // unknown sort columns leave the rows unsorted, like sort_result does
+    SortKeySpec* keys = malloc(sizeof(SortKeySpec) * order_by->order_by.column_count);
+    int key_count = resolve_sort_keys(result, select_node, order_by, keys);
+    if (key_count == 0) {
+        free(keys);
+        fill_result_rows(ctx, result, &plan, filtered_rows, row_count);
+        result_columns_free(&plan);
+        return result;
+    }
+    
+    TopEntry* heap = calloc(n > 0 ? n : 1, sizeof(TopEntry));
+    TopEntry candidate = {0};
+    int count = 0;
+    SortKey key;
+    sort_key_init(&key);
+    
+    for (int i = 0; i < row_count && n > 0; i++) {
+        key.length = 0;
+        for (int k = 0; k < key_count; k++) {
+            Value value = peek_result_value(ctx, &plan, keys[k].column, filtered_rows[i]);
+            sort_key_append(&key, &value, keys[k].descending, keys[k].nulls_first);
+            value_free(&value);
+        }
+        
+        if (count < n) {
+            top_entry_set(&heap[count], &key, i);
+            top_heap_sift_up(heap, count);
+            count++;
+            continue;
+        }
+        
+        candidate.key = key.data;
+        candidate.key_length = key.length;
+        candidate.source = i;
+        if (top_entry_before(&candidate, &heap[0])) {
+            top_entry_set(&heap[0], &key, i);
+            top_heap_sift_down(heap, count, 0);
+        }
+    }
+    sort_key_free(&key);
+    free(keys);
+    
+    // heap sort the winners into output order
+    for (int end = count - 1; end > 0; end--) {
+        TopEntry tmp = heap[0];
+        heap[0] = heap[end];
+        heap[end] = tmp;
+        top_heap_sift_down(heap, end, 0);
+    }
+    
+    Row** winners = malloc(sizeof(Row*) * (count > 0 ? count : 1));
+    for (int i = 0; i < count; i++) {
+        winners[i] = filtered_rows[heap[i].source];
+        free(heap[i].key);
+    }
+    free(heap);
+    
+    fill_result_rows(ctx, result, &plan, winners, count);
+    result_columns_free(&plan);
+    free(winners);
+    
+    return result;
 }
 
 /* helper to apply LIMIT and OFFSET to result */
@@ -707,7 +828,7 @@ void apply_limit_offset(ResultSet* result, int limit, int offset) {
     int actual_limit = limit >= 0 ? limit : result->row_count;
     
     if (actual_offset >= result->row_count) {
-        free_row_range(result->rows, 0, result->row_count);
+        if (!result->arena) free_row_range(result->rows, 0, result->row_count);
         result->row_count = 0;
         return;
     }
@@ -718,11 +839,11 @@ void apply_limit_offset(ResultSet* result, int limit, int offset) {
         count = result->row_count - start;
     }
     
-    // free rows before offset
-    free_row_range(result->rows, 0, start);
-    
-    // free rows after limit
-    free_row_range(result->rows, start + count, result->row_count);
+    // free rows before offset and after limit, rows in an arena go with the result
+    if (!result->arena) {
+        free_row_range(result->rows, 0, start);
+        free_row_range(result->rows, start + count, result->row_count);
+    }
     
     // shift remaining rows to start of array if needed
     if (start > 0 && count > 0) {
@@ -732,176 +853,138 @@ void apply_limit_offset(ResultSet* result, int limit, int offset) {
     result->row_count = count;
 }
 
-/* helper function to check if two rows are equal (all values match) */
-static bool rows_equal(Row* row1, Row* row2, int column_count) {
-    if (!row1 || !row2) return false;
+/* storage of the rows a set operation takes from one of its inputs. the rows of a result
+ * whose values all live in its arena are moved, the arena joining the one of the output,
+ * any other row is deep copied into the output arena */
+static bool take_row_storage(ResultSet* result, ResultSet* source) {
+    if (!source->arena || source->data) return false;
     
-    for (int i = 0; i < column_count; i++) {
-        if (value_compare(&row1->values[i], &row2->values[i]) != 0) {
-            return false;
-        }
-    }
+    arena_merge(result->arena, source->arena);
     return true;
 }
 
-/* helper function to check if a row exists in a result set */
-static bool row_exists_in_result(ResultSet* result, Row* row) {
-    for (int i = 0; i < result->row_count; i++) {
-        if (rows_equal(&result->rows[i], row, result->column_count)) {
-            return true;
-        }
+static void append_set_row(ResultSet* result, Row* row, bool move) {
+    if (move && !row->spans) {
+        result->rows[result->row_count++] = *row;
+        return;
     }
-    return false;
-}
-
-/* helper function to copy a row */
-static Row copy_row(Row* source, int column_count) {
-    Row new_row;
-    new_row.column_count = column_count;
-    new_row.values = malloc(sizeof(Value) * column_count);
     
-    for (int i = 0; i < column_count; i++) {
-        value_deep_copy(&new_row.values[i], &source->values[i]);
+    Row new_row = {0};
+    new_row.column_count = result->column_count;
+    new_row.values = csv_alloc_values(result, result->column_count);
+    for (int i = 0; i < result->column_count; i++) {
+        csv_copy_value(result, &new_row.values[i], row_value(row, i));
     }
-    
-    return new_row;
+    result->rows[result->row_count++] = new_row;
+}
+
+/* output of a set operation, its rows live in one arena */
+static ResultSet* create_set_result(const char* filename, ResultSet* left, int row_capacity) {
+    ResultSet* result = create_result_set_schema(filename, left);
+    result->arena = arena_create();
+    result->row_capacity = row_capacity;
+    result->rows = calloc(row_capacity > 0 ? row_capacity : 1, sizeof(Row));
+    result->row_count = 0;
+    return result;
+}
+
+/* the moved rows belong to the output now, the input keeps nothing to free */
+static void release_moved_rows(ResultSet* source, bool moved) {
+    if (moved) source->row_count = 0;
 }
 
 /* UNION operation - combine two result sets (optionally removing duplicates) */
 ResultSet* set_union(ResultSet* left, ResultSet* right, bool include_duplicates) {
     if (!left || !right) return NULL;
     
-    // create result with same schema as left
-    ResultSet* result = create_result_set_schema("union_result", left);
+    ResultSet* result = create_set_result("union_result", left, left->row_count + right->row_count);
+    bool move_left = take_row_storage(result, left);
+    bool move_right = take_row_storage(result, right);
     
-    // allocate rows
-    result->row_capacity = left->row_count + right->row_count;
-    result->rows = malloc(sizeof(Row) * result->row_capacity);
-    result->row_count = 0;
-    
-    // add all rows from left
-    for (int i = 0; i < left->row_count; i++) {
-        result->rows[result->row_count++] = copy_row(&left->rows[i], left->column_count);
-    }
-    
-    // add rows from right
-    for (int i = 0; i < right->row_count; i++) {
-        // if not UNION ALL, check for duplicates
-        if (!include_duplicates && row_exists_in_result(result, &right->rows[i])) {
-            continue;
+    if (include_duplicates) {
+        // UNION ALL is a plain append
+        for (int i = 0; i < left->row_count; i++) {
+            append_set_row(result, &left->rows[i], move_left);
         }
-        result->rows[result->row_count++] = copy_row(&right->rows[i], right->column_count);
+        for (int i = 0; i < right->row_count; i++) {
+            append_set_row(result, &right->rows[i], move_right);
+        }
+    } else {
+        // first occurrence of every row across both sides, NULL matching NULL
+        RowHashSet seen;
+        row_hash_set_init(&seen, left->column_count);
+        bool inserted;
+        for (int i = 0; i < left->row_count; i++) {
+            row_hash_set_insert(&seen, &left->rows[i], &inserted);
+            if (inserted) append_set_row(result, &left->rows[i], move_left);
+        }
+        for (int i = 0; i < right->row_count; i++) {
+            row_hash_set_insert(&seen, &right->rows[i], &inserted);
+            if (inserted) append_set_row(result, &right->rows[i], move_right);
+        }
+        row_hash_set_free(&seen);
     }
     
+    release_moved_rows(left, move_left);
+    release_moved_rows(right, move_right);
     return result;
 }
 
-/* INTERSECT operation - return rows that exist in both result sets */
-ResultSet* set_intersect(ResultSet* left, ResultSet* right) {
+/* rows of left that are (or are not) in right, each one once, in the order of left */
+static ResultSet* set_filter_left(const char* filename, ResultSet* left, ResultSet* right, bool in_right) {
     if (!left || !right) return NULL;
     
-    // create result with same schema as left
-    ResultSet* result = create_result_set_schema("intersect_result", left);
+    ResultSet* result = create_set_result(filename, left, left->row_count);
+    bool move_left = take_row_storage(result, left);
     
-    // allocate rows (at most left->row_count)
-    result->row_capacity = left->row_count;
-    result->rows = malloc(sizeof(Row) * result->row_capacity);
-    result->row_count = 0;
+    RowHashSet right_rows;
+    row_hash_set_init(&right_rows, left->column_count);
+    for (int i = 0; i < right->row_count; i++) {
+        row_hash_set_insert(&right_rows, &right->rows[i], NULL);
+    }
     
-    // add rows from left that also exist in right
+    RowHashSet seen;
+    row_hash_set_init(&seen, left->column_count);
     for (int i = 0; i < left->row_count; i++) {
-        // check if this row exists in right
-        bool found = false;
-        for (int j = 0; j < right->row_count; j++) {
-            if (rows_equal(&left->rows[i], &right->rows[j], left->column_count)) {
-                found = true;
-                break;
-            }
-        }
+        bool found = row_hash_set_find(&right_rows, &left->rows[i]) >= 0;
+        if (found != in_right) continue;
         
-        if (found) {
-            // avoid duplicates in result
-            if (!row_exists_in_result(result, &left->rows[i])) {
-                result->rows[result->row_count++] = copy_row(&left->rows[i], left->column_count);
-            }
-        }
+        bool inserted;
+        row_hash_set_insert(&seen, &left->rows[i], &inserted);
+        if (inserted) append_set_row(result, &left->rows[i], move_left);
     }
+    row_hash_set_free(&seen);
+    row_hash_set_free(&right_rows);
     
+    release_moved_rows(left, move_left);
     return result;
 }
 
+/* INTERSECT operation - return rows that exist in both result sets */
+ResultSet* set_intersect(ResultSet* left, ResultSet* right) {
+    return set_filter_left("intersect_result", left, right, true);
+}
+
 /* EXCEPT operation - return rows from left that don't exist in right */
 ResultSet* set_except(ResultSet* left, ResultSet* right) {
-    if (!left || !right) return NULL;
-    
-    // create result with same schema as left
-    ResultSet* result = create_result_set_schema("except_result", left);
-    
-    // allocate rows (at most left->row_count)
-    result->row_capacity = left->row_count;
-    result->rows = malloc(sizeof(Row) * result->row_capacity);
-    result->row_count = 0;
-    
-    // add rows from left that don't exist in right
-    for (int i = 0; i < left->row_count; i++) {
-        // check if this row exists in right
-        bool found = false;
-        for (int j = 0; j < right->row_count; j++) {
-            if (rows_equal(&left->rows[i], &right->rows[j], left->column_count)) {
-                found = true;
-                break;
-            }
-        }
-        
-        if (!found) {
-            // avoid duplicates in result
-            if (!row_exists_in_result(result, &left->rows[i])) {
-                result->rows[result->row_count++] = copy_row(&left->rows[i], left->column_count);
-            }
-        }
-    }
-    
-    return result;
+    return set_filter_left("except_result", left, right, false);
 }
 
-/* remove duplicate rows from result set for DISTINCT */
+/* remove duplicate rows from result set for DISTINCT, keeping the first occurrence of each */
 void apply_distinct(ResultSet* result) {
     if (!result || result->row_count <= 1) return;
     
-    // hash-based deduplication using a simple approach:
-    // we'll track which rows to keep and compact the array
+    // a row is kept when no earlier row holds the same values, NULL matching NULL
     bool* keep = calloc(result->row_count, sizeof(bool));
     int unique_count = 0;
     
-    // compare each row with previously kept rows
+    RowHashSet seen;
+    row_hash_set_init(&seen, result->column_count);
     for (int i = 0; i < result->row_count; i++) {
-        bool is_duplicate = false;
-        
-        // check if this row is duplicate of any previous kept row
-        for (int j = 0; j < i; j++) {
-            if (!keep[j]) continue;
-            
-            // compare all values in the row
-            bool rows_equal_flag = true;
-            for (int col = 0; col < result->column_count; col++) {
-                if (value_compare(&result->rows[i].values[col], 
-                                 &result->rows[j].values[col]) != 0) {
-                    rows_equal_flag = false;
-                    break;
-                }
-            }
-            
-            if (rows_equal_flag) {
-                is_duplicate = true;
-                break;
-            }
-        }
-        
-        if (!is_duplicate) {
-            keep[i] = true;
-            unique_count++;
-        }
+        row_hash_set_insert(&seen, &result->rows[i], &keep[i]);
+        unique_count += keep[i];
     }
+    row_hash_set_free(&seen);
     
     // if all rows are unique, nothing to do
     if (unique_count == result->row_count) {
@@ -918,7 +1001,7 @@ void apply_distinct(ResultSet* result) {
                 result->rows[write_pos] = result->rows[i];
             }
             write_pos++;
-        } else {
+        } else if (!result->arena) {
             // free duplicate row
             for (int col = 0; col < result->column_count; col++) {
                 value_free(&result->rows[i].values[col]);
@@ -952,7 +1035,7 @@ CsvTable* result_to_csv_table(ResultSet* result) {
     // copy rows
     table->row_count = result->row_count;
     table->row_capacity = result->row_capacity;
-    table->rows = malloc(sizeof(Row) * table->row_count);
+    table->rows = calloc(table->row_count, sizeof(Row));
     
     for (int i = 0; i < table->row_count; i++) {
         table->rows[i].column_count = result->rows[i].column_count;
@@ -973,31 +1056,26 @@ CsvTable* result_to_csv_table(ResultSet* result) {
 void free_row_range(Row* rows, int start, int end) {
     for (int i = start; i < end; i++) {
         for (int j = 0; j < rows[i].column_count; j++) {
-            if (rows[i].values[j].type == VALUE_TYPE_STRING && 
-                rows[i].values[j].string_value) {
-                free((char*)rows[i].values[j].string_value);
-            }
+            value_free(&rows[i].values[j]);
         }
         free(rows[i].values);
     }
 }
 
-/* helper to apply WHERE filtering */
+/* helper to apply WHERE filtering, a batch of rows at a time */
 Row** filter_rows(QueryContext* ctx, ASTNode* where_clause, int* out_filtered_count) {
-    int filtered_capacity = ctx->tables[0].table->row_count;
-    Row** filtered_rows = malloc(sizeof(Row*) * filtered_capacity);
+    CsvTable* table = ctx->tables[0].table;
+    Row** filtered_rows = malloc(sizeof(Row*) * (table->row_count > 0 ? table->row_count : 1));
     int filtered_count = 0;
+    int sel[COLUMNAR_BATCH_SIZE];
     
-    for (int i = 0; i < ctx->tables[0].table->row_count; i++) {
-        Row* row = &ctx->tables[0].table->rows[i];
-        
-        bool matches = true;
-        if (where_clause) {
-            matches = evaluate_condition(ctx, where_clause, row, 0);
-        }
+    for (int start = 0; start < table->row_count; start += COLUMNAR_BATCH_SIZE) {
+        int count = table->row_count - start;
+        if (count > COLUMNAR_BATCH_SIZE) count = COLUMNAR_BATCH_SIZE;
         
-        if (matches) {
-            filtered_rows[filtered_count++] = row;
+        int kept = columnar_filter_batch(ctx, where_clause, start, count, sel);
+        for (int k = 0; k < kept; k++) {
+            filtered_rows[filtered_count++] = &table->rows[start + sel[k]];
         }
     }
     
@@ -35,8 +35,8 @@ static int compare_rows(const void* a, const void* b) {
     int col_idx = sort_ctx->column_index;
     if (col_idx < 0 || col_idx >= row_a->column_count) return 0;
     
-    Value* val_a = &row_a->values[col_idx];
-    Value* val_b = &row_b->values[col_idx];
+    const Value* val_a = row_value(row_a, col_idx);
+    const Value* val_b = row_value(row_b, col_idx);
     
     int cmp = value_compare(val_a, val_b);
     
@@ -77,11 +77,11 @@ Value* evaluate_window_function(ASTNode* win_func, QueryContext* ctx, Row** rows
             // build partition key from PARTITION BY columns
             char part_key[1024] = "";
             for (int p = 0; p < win_func->window_function.partition_count; p++) {
-                Value* val = resolve_column(ctx, win_func->window_function.partition_by[p], rows[i], 0);
+                const Value* val = resolve_column(ctx, win_func->window_function.partition_by[p], rows[i], 0);
                 if (val) {
                     if (p > 0) strcat(part_key, "\t");
                     if (val->type == VALUE_TYPE_STRING && val->string_value) {
-                        strcat(part_key, val->string_value);
+                        strncat(part_key, val->string_value, val->string_length);
                     } else if (val->type == VALUE_TYPE_INTEGER) {
                         char num_buf[32];
                         snprintf(num_buf, sizeof(num_buf), "%lld", val->int_value);
@@ -225,8 +225,8 @@ Value* evaluate_window_function(ASTNode* win_func, QueryContext* ctx, Row** rows
                 
                 // check if next row has same value (tie)
                 if (i + 1 < count) {
-                    Value* curr_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[row_idx], 0);
-                    Value* next_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[indices[i + 1]], 0);
+                    const Value* curr_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[row_idx], 0);
+                    const Value* next_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[indices[i + 1]], 0);
                     
                     // if values differ, increment rank by number of tied rows
                     if (curr_val && next_val && value_compare(curr_val, next_val) != 0) {
@@ -252,8 +252,8 @@ Value* evaluate_window_function(ASTNode* win_func, QueryContext* ctx, Row** rows
                 
                 // check if next row has different value
                 if (i + 1 < count) {
-                    Value* curr_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[row_idx], 0);
-                    Value* next_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[indices[i + 1]], 0);
+                    const Value* curr_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[row_idx], 0);
+                    const Value* next_val = resolve_column(ctx, win_func->window_function.order_by_column, rows[indices[i + 1]], 0);
                     
                     if (curr_val && next_val && value_compare(curr_val, next_val) != 0) {
                         dense_rank++;
@@ -279,9 +279,7 @@ Value* evaluate_window_function(ASTNode* win_func, QueryContext* ctx, Row** rows
                     int prev_row_idx = indices[i - offset];
                     Value val = evaluate_expression(ctx, win_func->window_function.args[0], rows[prev_row_idx], 0);
                     value_deep_copy(&results[row_idx], &val);
-                    if (val.type == VALUE_TYPE_STRING && val.string_value) {
-                        free((char*)val.string_value);
-                    }
+                    value_free(&val);
                 } else {
                     results[row_idx].type = VALUE_TYPE_NULL;
                 }
@@ -305,9 +303,7 @@ Value* evaluate_window_function(ASTNode* win_func, QueryContext* ctx, Row** rows
                     int next_row_idx = indices[i + offset];
                     Value val = evaluate_expression(ctx, win_func->window_function.args[0], rows[next_row_idx], 0);
                     value_deep_copy(&results[row_idx], &val);
-                    if (val.type == VALUE_TYPE_STRING && val.string_value) {
-                        free((char*)val.string_value);
-                    }
+                    value_free(&val);
                 } else {
                     results[row_idx].type = VALUE_TYPE_NULL;
                 }
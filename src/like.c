@@ -0,0 +1,220 @@
+/* like.c - LIKE and ILIKE pattern matching */
+
+#include <stdlib.h>
+#include <string.h>
+#include "like.h"
+#include "string_utils.h"
+
+typedef enum {
+    LIKE_EXACT,       // no wildcard
+    LIKE_PREFIX,      // text%
+    LIKE_SUFFIX,      // %text
+    LIKE_CONTAINS,    // %text%
+    LIKE_PIECES,      // any other mix of text and %
+    LIKE_GENERAL,     // holds _, matched by match_pattern
+} LikeKind;
+
+/* text between two % wildcards */
+typedef struct {
+    size_t offset;
+    size_t length;
+} LikePiece;
+
+struct LikePattern {
+    LikeKind kind;
+    bool case_sensitive;
+    char* text;           // the pattern, in lower case when case is ignored
+    size_t length;
+    LikePiece* pieces;    // empty ones are left out
+    int piece_count;
+    bool anchored_start;  // the first piece starts the string
+    bool anchored_end;    // the last piece ends it
+};
+
+/* lower case of a byte, what tolower gives in the C locale the program runs in */
+static inline unsigned char fold(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+bool match_pattern(const char* str, size_t str_len, const char* pattern, size_t pattern_len,
+                   bool case_sensitive) {
+    if (!str || !pattern) return false;
+    
+    const char* s = str;
+    const char* s_end = str + str_len;
+    const char* p = pattern;
+    const char* p_end = pattern + pattern_len;
+    const char* star = NULL;
+    const char* ss = NULL;
+    
+    while (s < s_end) {
+        if (p < p_end && *p == '%') {
+            // remember position for backtracking
+            star = p++;
+            ss = s;
+        } else if (p < p_end && *p == '_') {
+            // single character wildcard
+            s++;
+            p++;
+        } else {
+            // check character match
+            bool match = false;
+            if (p < p_end) {
+                if (case_sensitive) {
+                    match = (*s == *p);
+                } else {
+                    match = fold((unsigned char)*s) == fold((unsigned char)*p);
+                }
+            }
+            
+            if (match) {
+                s++;
+                p++;
+            } else if (star) {
+                // backtrack to last %
+                p = star + 1;
+                s = ++ss;
+            } else {
+                return false;
+            }
+        }
+    }
+    
+    // consume remaining % at end of pattern
+    while (p < p_end && *p == '%') p++;
+    
+    return p == p_end;
+}
+
+LikePattern* like_compile(const char* pattern, size_t pattern_len, bool case_sensitive) {
+    LikePattern* like = calloc(1, sizeof(LikePattern));
+    like->case_sensitive = case_sensitive;
+    like->length = pattern_len;
+    like->text = malloc(pattern_len + 1);
+    for (size_t i = 0; i < pattern_len; i++) {
+        like->text[i] = case_sensitive ? pattern[i] : (char)fold((unsigned char)pattern[i]);
+    }
+    like->text[pattern_len] = '\0';
+    
+    if (memchr(like->text, '_', pattern_len)) {
+        like->kind = LIKE_GENERAL;
+        return like;
+    }
+    
+    // split the text at the % wildcards
+    like->pieces = malloc(sizeof(LikePiece) * (pattern_len / 2 + 1));
+    size_t start = 0;
+    bool wildcard = false;
+    for (size_t i = 0; i <= pattern_len; i++) {
+        if (i < pattern_len && like->text[i] != '%') continue;
+        if (i > start) like->pieces[like->piece_count++] = (LikePiece){start, i - start};
+        wildcard = wildcard || i < pattern_len;
+        start = i + 1;
+    }
+    
+    if (!wildcard) {
+        like->kind = LIKE_EXACT;
+        like->pieces[0] = (LikePiece){0, pattern_len};
+        like->piece_count = 1;
+        return like;
+    }
+    
+    like->anchored_start = like->text[0] != '%';
+    like->anchored_end = like->text[pattern_len - 1] != '%';
+    
+    like->kind = LIKE_PIECES;
+    if (like->piece_count == 1) {
+        if (like->anchored_start) like->kind = LIKE_PREFIX;
+        else if (like->anchored_end) like->kind = LIKE_SUFFIX;
+        else like->kind = LIKE_CONTAINS;
+    }
+    return like;
+}
+
+/* helper: the bytes at s equal a piece of the pattern */
+static inline bool piece_equal(const LikePattern* like, const char* s, const LikePiece* piece) {
+    const char* p = like->text + piece->offset;
+    if (like->case_sensitive) return memcmp(s, p, piece->length) == 0;
+    
+    for (size_t i = 0; i < piece->length; i++) {
+        if (fold((unsigned char)s[i]) != (unsigned char)p[i]) return false;
+    }
+    return true;
+}
+
+/* helper: first occurrence of a piece in n bytes at s, NULL if there is none */
+static const char* piece_find(const LikePattern* like, const char* s, size_t n, const LikePiece* piece) {
+    if (like->case_sensitive) return cq_memmem(s, n, like->text + piece->offset, piece->length);
+    
+    if (piece->length > n) return NULL;
+    
+    // a first byte without case is found by memchr, a letter in either case by setting the case bit
+    unsigned char first = (unsigned char)like->text[piece->offset];
+    LikePiece rest = {piece->offset + 1, piece->length - 1};
+    const char* last = s + (n - piece->length);
+    if (first < 'a' || first > 'z') {
+        for (const char* p = s; p <= last; p++) {
+            p = memchr(p, first, (size_t)(last - p) + 1);
+            if (!p) return NULL;
+            if (piece_equal(like, p + 1, &rest)) return p;
+        }
+        return NULL;
+    }
+    for (const char* p = s; p <= last; p++) {
+        if (((unsigned char)*p | 0x20) == first && piece_equal(like, p + 1, &rest)) return p;
+    }
+    return NULL;
+}
+
+bool like_match(const LikePattern* like, const char* str, size_t str_len) {
+    if (!str) return false;
+    
+    const LikePiece* first = like->pieces;
+    switch (like->kind) {
+        case LIKE_EXACT:
+            return str_len == first->length && piece_equal(like, str, first);
+        case LIKE_PREFIX:
+            return str_len >= first->length && piece_equal(like, str, first);
+        case LIKE_SUFFIX:
+            return str_len >= first->length && piece_equal(like, str + str_len - first->length, first);
+        case LIKE_CONTAINS:
+            return piece_find(like, str, str_len, first) != NULL;
+        case LIKE_GENERAL:
+            return match_pattern(str, str_len, like->text, like->length, like->case_sensitive);
+        case LIKE_PIECES:
+            break;
+    }
+    
+    // the pieces at the ends are fixed, the ones between are taken at their first occurrence
+    size_t start = 0;
+    size_t end = str_len;
+    int from = 0;
+    int to = like->piece_count;
+    
+    if (like->anchored_start) {
+        if (str_len < first->length || !piece_equal(like, str, first)) return false;
+        start = first->length;
+        from++;
+    }
+    if (like->anchored_end && to > from) {
+        const LikePiece* last = &like->pieces[to - 1];
+        if (end - start < last->length || !piece_equal(like, str + end - last->length, last)) return false;
+        end -= last->length;
+        to--;
+    }
+    
+    for (int i = from; i < to; i++) {
+        const char* found = piece_find(like, str + start, end - start, &like->pieces[i]);
+        if (!found) return false;
+        start = (size_t)(found - str) + like->pieces[i].length;
+    }
+    return true;
+}
+
+void like_free(LikePattern* like) {
+    if (!like) return;
+    
+    free(like->text);
+    free(like->pieces);
+    free(like);
+}
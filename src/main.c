@@ -9,6 +9,52 @@
 #include "csv_reader.h"
 #include "utils.h"
 
+/* output options of a streamed query, rows are printed and written as they arrive */
+typedef struct {
+    bool print_table;
+    bool vertical_output;
+    const char* output_file;
+    char output_delimiter;
+    FILE* out;
+    int row_count;
+    int column_count;
+} StreamOutput;
+
+static void stream_begin(void* ctx, ResultSet* header) {
+    StreamOutput* output = ctx;
+    output->column_count = header->column_count;
+    
+    if (output->print_table && !output->vertical_output) {
+        csv_print_table_header(header);
+    }
+    
+    if (output->output_file) {
+        output->out = fopen(output->output_file, "w");
+        if (!output->out) {
+            fprintf(stderr, "Error: Cannot open output file '%s'\n", output->output_file);
+        } else {
+            write_csv_header(output->out, header, output->output_delimiter);
+        }
+    }
+}
+
+static void stream_rows(void* ctx, ResultSet* batch) {
+    StreamOutput* output = ctx;
+    
+    if (output->print_table) {
+        if (output->vertical_output) {
+            csv_print_table_vertical_rows(batch, batch->row_count, output->row_count);
+        } else {
+            csv_print_table_rows(batch, batch->row_count);
+        }
+    }
+    
+    if (output->out) {
+        write_csv_rows(output->out, batch, output->output_delimiter);
+    }
+    
+    output->row_count += batch->row_count;
+}
 
 int main(int argc, char* argv[]) {
     char* query = NULL;
@@ -20,18 +66,20 @@ int main(int argc, char* argv[]) {
     bool query_allocated = false;  // track if we need to free query
     char input_separator = ',';
     char output_delimiter = ',';
+    int load_threads = 0;          // 0 = one loader thread per cpu
     
-    // long options for --force
+    // long options for --force and --threads
     static struct option long_options[] = {
         {"force", no_argument, 0, 'F'},
         {"help", no_argument, 0, 'h'},
+        {"threads", required_argument, 0, 't'},
         {0, 0, 0, 0}
     };
     
     // parse args
     int opt;
     int option_index = 0;
-    while ((opt = getopt_long(argc, argv, "hq:f:o:cps:d:vF", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hq:f:o:cps:d:vFt:", long_options, &option_index)) != -1) {
         switch (opt) {
             case 'h':
                 print_help(argv[0]);
@@ -64,6 +112,13 @@ int main(int argc, char* argv[]) {
             case 'F':
                 force_delete = true;
                 break;
+            case 't':
+                load_threads = atoi(optarg);
+                if (load_threads < 0) {
+                    fprintf(stderr, "Error: --threads must be 0 (auto) or a positive number\n");
+                    return 1;
+                }
+                break;
             default:
                 print_help(argv[0]);
                 return 1;
@@ -99,6 +154,7 @@ int main(int argc, char* argv[]) {
     global_csv_config.delimiter = input_separator;
     global_csv_config.quote = '"';
     global_csv_config.has_header = true;
+    global_csv_config.threads = load_threads;
     
     // parse SQL query
     ASTNode* ast = parse(query);
@@ -107,6 +163,47 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // queries without a blocking operator are printed while the file is read, unless
+    // the counts have to come before the table
+    if (query_is_streamable(ast) && !(print_count && print_table)) {
+        StreamOutput output = {
+            .print_table = print_table,
+            .vertical_output = vertical_output,
+            .output_file = output_file,
+            .output_delimiter = output_delimiter,
+        };
+        ResultSink sink = { stream_begin, stream_rows, &output };
+        
+        int row_count = evaluate_query_streaming(ast, &sink);
+        if (output.out) {
+            fclose(output.out);
+        }
+        if (row_count < 0) {
+            fprintf(stderr, "Error: Query evaluation failed\n");
+            releaseNode(ast);
+            return 1;
+        }
+        
+        if (print_count) {
+            printf("Records: %d\n", row_count);
+            printf("Columns: %d\n", output.column_count);
+        }
+        
+        if (output.out) {
+            printf("Result written to '%s'\n", output_file);
+        }
+        
+        if (!print_count && !print_table && !output_file) {
+            printf("Count: %d\n", row_count);
+        }
+        
+        releaseNode(ast);
+        if (query_allocated) {
+            free(query);
+        }
+        return 0;
+    }
+    
     // evaluate query
     ResultSet* result = evaluate_query(ast);
     if (!result) {
@@ -3,6 +3,7 @@
 #include <string.h>
 #include "parser.h"
 #include "parser/ast_nodes.h"
+#include "evaluator/evaluator_program.h"
 #include "string_utils.h"
 
 void retainNode(ASTNode* node) {
@@ -85,7 +86,14 @@ void releaseNode(ASTNode* node) {
             }
             break;
         case NODE_TYPE_ORDER_BY:
-            free(node->order_by.column);
+            if (node->order_by.columns) {
+                for (int i = 0; i < node->order_by.column_count; i++) {
+                    free(node->order_by.columns[i]);
+                }
+                free(node->order_by.columns);
+            }
+            free(node->order_by.descending);
+            free(node->order_by.nulls_first);
             break;
         case NODE_TYPE_GROUP_BY:
             if (node->group_by.columns) {
@@ -193,6 +201,7 @@ void releaseNode(ASTNode* node) {
         default:
             break;
     }
+    program_free(node->program);
     free(node);
 }
 
@@ -383,7 +392,12 @@ void printAst(ASTNode* node, int depth) {
             printf("%s\n", node->identifier);
             break;
         case NODE_TYPE_ORDER_BY:
-            printf("%s %s\n", node->order_by.column, node->order_by.descending ? "DESC" : "ASC");
+            for (int i = 0; i < node->order_by.column_count; i++) {
+                printf("%s%s %s NULLS %s", i > 0 ? ", " : "", node->order_by.columns[i],
+                       node->order_by.descending[i] ? "DESC" : "ASC",
+                       node->order_by.nulls_first[i] ? "FIRST" : "LAST");
+            }
+            printf("\n");
             break;
         case NODE_TYPE_FROM:
             printf("Table: %s", node->from.table);
@@ -36,10 +36,11 @@ ASTNode* parse_select(Parser* parser) {
     while (1) {
         Token* token = parser_current_token(parser);
         
-        // resize arrays if needed
+        // resize arrays if needed, both grow from the same capacity
+        int nodes_capacity = capacity;
         node->select.columns = ensure_capacity(node->select.columns, &capacity, 
                                                node->select.column_count, sizeof(char*));
-        node->select.column_nodes = ensure_capacity(node->select.column_nodes, &capacity, 
+        node->select.column_nodes = ensure_capacity(node->select.column_nodes, &nodes_capacity, 
                                                     node->select.column_count, sizeof(ASTNode*));
         
         // check for scalar subquery: SELECT ...
@@ -261,28 +262,73 @@ ASTNode* parse_order_by(Parser* parser) {
     }
     
     ASTNode* node = create_node(NODE_TYPE_ORDER_BY);
-    node->order_by.descending = false;
-    
-    // try to parse as function call first
-    char* func_str = build_function_string(parser);
-    if (func_str) {
-        node->order_by.column = func_str;
-    } else {
-        // parse as qualified identifier
-        node->order_by.column = parse_qualified_identifier(parser);
-    }
     
-    // check for ASC/DESC
-    Token* token = parser_current_token(parser);
-    if (token->type == TOKEN_TYPE_KEYWORD) {
-        if (strcasecmp(token->value, "DESC") == 0) {
-            node->order_by.descending = true;
-            parser_advance(parser);
-        } else if (strcasecmp(token->value, "ASC") == 0) {
-            node->order_by.descending = false;
-            parser_advance(parser);
+    // allocate arrays for the sort keys
+    int capacity = 4;
+    node->order_by.columns = malloc(sizeof(char*) * capacity);
+    node->order_by.descending = malloc(sizeof(bool) * capacity);
+    node->order_by.nulls_first = malloc(sizeof(bool) * capacity);
+    node->order_by.column_count = 0;
+    
+    // parse keys separated by commas
+    do {
+        if (node->order_by.column_count > 0) parser_advance(parser);
+        
+        // expand arrays if needed
+        if (node->order_by.column_count >= capacity) {
+            capacity *= 2;
+            node->order_by.columns = realloc(node->order_by.columns, sizeof(char*) * capacity);
+            node->order_by.descending = realloc(node->order_by.descending, sizeof(bool) * capacity);
+            node->order_by.nulls_first = realloc(node->order_by.nulls_first, sizeof(bool) * capacity);
         }
-    }
+        int key = node->order_by.column_count++;
+        
+        // try to parse as function call first
+        char* func_str = build_function_string(parser);
+        if (func_str) {
+            node->order_by.columns[key] = func_str;
+        } else {
+            // parse as qualified identifier
+            node->order_by.columns[key] = parse_qualified_identifier(parser);
+        }
+        
+        // not a key we can sort on, leave the rest to the caller
+        if (!node->order_by.columns[key]) {
+            node->order_by.column_count--;
+            break;
+        }
+        
+        // check for ASC/DESC
+        bool descending = false;
+        Token* token = parser_current_token(parser);
+        if (token->type == TOKEN_TYPE_KEYWORD) {
+            if (strcasecmp(token->value, "DESC") == 0) {
+                descending = true;
+                parser_advance(parser);
+            } else if (strcasecmp(token->value, "ASC") == 0) {
+                parser_advance(parser);
+            }
+        }
+        node->order_by.descending[key] = descending;
+        
+        // NULL sorts before every value unless NULLS FIRST/LAST says otherwise,
+        // NULLS, FIRST and LAST stay plain identifiers so they can still name columns
+        node->order_by.nulls_first[key] = !descending;
+        token = parser_current_token(parser);
+        Token* placement = parser_peek_token(parser, 1);
+        if (token->type == TOKEN_TYPE_IDENTIFIER && strcasecmp(token->value, "NULLS") == 0 &&
+            placement && placement->type == TOKEN_TYPE_IDENTIFIER) {
+            if (strcasecmp(placement->value, "FIRST") == 0) {
+                node->order_by.nulls_first[key] = true;
+                parser_advance(parser);
+                parser_advance(parser);
+            } else if (strcasecmp(placement->value, "LAST") == 0) {
+                node->order_by.nulls_first[key] = false;
+                parser_advance(parser);
+                parser_advance(parser);
+            }
+        }
+    } while (parser_match(parser, TOKEN_TYPE_PUNCTUATION, ","));
     
     return node;
 }
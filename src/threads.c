@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "threads.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+typedef struct {
+    ParallelTask task;
+    void* ctx;
+    int index;
+} TaskArgs;
+
+#if defined(_WIN32) || defined(_WIN64)
+
+static DWORD WINAPI task_entry(LPVOID arg)
+{
+    TaskArgs *args = (TaskArgs *)arg;
+    args->task(args->ctx, args->index);
+    return 0;
+}
+
+int cq_cpu_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+void cq_parallel_for(int count, ParallelTask task, void *ctx)
+{
+    if (count <= 0) return;
+
+    TaskArgs *args = malloc(sizeof(TaskArgs) * count);
+    HANDLE *handles = malloc(sizeof(HANDLE) * count);
+
+    // task 0 runs on the calling thread
+    for (int i = 1; i < count; i++)
+    {
+        args[i].task = task;
+        args[i].ctx = ctx;
+        args[i].index = i;
+        handles[i] = CreateThread(NULL, 0, task_entry, &args[i], 0, NULL);
+        if (!handles[i])
+            task(ctx, i);
+    }
+
+    task(ctx, 0);
+
+    for (int i = 1; i < count; i++)
+    {
+        if (handles[i])
+        {
+            WaitForSingleObject(handles[i], INFINITE);
+            CloseHandle(handles[i]);
+        }
+    }
+
+    free(handles);
+    free(args);
+}
+
+#else
+
+static void *task_entry(void *arg)
+{
+    TaskArgs *args = (TaskArgs *)arg;
+    args->task(args->ctx, args->index);
+    return NULL;
+}
+
+int cq_cpu_count(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+void cq_parallel_for(int count, ParallelTask task, void *ctx)
+{
+    if (count <= 0) return;
+
+    TaskArgs *args = malloc(sizeof(TaskArgs) * count);
+    pthread_t *threads = malloc(sizeof(pthread_t) * count);
+    bool *started = calloc(count, sizeof(bool));
+
+    // task 0 runs on the calling thread
+    for (int i = 1; i < count; i++)
+    {
+        args[i].task = task;
+        args[i].ctx = ctx;
+        args[i].index = i;
+        started[i] = pthread_create(&threads[i], NULL, task_entry, &args[i]) == 0;
+        if (!started[i])
+            task(ctx, i);
+    }
+
+    task(ctx, 0);
+
+    for (int i = 1; i < count; i++)
+    {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+    }
+
+    free(started);
+    free(threads);
+    free(args);
+}
+
+#endif
@@ -86,6 +86,29 @@ char* cq_strcasestr(const char* haystack, const char* needle) {
     return NULL;
 }
 
+/*
+ * cq_memmem - find a byte string in a memory block
+ * GNU extension, not available on Windows. memchr finds the candidates
+ * for the first byte, only those ending with the right byte are compared
+ */
+const char* cq_memmem(const char* haystack, size_t haystack_len, const char* needle, size_t needle_len) {
+    if (needle_len == 0) return haystack;
+    if (!haystack || needle_len > haystack_len) return NULL;
+    
+    const char* last = haystack + (haystack_len - needle_len);
+    const char* p = haystack;
+    while (p <= last) {
+        p = memchr(p, needle[0], (size_t)(last - p) + 1);
+        if (!p) return NULL;
+        if (p[needle_len - 1] == needle[needle_len - 1] && memcmp(p + 1, needle + 1, needle_len - 1) == 0) {
+            return p;
+        }
+        p++;
+    }
+    
+    return NULL;
+}
+
 
 /* function to skip whitespace characters in the input string
  * it returns a pointer to the next first non-whitespace character
@@ -108,6 +131,7 @@ void print_help(const char* program_name) {
     printf("  -s <char>    Field separator for input CSV (default: ',')\n");
     printf("  -d <char>    Output delimiter for -o option (default: ',')\n");
     printf("  -F, --force  Allow DELETE without WHERE clause (dangerous!)\n");
+    printf("  -t, --threads <n>  Threads used to load CSV files (default: 0 = one per cpu)\n");
     printf("\nExamples:\n");
     printf("  %s -q \"SELECT name, age WHERE age > 30\" -p\n", program_name);
     printf("  %s -f query.sql -p\n", program_name);
@@ -217,27 +241,21 @@ char* read_query_from_stdin(void) {
 }
 
 /* wsrite ResultSet to CSV file */
-void write_csv_file(const char* filename, ResultSet* result, char delimiter) {
-    FILE* f = fopen(filename, "w");
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open output file '%s'\n", filename);
-        return;
-    }
-    
-    // header
+void write_csv_header(FILE* f, ResultSet* result, char delimiter) {
     for (int i = 0; i < result->column_count; i++) {
         if (i > 0) fprintf(f, "%c", delimiter);
         fprintf(f, "%s", result->columns[i].name);
     }
     fprintf(f, "\n");
-    
-    // rows
+}
+
+void write_csv_rows(FILE* f, ResultSet* result, char delimiter) {
     for (int i = 0; i < result->row_count; i++) {
         Row* row = &result->rows[i];
         for (int j = 0; j < row->column_count; j++) {
             if (j > 0) fprintf(f, "%c", delimiter);
             
-            Value* val = &row->values[j];
+            const Value* val = row_value(row, j);
             switch (val->type) {
                 case VALUE_TYPE_NULL:
                     break;
@@ -256,19 +274,19 @@ void write_csv_file(const char* filename, ResultSet* result, char delimiter) {
                 case VALUE_TYPE_STRING: {
                     // check if string contains delimiter, newline, or quote char
                     bool needs_quoting = false;
-                    if (val->string_value) {
-                        for (const char* p = val->string_value; *p; p++) {
-                            if (*p == delimiter || *p == '"' || *p == '\n' || *p == '\r') {
-                                needs_quoting = true;
-                                break;
-                            }
+                    const char* str = val->string_value ? val->string_value : "";
+                    const char* str_end = str + (val->string_value ? val->string_length : 0);
+                    for (const char* p = str; p < str_end; p++) {
+                        if (*p == delimiter || *p == '"' || *p == '\n' || *p == '\r') {
+                            needs_quoting = true;
+                            break;
                         }
                     }
                     
                     if (needs_quoting) {
                         fprintf(f, "\"");
                         // escape quotes by doubling them
-                        for (const char* p = val->string_value; *p; p++) {
+                        for (const char* p = str; p < str_end; p++) {
                             if (*p == '"') {
                                 fprintf(f, "\"\"");
                             } else {
@@ -277,7 +295,7 @@ void write_csv_file(const char* filename, ResultSet* result, char delimiter) {
                         }
                         fprintf(f, "\"");
                     } else {
-                        fprintf(f, "%s", val->string_value ? val->string_value : "");
+                        fwrite(str, 1, str_end - str, f);
                     }
                     break;
                 }
@@ -285,6 +303,17 @@ void write_csv_file(const char* filename, ResultSet* result, char delimiter) {
         }
         fprintf(f, "\n");
     }
+}
+
+void write_csv_file(const char* filename, ResultSet* result, char delimiter) {
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open output file '%s'\n", filename);
+        return;
+    }
+    
+    write_csv_header(f, result, delimiter);
+    write_csv_rows(f, result, delimiter);
     
     fclose(f);
     printf("Result written to '%s'\n", filename);
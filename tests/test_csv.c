@@ -1,8 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "csv_reader.h"
+#include "csv_columns.h"
+#include "csv_scanner.h"
+
+/* strings of lazily loaded rows are borrowed from the file and not NUL terminated */
+static bool string_is(const Value* value, const char* expected) {
+    return value->type == VALUE_TYPE_STRING && value->string_length == strlen(expected) &&
+           memcmp(value->string_value, expected, value->string_length) == 0;
+}
 
 void test_csv_load() {
     printf("Running test_csv_load...\n");
@@ -30,16 +39,16 @@ void test_csv_values() {
     CsvTable* table = csv_load("data/test_data.csv", config);
     
     // check first row
-    Value* name = csv_get_value_by_name(table, 0, "name");
+    const Value* name = csv_get_value_by_name(table, 0, "name");
     assert(name != NULL);
     assert(name->type == VALUE_TYPE_STRING);
     
-    Value* age = csv_get_value_by_name(table, 0, "age");
+    const Value* age = csv_get_value_by_name(table, 0, "age");
     assert(age != NULL);
     assert(age->type == VALUE_TYPE_INTEGER);
     assert(age->int_value == 25);
     
-    Value* height = csv_get_value_by_name(table, 0, "height");
+    const Value* height = csv_get_value_by_name(table, 0, "height");
     assert(height != NULL);
     assert(height->type == VALUE_TYPE_DOUBLE);
     
@@ -80,6 +89,439 @@ void test_csv_print() {
     printf("✓ test_csv_print passed\n\n");
 }
 
+void test_csv_scanner() {
+    printf("Running test_csv_scanner...\n");
+    
+    // prefix xor marks the bytes between a pair of quotes
+    assert(prefix_xor(0x0) == 0x0);
+    assert(prefix_xor(0x9) == 0x7);
+    assert(prefix_xor((uint64_t)1 << 63) == (uint64_t)1 << 63);
+    
+    // a quoted field with delimiters that crosses the 64 byte block boundary
+    char line[200];
+    memset(line, 'x', sizeof(line));
+    memcpy(line, "a,", 2);
+    line[2] = '"';
+    line[70] = ',';
+    line[100] = '"';
+    line[101] = ',';
+    memcpy(line + 102, "b\r\nnext", 7);
+    
+    LineScan scan = {0};
+    size_t len = csv_scan_line(line, line + 109, ',', '"', &scan);
+    assert(len == 103);
+    assert(scan.has_quote);
+    assert(scan.separator_count == 2);
+    assert(scan.separators[0] == 1);
+    assert(scan.separators[1] == 101);
+    
+    // a line without terminator ends at the end of the buffer
+    len = csv_scan_line("1,2,3", "1,2,3" + 5, ',', '"', &scan);
+    assert(len == 5);
+    assert(!scan.has_quote);
+    assert(scan.separator_count == 2);
+    
+    line_scan_free(&scan);
+    printf("✓ test_csv_scanner passed (%s)\n\n", csv_scanner_kind());
+}
+
+void test_csv_quoted_fields() {
+    printf("Running test_csv_quoted_fields...\n");
+    
+    const char* filename = "data/test_quoted_fields.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,text,tail\n");
+    fprintf(f, "1,\"has, commas and a long tail that crosses the sixty four byte block, ok\",end\n");
+    fprintf(f, "2,\"say \"\"hi\"\"\",  spaced\n");
+    fprintf(f, "3,mid\"quote,x\n");
+    fprintf(f, "4,,\n");
+    fclose(f);
+    
+    CsvTable* table = csv_load(filename, csv_config_default());
+    assert(table != NULL);
+    assert(table->row_count == 4);
+    
+    assert(table->rows[0].column_count == 3);
+    assert(strcmp(table->rows[0].values[1].string_value,
+                  "has, commas and a long tail that crosses the sixty four byte block, ok") == 0);
+    assert(strcmp(table->rows[0].values[2].string_value, "end") == 0);
+    
+    // escaped quotes are kept as written, leading whitespace is skipped
+    assert(strcmp(table->rows[1].values[1].string_value, "say \"\"hi\"\"") == 0);
+    assert(strcmp(table->rows[1].values[2].string_value, "spaced") == 0);
+    
+    // a quote inside an unquoted field is literal
+    assert(table->rows[2].column_count == 3);
+    assert(strcmp(table->rows[2].values[1].string_value, "mid\"quote") == 0);
+    
+    // a trailing delimiter does not add a field
+    assert(table->rows[3].column_count == 2);
+    assert(table->rows[3].values[1].type == VALUE_TYPE_NULL);
+    
+    csv_free(table);
+    remove(filename);
+    printf("✓ test_csv_quoted_fields passed\n\n");
+}
+
+void test_csv_parallel_load() {
+    printf("Running test_csv_parallel_load...\n");
+    
+    // big enough to be split across workers, mixed line endings and blank lines
+    const char* filename = "data/test_parallel_load.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,name,score\n");
+    for (int i = 0; i < 400000; i++) {
+        fprintf(f, "%d,\"name %d, quoted\",%d.5%s", i, i, i % 100, (i % 3 == 0) ? "\r\n" : "\n");
+        if (i % 1000 == 0) fprintf(f, "\n");
+    }
+    fclose(f);
+    
+    CsvConfig config = csv_config_default();
+    config.threads = 1;
+    CsvTable* serial = csv_load(filename, config);
+    config.threads = 4;
+    CsvTable* parallel = csv_load(filename, config);
+    
+    assert(serial != NULL && parallel != NULL);
+    assert(serial->row_count == 400000);
+    assert(parallel->row_count == serial->row_count);
+    assert(parallel->column_count == serial->column_count);
+    
+    // rows come back in file order with identical values
+    for (int i = 0; i < serial->row_count; i++) {
+        assert(parallel->rows[i].column_count == serial->rows[i].column_count);
+        assert(parallel->rows[i].values[0].int_value == i);
+        assert(strcmp(parallel->rows[i].values[1].string_value, serial->rows[i].values[1].string_value) == 0);
+        assert(parallel->rows[i].values[2].double_value == serial->rows[i].values[2].double_value);
+    }
+    
+    csv_free(serial);
+    csv_free(parallel);
+    remove(filename);
+    printf("✓ test_csv_parallel_load passed\n\n");
+}
+
+void test_csv_lazy_load() {
+    printf("Running test_csv_lazy_load...\n");
+    
+    const char* filename = "data/test_lazy_load.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,name,score,joined\n");
+    fprintf(f, "1,\"Smith, John\",4.5,2024-01-15\n");
+    fprintf(f, "2,  Alice  ,,2023-12-01\n");
+    fprintf(f, "3,Bob\n");
+    fclose(f);
+    
+    CsvConfig config = csv_config_default();
+    CsvTable* eager = csv_load(filename, config);
+    config.lazy = true;
+    CsvTable* lazy = csv_load(filename, config);
+    
+    assert(eager != NULL && lazy != NULL);
+    assert(lazy->row_count == 3);
+    assert(eager->rows[0].spans == NULL);
+    assert(lazy->rows[0].spans != NULL);
+    assert(lazy->columns[2].inferred_type == eager->columns[2].inferred_type);
+    
+    // every field parses to the same value as an eager load
+    for (int i = 0; i < eager->row_count; i++) {
+        assert(lazy->rows[i].column_count == eager->rows[i].column_count);
+        for (int j = 0; j < eager->column_count; j++) {
+            const Value* a = csv_get_value(eager, i, j);
+            const Value* b = csv_get_value(lazy, i, j);
+            if (!a) {
+                // fields missing from a short line read as NULL
+                assert(b == NULL);
+                assert(row_value(&lazy->rows[i], j)->type == VALUE_TYPE_NULL);
+                continue;
+            }
+            assert(a->type == b->type);
+            if (a->type == VALUE_TYPE_STRING) {
+                assert(value_string_compare(a, b) == 0);
+                assert(b->borrowed && b->string_value >= lazy->data &&
+                       b->string_value + b->string_length <= lazy->data + lazy->file_size);
+            } else {
+                assert(value_compare(a, b) == 0);
+            }
+        }
+    }
+    
+    // values are cached, a second access returns the same value
+    assert(csv_get_value(lazy, 0, 1) == csv_get_value(lazy, 0, 1));
+    assert(string_is(csv_get_value(lazy, 1, 1), "Alice"));
+    
+    csv_free(eager);
+    csv_free(lazy);
+    remove(filename);
+    printf("✓ test_csv_lazy_load passed\n\n");
+}
+
+void test_csv_projection() {
+    printf("Running test_csv_projection...\n");
+    
+    const char* filename = "data/test_projection.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,name,age,first name\n");
+    fprintf(f, "1,Alice,30,Al\n");
+    fprintf(f, "2,Bob,25,Bo\n");
+    fclose(f);
+    
+    char* names[] = {"NAME"};
+    CsvConfig config = csv_config_default();
+    config.projection = names;
+    config.projection_count = 1;
+    
+    // both loading modes leave columns outside the projection as NULL
+    for (int lazy = 0; lazy <= 1; lazy++) {
+        config.lazy = lazy;
+        CsvTable* table = csv_load(filename, config);
+        assert(table != NULL);
+        assert(table->column_count == 4);
+        assert(table->row_count == 2);
+        
+        assert(csv_get_value(table, 0, 0)->type == VALUE_TYPE_NULL);
+        assert(string_is(csv_get_value(table, 0, 1), "Alice"));
+        assert(csv_get_value(table, 1, 2)->type == VALUE_TYPE_NULL);
+        
+        // names that are not plain identifiers are always loaded
+        assert(string_is(csv_get_value(table, 1, 3), "Bo"));
+        
+        csv_free(table);
+    }
+    
+    remove(filename);
+    printf("✓ test_csv_projection passed\n\n");
+}
+
+void test_csv_row_filters() {
+    printf("Running test_csv_row_filters...\n");
+    
+    const char* filename = "data/test_row_filters.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,name,age\n");
+    fprintf(f, "1,Alice,30\n");
+    fprintf(f, "2,alan,25\n");
+    fprintf(f, "3,Bob,41\n");
+    fprintf(f, "4,Al\n");
+    fclose(f);
+    
+    Value min_age = parse_value("26", 2);
+    Value pattern = parse_value("al%", 3);
+    Value ids[2] = { parse_value("1", 1), parse_value("4", 1) };
+    
+    RowFilter filters[3] = {
+        { .column = "name", .op = ROW_FILTER_ILIKE, .values = &pattern, .value_count = 1 },
+        { .column = "ID", .op = ROW_FILTER_IN, .values = ids, .value_count = 2 },
+        { .column = "missing", .op = ROW_FILTER_EQ, .values = &min_age, .value_count = 1 },
+    };
+    
+    CsvConfig config = csv_config_default();
+    config.filters = filters;
+    config.filter_count = 3;
+    
+    // filters on unknown columns are ignored, the others must all pass
+    for (int lazy = 0; lazy <= 1; lazy++) {
+        config.lazy = lazy;
+        CsvTable* table = csv_load(filename, config);
+        assert(table != NULL);
+        assert(table->row_count == 2);
+        assert(table->filters == NULL);
+        assert(csv_get_value(table, 0, 0)->int_value == 1);
+        assert(csv_get_value(table, 1, 0)->int_value == 4);
+        csv_free(table);
+    }
+    
+    // a field missing from a short line compares as NULL, which sorts first
+    RowFilter below = { .column = "age", .op = ROW_FILTER_LT, .values = &min_age, .value_count = 1 };
+    config.filters = &below;
+    config.filter_count = 1;
+    CsvTable* table = csv_load(filename, config);
+    assert(table != NULL);
+    assert(table->row_count == 2);
+    assert(csv_get_value(table, 0, 0)->int_value == 2);
+    assert(csv_get_value(table, 1, 0)->int_value == 4);
+    csv_free(table);
+    
+    value_free(&pattern);
+    remove(filename);
+    printf("✓ test_csv_row_filters passed\n\n");
+}
+
+void test_csv_cursor() {
+    printf("Running test_csv_cursor...\n");
+    
+    // several batches worth of rows, with blank lines and rows a filter drops
+    const char* filename = "data/test_cursor.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,name,score\n");
+    for (int i = 0; i < 50000; i++) {
+        fprintf(f, "%d,\"name %d, quoted\",%d\n", i, i, i % 10);
+        if (i % 1000 == 0) fprintf(f, "\r\n");
+    }
+    fclose(f);
+    
+    Value zero = parse_value("0", 1);
+    RowFilter filter = { .column = "score", .op = ROW_FILTER_NE, .values = &zero, .value_count = 1 };
+    
+    CsvConfig config = csv_config_default();
+    config.lazy = true;
+    config.filters = &filter;
+    config.filter_count = 1;
+    
+    CsvCursor* cursor = csv_cursor_open(filename, config);
+    assert(cursor != NULL);
+    
+    CsvTable* table = csv_cursor_table(cursor);
+    assert(table->column_count == 3);
+    assert(strcmp(table->columns[1].name, "name") == 0);
+    
+    // rows come back in file order across batches, each batch replacing the previous one
+    int batches = 0;
+    int expected = 0;
+    while (csv_cursor_next(cursor) > 0) {
+        batches++;
+        for (int i = 0; i < table->row_count; i++) {
+            if (expected % 10 == 0) expected++;
+            assert(row_value(&table->rows[i], 0)->int_value == expected);
+            assert(row_value(&table->rows[i], 2)->int_value == expected % 10);
+            expected++;
+        }
+    }
+    
+    assert(batches > 1);
+    assert(expected == 50000);
+    assert(csv_cursor_next(cursor) == 0);
+    
+    csv_cursor_close(cursor);
+    remove(filename);
+    printf("✓ test_csv_cursor passed\n\n");
+}
+
+void test_csv_arena() {
+    printf("Running test_csv_arena...\n");
+    
+    // small requests share a block, big ones get their own, merged arenas keep both
+    Arena* arena = arena_create();
+    Arena* other = arena_create();
+    char* a = arena_strndup(arena, "hello world", 5);
+    long long* big = arena_calloc(other, 1 << 20, sizeof(long long));
+    assert(strcmp(a, "hello") == 0);
+    assert(((size_t)big % sizeof(long long)) == 0 && big[(1 << 20) - 1] == 0);
+    
+    arena_merge(arena, other);
+    arena_free(other);
+    big[0] = 42;
+    assert(strcmp(a, "hello") == 0 && big[0] == 42);
+    arena_free(arena);
+    
+    // loaded tables own their values through an arena, editable ones malloc them
+    const char* filename = "data/test_arena.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,name\n");
+    for (int i = 0; i < 1000; i++) fprintf(f, "%d,  name %d  \n", i, i);
+    fclose(f);
+    
+    CsvConfig config = csv_config_default();
+    config.lazy = true;
+    CsvTable* table = csv_load(filename, config);
+    assert(table != NULL && table->arena != NULL);
+    assert(string_is(row_value(&table->rows[999], 1), "name 999"));
+    
+    // values stored into a table are owned by it and freed with it
+    Value* values = csv_alloc_values(table, 2);
+    csv_store_value(table, &values[0], parse_value("stored", 6));
+    csv_copy_value(table, &values[1], row_value(&table->rows[0], 1));
+    assert(strcmp(values[0].string_value, "stored") == 0);
+    assert(strcmp(values[1].string_value, "name 0") == 0);
+    assert(values[1].string_value != row_value(&table->rows[0], 1)->string_value);
+    csv_free(table);
+    
+    config.lazy = false;
+    config.editable = true;
+    table = csv_load(filename, config);
+    assert(table != NULL && table->arena == NULL);
+    
+    Value* name = &table->rows[5].values[1];
+    assert(strcmp(name->string_value, "name 5") == 0);
+    value_free(name);
+    *name = parse_value("edited", 6);
+    assert(strcmp(csv_get_value(table, 5, 1)->string_value, "edited") == 0);
+    
+    csv_free(table);
+    remove(filename);
+    printf("✓ test_csv_arena passed\n\n");
+}
+
+void test_csv_columns() {
+    printf("Running test_csv_columns...\n");
+    
+    const char* filename = "data/test_columns.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,score,name,joined,mixed\n");
+    fprintf(f, "1,4,alpha,2024-01-15,1\n");
+    fprintf(f, "2,,  beta  ,,x\n");
+    fprintf(f, "3,2.5,gamma,2023-12-01,\n");
+    fprintf(f, "4\n");
+    fclose(f);
+    
+    CsvConfig config = csv_config_default();
+    config.lazy = true;
+    config.columnar = true;
+    CsvTable* table = csv_load(filename, config);
+    assert(table != NULL && table->vectors != NULL);
+    
+    // integers are stored as they are
+    const ColumnVector* ids = table->vectors[0];
+    assert(ids->typed && ids->type == VALUE_TYPE_INTEGER && ids->length == 4);
+    assert(ids->null_count == 0 && ids->ints[3] == 4);
+    
+    // integers next to doubles are widened, empty and missing fields are NULL
+    const ColumnVector* scores = table->vectors[1];
+    assert(scores->typed && scores->type == VALUE_TYPE_DOUBLE);
+    assert(scores->doubles[0] == 4.0 && scores->doubles[2] == 2.5);
+    assert(column_vector_valid(scores, 0) && !column_vector_valid(scores, 1));
+    assert(!column_vector_valid(scores, 3) && scores->null_count == 2);
+    assert(column_vector_compare(scores, 0, 2) > 0);
+    
+    // strings are trimmed and borrowed from the file data
+    const ColumnVector* names = table->vectors[2];
+    assert(names->typed && names->type == VALUE_TYPE_STRING);
+    assert(names->strings[1].length == 4 && memcmp(names->strings[1].data, "beta", 4) == 0);
+    assert(names->strings[1].data >= table->data && names->strings[1].data < table->data + table->file_size);
+    Value gamma = parse_value("gamma", 5);
+    assert(column_vector_compare_value(names, 0, &gamma) < 0);
+    assert(column_vector_compare_value(names, 2, &gamma) == 0);
+    value_free(&gamma);
+    
+    const ColumnVector* joined = table->vectors[3];
+    assert(joined->typed && joined->type == VALUE_TYPE_DATE);
+    assert(joined->dates[2].year == 2023 && joined->dates[2].month == 12);
+    assert(column_vector_compare(joined, 0, 2) > 0);
+    
+    // a column mixing numbers and strings keeps no vector data
+    const ColumnVector* mixed = table->vectors[4];
+    assert(!mixed->typed && mixed->data == NULL);
+    
+    // vectors are cached until the rows change
+    assert(csv_column_vector(table, 1) == scores);
+    assert(csv_column_vector(table, 5) == NULL);
+    csv_drop_column_vectors(table);
+    assert(table->vectors == NULL);
+    assert(csv_column_vector(table, 1)->type == VALUE_TYPE_DOUBLE);
+    
+    csv_free(table);
+    remove(filename);
+    printf("✓ test_csv_columns passed\n\n");
+}
+
 int main(void) {
     printf("=== CSV Reader Test Suite ===\n\n");
     
@@ -87,6 +529,15 @@ int main(void) {
     test_csv_values();
     test_csv_no_header();
     test_csv_print();
+    test_csv_scanner();
+    test_csv_quoted_fields();
+    test_csv_parallel_load();
+    test_csv_lazy_load();
+    test_csv_projection();
+    test_csv_row_filters();
+    test_csv_cursor();
+    test_csv_arena();
+    test_csv_columns();
     
     printf("=== All CSV tests passed! ===\n");
     return 0;
@@ -232,7 +232,7 @@ void test_csv_date_autodetect(void) {
     ASSERT_EQUAL(VALUE_TYPE_DATE, table->columns[created_at_col].inferred_type);
     
     // check first row has date values
-    Value* val = csv_get_value(table, 0, event_date_col);
+    const Value* val = csv_get_value(table, 0, event_date_col);
     ASSERT_NOT_NULL(val);
     
     // Debug output
@@ -152,6 +152,51 @@ void test_distinct_with_limit() {
     printf("  PASSED\n\n");
 }
 
+void test_distinct_nulls_and_order() {
+    printf("Test: SELECT DISTINCT with NULLs keeps first occurrences...\n");
+    
+    FILE* f = fopen("test_distinct_nulls.csv", "w");
+    fprintf(f, "name,score\n");
+    fprintf(f, "b,\n");
+    fprintf(f, "a,1\n");
+    fprintf(f, "b,\n");
+    fprintf(f, ",1.0\n");
+    fprintf(f, "a,1.0\n");
+    fprintf(f, ",1\n");
+    fprintf(f, "12,x\n");
+    fprintf(f, "abc,x\n");
+    for (int i = 0; i < 1000; i++) {
+        fprintf(f, "k%d,%d\n", i % 37, i % 37);
+    }
+    fclose(f);
+    
+    const char* query = "SELECT DISTINCT name, score FROM test_distinct_nulls.csv";
+    ASTNode* ast = parse(query);
+    assert(ast != NULL);
+    
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    // NULLs match each other, 1 and 1.0 are the same number, a number never equals a string
+    assert(result->row_count == 5 + 37);
+    
+    assert(strcmp(result->rows[0].values[0].string_value, "b") == 0);
+    assert(result->rows[0].values[1].type == VALUE_TYPE_NULL);
+    assert(strcmp(result->rows[1].values[0].string_value, "a") == 0);
+    assert(result->rows[2].values[0].type == VALUE_TYPE_NULL);
+    assert(result->rows[3].values[0].type == VALUE_TYPE_INTEGER);
+    assert(strcmp(result->rows[4].values[0].string_value, "abc") == 0);
+    for (int i = 0; i < 37; i++) {
+        assert(result->rows[5 + i].values[1].int_value == i);
+    }
+    printf("  Result has %d rows\n", result->row_count);
+    
+    csv_free(result);
+    releaseNode(ast);
+    
+    remove("test_distinct_nulls.csv");
+    printf("  PASSED\n\n");
+}
+
 int main() {
     printf("=== DISTINCT Functionality Tests ===\n\n");
     
@@ -159,6 +204,7 @@ int main() {
     test_distinct_single_column();
     test_distinct_with_order_by();
     test_distinct_with_limit();
+    test_distinct_nulls_and_order();
     
     printf("=== All DISTINCT tests passed! ===\n");
     return 0;
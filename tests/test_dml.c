@@ -44,12 +44,12 @@ void test_insert_all_columns() {
     ASSERT_EQUAL(3, table->row_count);
     
     // check the new row
-    Value* name = csv_get_value_by_name(table, 2, "name");
+    const Value* name = csv_get_value_by_name(table, 2, "name");
     ASSERT_NOT_NULL(name);
     ASSERT_TRUE(name->type == VALUE_TYPE_STRING);
     ASSERT_TRUE(strcmp(name->string_value, "Charlie") == 0);
     
-    Value* age = csv_get_value_by_name(table, 2, "age");
+    const Value* age = csv_get_value_by_name(table, 2, "age");
     ASSERT_NOT_NULL(age);
     ASSERT_EQUAL(35, age->int_value);
     
@@ -111,12 +111,12 @@ void test_update_single_column() {
     CsvTable* table = csv_load(test_file, config);
     ASSERT_NOT_NULL(table);
     
-    Value* age = csv_get_value_by_name(table, 0, "age");
+    const Value* age = csv_get_value_by_name(table, 0, "age");
     ASSERT_NOT_NULL(age);
     ASSERT_EQUAL(26, age->int_value);
     
     // verify other rows unchanged
-    Value* age2 = csv_get_value_by_name(table, 1, "age");
+    const Value* age2 = csv_get_value_by_name(table, 1, "age");
     ASSERT_EQUAL(30, age2->int_value);
     
     csv_free(table);
@@ -147,10 +147,10 @@ void test_update_multiple_columns() {
     CsvTable* table = csv_load(test_file, config);
     ASSERT_NOT_NULL(table);
     
-    Value* age = csv_get_value_by_name(table, 1, "age");
+    const Value* age = csv_get_value_by_name(table, 1, "age");
     ASSERT_EQUAL(31, age->int_value);
     
-    Value* role = csv_get_value_by_name(table, 1, "role");
+    const Value* role = csv_get_value_by_name(table, 1, "role");
     ASSERT_TRUE(strcmp(role->string_value, "admin") == 0);
     
     csv_free(table);
@@ -182,7 +182,7 @@ void test_update_all_rows() {
     ASSERT_NOT_NULL(table);
     
     for (int i = 0; i < table->row_count; i++) {
-        Value* active = csv_get_value_by_name(table, i, "active");
+        const Value* active = csv_get_value_by_name(table, i, "active");
         ASSERT_EQUAL(1, active->int_value);
     }
     
@@ -217,7 +217,7 @@ void test_delete_simple() {
     
     // verify Charlie (age 35) was deleted
     for (int i = 0; i < table->row_count; i++) {
-        Value* name = csv_get_value_by_name(table, i, "name");
+        const Value* name = csv_get_value_by_name(table, i, "name");
         ASSERT_TRUE(strcmp(name->string_value, "Charlie") != 0);
     }
     
@@ -251,8 +251,8 @@ void test_delete_complex_condition() {
     ASSERT_EQUAL(2, table->row_count);
     
     // should have Alice and Diana (both have active=1)
-    Value* name1 = csv_get_value_by_name(table, 0, "name");
-    Value* name2 = csv_get_value_by_name(table, 1, "name");
+    const Value* name1 = csv_get_value_by_name(table, 0, "name");
+    const Value* name2 = csv_get_value_by_name(table, 1, "name");
     ASSERT_TRUE(strcmp(name1->string_value, "Alice") == 0 || strcmp(name2->string_value, "Alice") == 0);
     ASSERT_TRUE(strcmp(name1->string_value, "Diana") == 0 || strcmp(name2->string_value, "Diana") == 0);
     
@@ -293,10 +293,10 @@ void test_dml_sequence() {
     ASSERT_NOT_NULL(table);
     ASSERT_EQUAL(1, table->row_count);
     
-    Value* name = csv_get_value_by_name(table, 0, "name");
+    const Value* name = csv_get_value_by_name(table, 0, "name");
     ASSERT_TRUE(strcmp(name->string_value, "Bob") == 0);
     
-    Value* score = csv_get_value_by_name(table, 0, "score");
+    const Value* score = csv_get_value_by_name(table, 0, "score");
     ASSERT_EQUAL(95, score->int_value);
     
     csv_free(table);
@@ -6,6 +6,8 @@
 #include "evaluator.h"
 #include "parser.h"
 #include "csv_reader.h"
+#include "evaluator/evaluator_expressions.h"
+#include "evaluator/evaluator_conditions.h"
 
 void test_simple_select() {
     printf("Running test_simple_select...\n");
@@ -185,6 +187,692 @@ void test_group_by_count() {
     printf("✓ test_group_by_count passed\n\n");
 }
 
+void test_group_by_multi_column() {
+    printf("Running test_group_by_multi_column...\n");
+    
+    const char* sql = "SELECT role, active, COUNT(*) AS count FROM 'data/test_data.csv' GROUP BY role, active";
+    ASTNode* ast = parse(sql);
+    
+    ResultSet* result = evaluate_query(ast);
+    
+    assert(result != NULL);
+    printf("Result: %d rows, %d columns\n", result->row_count, result->column_count);
+    csv_print_table(result, 10);
+    
+    // 5 distinct (role, active) pairs in first-seen order
+    assert(result->row_count == 5);
+    assert(strcmp(result->rows[0].values[0].string_value, "admin") == 0);
+    assert(result->rows[0].values[1].int_value == 1);
+    assert(result->rows[0].values[2].int_value == 2);
+    assert(strcmp(result->rows[3].values[0].string_value, "user") == 0);
+    assert(result->rows[3].values[1].int_value == 0);
+    assert(result->rows[3].values[2].int_value == 1);
+    
+    csv_free(result);
+    releaseNode(ast);
+    printf("✓ test_group_by_multi_column passed\n\n");
+}
+
+void test_projected_columns() {
+    printf("Running test_projected_columns...\n");
+    
+    // age and role are only used by the WHERE clause and must still be loaded
+    const char* sql = "SELECT name FROM 'data/test_data.csv' WHERE age > 30 AND role = 'admin'";
+    ASTNode* ast = parse(sql);
+    
+    ResultSet* result = evaluate_query(ast);
+    
+    assert(result != NULL);
+    assert(result->row_count == 1);
+    assert(result->column_count == 1);
+    assert(strcmp(result->rows[0].values[0].string_value, "Eve") == 0);
+    
+    csv_free(result);
+    releaseNode(ast);
+    
+    // columns referenced only by an aggregate argument and the GROUP BY
+    sql = "SELECT role, MAX(height) AS tallest FROM 'data/test_data.csv' WHERE active = 1 GROUP BY role";
+    ast = parse(sql);
+    result = evaluate_query(ast);
+    
+    assert(result != NULL);
+    assert(strcmp(result->rows[0].values[0].string_value, "admin") == 0);
+    assert(result->rows[0].values[1].double_value == 175.8);
+    
+    csv_free(result);
+    releaseNode(ast);
+    printf("✓ test_projected_columns passed\n\n");
+}
+
+void test_where_pushdown() {
+    printf("Running test_where_pushdown...\n");
+    
+    // every conjunct can be checked while loading, the qualified one through the table alias
+    const char* sql = "SELECT name FROM 'data/test_data.csv' AS t "
+                      "WHERE t.age >= 30 AND name LIKE 'G%' AND role IN ('moderator', 'admin')";
+    ASTNode* ast = parse(sql);
+    
+    ResultSet* result = evaluate_query(ast);
+    
+    assert(result != NULL);
+    assert(result->row_count == 1);
+    assert(strcmp(result->rows[0].values[0].string_value, "Grace") == 0);
+    
+    csv_free(result);
+    releaseNode(ast);
+    printf("✓ test_where_pushdown passed\n\n");
+}
+
+void test_columnar_operators() {
+    printf("Running test_columnar_operators...\n");
+    
+    // comparisons under OR run over the column vectors, the sort on the typed age column
+    const char* sql = "SELECT name, age FROM 'data/test_data.csv' "
+                      "WHERE age >= 30 OR 'Alice' = name ORDER BY age DESC";
+    ASTNode* ast = parse(sql);
+    
+    ResultSet* result = evaluate_query(ast);
+    
+    assert(result != NULL);
+    assert(result->row_count == 5);
+    const char* expected[] = { "Eve", "Charlie", "Grace", "Bob", "Alice" };
+    for (int i = 0; i < 5; i++) {
+        assert(strcmp(result->rows[i].values[0].string_value, expected[i]) == 0);
+    }
+    
+    csv_free(result);
+    releaseNode(ast);
+    
+    // aggregates read the same vectors, MIN and MAX keep the value of the row
+    ast = parse("SELECT SUM(age), MIN(height), MAX(name) FROM 'data/test_data.csv' WHERE role IN ('user', 'admin')");
+    result = evaluate_query(ast);
+    
+    assert(result != NULL && result->row_count == 1);
+    assert(result->rows[0].values[0].type == VALUE_TYPE_DOUBLE);
+    assert(result->rows[0].values[0].double_value == 144.0);
+    assert(result->rows[0].values[1].type == VALUE_TYPE_DOUBLE);
+    assert(result->rows[0].values[1].double_value == 165.5);
+    assert(strcmp(result->rows[0].values[2].string_value, "Frank") == 0);
+    
+    csv_free(result);
+    releaseNode(ast);
+    printf("✓ test_columnar_operators passed\n\n");
+}
+
+static int count_rows(const char* sql) {
+    ASTNode* ast = parse(sql);
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    int row_count = result->row_count;
+    csv_free(result);
+    releaseNode(ast);
+    return row_count;
+}
+
+void test_batch_where() {
+    printf("Running test_batch_where...\n");
+    
+    // enough rows for several batches, every seventh value is NULL
+    const char* filename = "data/test_batch_where.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,v,tag\n");
+    for (int i = 0; i < 3000; i++) {
+        if (i % 7 == 0) fprintf(f, "%d,,%s\n", i, i % 2 ? "odd" : "even");
+        else fprintf(f, "%d,%d,%s\n", i, i % 100, i % 2 ? "odd" : "even");
+    }
+    fclose(f);
+    
+    int expected_arith = 0, expected_not = 0, expected_mixed = 0;
+    for (int i = 0; i < 3000; i++) {
+        bool null_v = i % 7 == 0;
+        int v = i % 100;
+        if ((!null_v && v * 2 > 150) || i % 1000 == 999) expected_arith++;
+        // NULL sorts before every number, so NOT (v < 10) rejects it
+        if (!null_v && !(v < 10)) expected_not++;
+        if (!null_v && v % 3 == 1 && i % 2 == 1 && i >= 1000) expected_mixed++;
+    }
+    
+    assert(count_rows("SELECT id FROM 'data/test_batch_where.csv' WHERE v * 2 > 150 OR id % 1000 = 999") ==
+           expected_arith);
+    assert(count_rows("SELECT id FROM 'data/test_batch_where.csv' WHERE NOT v < 10") == expected_not);
+    
+    // LIKE is evaluated row by row, only on the rows the comparisons before it kept
+    assert(count_rows("SELECT id FROM 'data/test_batch_where.csv' "
+                      "WHERE v % 3 = 1 AND tag LIKE 'o%' AND 1000 <= id") == expected_mixed);
+    
+    remove(filename);
+    printf("✓ test_batch_where passed\n\n");
+}
+
+void test_column_binding() {
+    printf("Running test_column_binding...\n");
+    
+    // u.id and o.customer_id bind to different tables in ON, then to the joined columns in WHERE
+    const char* join_sql = "SELECT u.name FROM 'data/users.csv' u JOIN 'data/orders.csv' o "
+                           "ON u.id = o.customer_id WHERE o.price > 50 AND u.age >= 25";
+    ASTNode* ast = parse(join_sql);
+    
+    // evaluating the same AST again binds it again for the new tables
+    for (int run = 0; run < 2; run++) {
+        ResultSet* result = evaluate_query(ast);
+        assert(result != NULL);
+        assert(result->row_count == 4);
+        assert(strcmp(result->rows[3].values[0].string_value, "Charlie") == 0);
+        csv_free(result);
+    }
+    releaseNode(ast);
+    
+    // t.city reads the outer row, which changes between evaluations of the subquery
+    const char* correlated_sql = "SELECT name FROM 'data/users.csv' t WHERE age > "
+                                 "(SELECT AVG(age) FROM 'data/users.csv' x WHERE x.city = t.city)";
+    ast = parse(correlated_sql);
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 5);
+    assert(strcmp(result->rows[0].values[0].string_value, "Charlie") == 0);
+    assert(strcmp(result->rows[4].values[0].string_value, "John") == 0);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // a name missing from the table binds to the SELECT expression with that alias
+    ast = parse("SELECT name, age + 1 AS next FROM 'data/users.csv' WHERE next > 31");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 5);
+    assert(result->rows[0].values[1].int_value == 36);
+    csv_free(result);
+    releaseNode(ast);
+    
+    printf("✓ test_column_binding passed\n\n");
+}
+
+void test_compiled_expressions() {
+    printf("Running test_compiled_expressions...\n");
+    
+    CsvTable* table = csv_load("data/users.csv", csv_config_default());
+    assert(table != NULL);
+    
+    QueryContext* ctx = context_create(NULL);
+    ctx->table_count = 1;
+    ctx->tables = malloc(sizeof(TableRef));
+    ctx->tables[0].alias = strdup("u");
+    ctx->tables[0].table = table;
+    
+    // every program has to give what walking the tree gives, row by row
+    const char* sql = "SELECT -age + 1, age * height / 3, age % 7 & 3, id ^ 5 | 8, age / 0, "
+                      "CASE WHEN age > 30 THEN UPPER(name) WHEN city = 'NYC' THEN 'ny' END, "
+                      "CASE role WHEN 'admin' THEN LOWER(CONCAT(name, '!')) ELSE +name END, "
+                      "ROUND(height / 10, 1), COALESCE(email, 'none'), LENGTH(name) * 2, NOSUCH(age) "
+                      "FROM 'data/users.csv' u "
+                      "WHERE (age > 25 AND NOT role = 'admin') OR name IN ('Alice', UPPER('bob')) "
+                      "OR city LIKE 'B%' OR u.email ILIKE '%EXAMPLE%'";
+    ASTNode* ast = parse(sql);
+    assert(ast != NULL);
+    ASTNode* select = ast->query.select;
+    ASTNode* where = ast->query.where;
+    
+    int matched = 0;
+    for (int r = 0; r < table->row_count; r++) {
+        Row* row = &table->rows[r];
+        for (int c = 0; c < select->select.column_count; c++) {
+            Value compiled = evaluate_expression(ctx, select->select.column_nodes[c], row, 0);
+            Value walked = evaluate_expression_tree(ctx, select->select.column_nodes[c], row, 0);
+            assert(compiled.type == walked.type);
+            assert(value_compare(&compiled, &walked) == 0);
+            value_free(&compiled);
+            value_free(&walked);
+        }
+        
+        bool compiled = evaluate_condition(ctx, where, row, 0);
+        assert(compiled == evaluate_condition_tree(ctx, where, row, 0));
+        if (compiled) matched++;
+    }
+    assert(matched > 0 && matched < table->row_count);
+    
+    releaseNode(ast);
+    context_free(ctx);
+    printf("✓ test_compiled_expressions passed\n\n");
+}
+
+void test_constant_folding() {
+    printf("Running test_constant_folding...\n");
+    
+    CsvTable* table = csv_load("data/users.csv", csv_config_default());
+    assert(table != NULL);
+    
+    QueryContext* ctx = context_create(NULL);
+    ctx->table_count = 1;
+    ctx->tables = malloc(sizeof(TableRef));
+    ctx->tables[0].alias = strdup("u");
+    ctx->tables[0].table = table;
+    
+    // folded subtrees have to give what walking them gives on every row
+    const char* sql = "SELECT height * (1 + 0.22), -(2 * 3) + age, UPPER(CONCAT('a', 'b')), "
+                      "DATE_ADD('2024-01-01', 30, 'DAY'), YEAR('2024-03-05') + age, 'plain', 42, "
+                      "CASE WHEN 1 = 2 THEN 'never' WHEN age > 30 THEN 'old' ELSE LOWER('YOUNG') END, "
+                      "CASE WHEN 2 > 1 THEN name ELSE 'unreached' END, CASE 'x' WHEN 'y' THEN 1 ELSE 2 END, "
+                      "CASE 3 WHEN age THEN 'three' WHEN 3 THEN 'folded' END "
+                      "FROM 'data/users.csv' u "
+                      "WHERE (1 = 1 AND age > 20 + 5) OR (1 = 0 AND name = 'Alice') OR NOT 2 IN (1, 3) "
+                      "AND 'abc' LIKE 'a%' AND city = 'NYC'";
+    ASTNode* ast = parse(sql);
+    assert(ast != NULL);
+    ASTNode* select = ast->query.select;
+    ASTNode* where = ast->query.where;
+    
+    int matched = 0;
+    for (int r = 0; r < table->row_count; r++) {
+        Row* row = &table->rows[r];
+        for (int c = 0; c < select->select.column_count; c++) {
+            Value compiled = evaluate_expression(ctx, select->select.column_nodes[c], row, 0);
+            Value walked = evaluate_expression_tree(ctx, select->select.column_nodes[c], row, 0);
+            assert(compiled.type == walked.type);
+            assert(value_compare(&compiled, &walked) == 0);
+            value_free(&compiled);
+            value_free(&walked);
+        }
+        
+        bool compiled = evaluate_condition(ctx, where, row, 0);
+        assert(compiled == evaluate_condition_tree(ctx, where, row, 0));
+        if (compiled) matched++;
+    }
+    assert(matched > 0 && matched < table->row_count);
+    
+    // a folded string is computed once and lent to every row
+    Value first = evaluate_expression(ctx, select->select.column_nodes[2], &table->rows[0], 0);
+    Value second = evaluate_expression(ctx, select->select.column_nodes[2], &table->rows[1], 0);
+    assert(first.type == VALUE_TYPE_STRING && strcmp(first.string_value, "AB") == 0);
+    assert(first.borrowed && first.string_value == second.string_value);
+    
+    releaseNode(ast);
+    context_free(ctx);
+    printf("✓ test_constant_folding passed\n\n");
+}
+
+void test_in_subquery() {
+    printf("Running test_in_subquery...\n");
+    
+    // one NULL among the allowed ids
+    const char* filename = "data/test_in_subquery.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "v,k\n1,a\n,b\n3,c\n3,d\n");
+    fclose(f);
+    
+    assert(count_rows("SELECT name FROM 'data/users.csv' WHERE id IN "
+                      "(SELECT customer_id FROM 'data/orders.csv')") == 3);
+    assert(count_rows("SELECT name FROM 'data/users.csv' WHERE id IN "
+                      "(SELECT v FROM 'data/test_in_subquery.csv')") == 2);
+    
+    // the NULL in the subquery matches no id, NOT IN keeps every id but 1 and 3
+    assert(count_rows("SELECT name FROM 'data/users.csv' WHERE id NOT IN "
+                      "(SELECT v FROM 'data/test_in_subquery.csv')") == 8);
+    assert(count_rows("SELECT name FROM 'data/users.csv' WHERE id NOT IN "
+                      "(SELECT v FROM 'data/test_in_subquery.csv' WHERE v > 1)") == 9);
+    
+    // a correlated subquery sees the outer row, orders above three times the age of their customer
+    ASTNode* ast = parse("SELECT name FROM 'data/users.csv' u WHERE id IN "
+                         "(SELECT customer_id FROM 'data/orders.csv' o WHERE o.price > u.age * 3)");
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 2);
+    assert(strcmp(result->rows[0].values[0].string_value, "Alice") == 0);
+    assert(strcmp(result->rows[1].values[0].string_value, "Charlie") == 0);
+    csv_free(result);
+    releaseNode(ast);
+    
+    remove(filename);
+    printf("✓ test_in_subquery passed\n\n");
+}
+
+/* helper: both queries give the same first column, row by row */
+static void assert_same_rows(const char* sql, const char* other_sql) {
+    ASTNode* ast = parse(sql);
+    ResultSet* result = evaluate_query(ast);
+    ASTNode* other_ast = parse(other_sql);
+    ResultSet* other = evaluate_query(other_ast);
+    assert(result != NULL && other != NULL);
+    assert(result->row_count == other->row_count);
+    for (int i = 0; i < result->row_count; i++) {
+        assert(value_compare(&result->rows[i].values[0], &other->rows[i].values[0]) == 0);
+    }
+    csv_free(result);
+    csv_free(other);
+    releaseNode(ast);
+    releaseNode(other_ast);
+}
+
+void test_in_list_and_subquery() {
+    printf("Running test_in_list_and_subquery...\n");
+    
+    const char* filename = "data/test_in_list.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,g,v,t\n1,10,1,a\n2,20,2,b\n3,10,9,c\n4,,7,d\n5,30,3,e\n6,20,,f\n7,,8,g\n");
+    fclose(f);
+    
+    // the subquery WHERE v > 6 holds g = 10, NULL, NULL and WHERE g = 20 holds v = 2, NULL
+    assert(count_rows("SELECT id FROM 'data/test_in_list.csv' WHERE g IN (10, NULL)") == 4);
+    assert_same_rows("SELECT id FROM 'data/test_in_list.csv' WHERE g IN (10, NULL)",
+                     "SELECT id FROM 'data/test_in_list.csv' WHERE g IN "
+                     "(SELECT g FROM 'data/test_in_list.csv' WHERE v > 6)");
+    assert(count_rows("SELECT id FROM 'data/test_in_list.csv' WHERE g NOT IN (10, NULL)") == 3);
+    assert_same_rows("SELECT id FROM 'data/test_in_list.csv' WHERE g NOT IN (10, NULL)",
+                     "SELECT id FROM 'data/test_in_list.csv' WHERE g NOT IN "
+                     "(SELECT g FROM 'data/test_in_list.csv' WHERE v > 6)");
+    assert(count_rows("SELECT id FROM 'data/test_in_list.csv' WHERE v NOT IN (2, NULL)") == 5);
+    assert_same_rows("SELECT id FROM 'data/test_in_list.csv' WHERE v NOT IN (2, NULL)",
+                     "SELECT id FROM 'data/test_in_list.csv' WHERE v NOT IN "
+                     "(SELECT v FROM 'data/test_in_list.csv' WHERE g = 20)");
+    assert_same_rows("SELECT id FROM 'data/test_in_list.csv' WHERE v IN (2, NULL)",
+                     "SELECT id FROM 'data/test_in_list.csv' WHERE v IN "
+                     "(SELECT v FROM 'data/test_in_list.csv' WHERE g = 20)");
+    
+    // a string against numbers matches the way value_compare finds them equal
+    assert_same_rows("SELECT id FROM 'data/test_in_list.csv' WHERE g IN ('a', 99)",
+                     "SELECT id FROM 'data/test_in_list.csv' WHERE g IN "
+                     "(SELECT t FROM 'data/test_in_list.csv' WHERE id = 1)");
+    assert(count_rows("SELECT id FROM 'data/test_in_list.csv' WHERE t NOT IN ('b', 30)") == 0);
+    assert_same_rows("SELECT id FROM 'data/test_in_list.csv' WHERE t NOT IN ('b', 30)",
+                     "SELECT id FROM 'data/test_in_list.csv' WHERE t NOT IN "
+                     "(SELECT CASE WHEN id = 2 THEN t ELSE g END FROM 'data/test_in_list.csv' "
+                     "WHERE id = 2 OR id = 5)");
+    
+    remove(filename);
+    printf("✓ test_in_list_and_subquery passed\n\n");
+}
+
+void test_scalar_subquery_memo() {
+    printf("Running test_scalar_subquery_memo...\n");
+    
+    // rows of the same city share one evaluation of the subquery
+    assert(count_rows("SELECT name FROM 'data/users.csv' u WHERE age > "
+                      "(SELECT AVG(age) FROM 'data/users.csv' x WHERE x.city = u.city)") == 5);
+    
+    // which outer columns are read depends on the row, the memo has to key on all of them
+    ASTNode* ast = parse("SELECT name, (SELECT COUNT(*) FROM 'data/users.csv' x "
+                         "WHERE x.age > u.age OR x.city = u.city) FROM 'data/users.csv' u");
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 10);
+    
+    CsvTable* users = csv_load("data/users.csv", csv_config_default());
+    assert(users != NULL);
+    for (int r = 0; r < users->row_count; r++) {
+        const Value* age = row_value(&users->rows[r], 2);
+        const Value* city = row_value(&users->rows[r], 7);
+        
+        long long expected = 0;
+        for (int x = 0; x < users->row_count; x++) {
+            if (value_compare(row_value(&users->rows[x], 2), age) > 0 ||
+                value_compare(row_value(&users->rows[x], 7), city) == 0) {
+                expected++;
+            }
+        }
+        assert(result->rows[r].values[1].type == VALUE_TYPE_INTEGER);
+        assert(result->rows[r].values[1].int_value == expected);
+    }
+    csv_free(users);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // an uncorrelated subquery in WHERE
+    assert(count_rows("SELECT name FROM 'data/users.csv' WHERE age > "
+                      "(SELECT AVG(age) FROM 'data/users.csv')") == 4);
+    
+    printf("✓ test_scalar_subquery_memo passed\n\n");
+}
+
+void test_decorrelated_subquery() {
+    printf("Running test_decorrelated_subquery...\n");
+    
+    const char* filename = "data/test_decorrelated.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "cust,amount,region\na,10,x\na,30,y\nb,5,x\n,7,x\n,9,y\nc,,x\n");
+    fclose(f);
+    
+    // amounts above the average of their customer, NULL customers form a group of their own
+    ASTNode* ast = parse("SELECT cust, amount FROM 'data/test_decorrelated.csv' o WHERE amount > "
+                         "(SELECT AVG(amount) FROM 'data/test_decorrelated.csv' o2 WHERE o2.cust = o.cust)");
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 2);
+    assert(strcmp(result->rows[0].values[0].string_value, "a") == 0);
+    assert(result->rows[0].values[1].int_value == 30);
+    assert(result->rows[1].values[0].type == VALUE_TYPE_NULL);
+    assert(result->rows[1].values[1].int_value == 9);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // customers without a row passing the other conditions count nothing
+    ast = parse("SELECT cust, (SELECT COUNT(*) FROM 'data/test_decorrelated.csv' o2 "
+                "WHERE o2.cust = o.cust AND o2.region = 'y') FROM 'data/test_decorrelated.csv' o");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 6);
+    long long counts[] = {1, 1, 0, 1, 1, 0};
+    for (int r = 0; r < 6; r++) {
+        assert(result->rows[r].values[1].type == VALUE_TYPE_INTEGER);
+        assert(result->rows[r].values[1].int_value == counts[r]);
+    }
+    csv_free(result);
+    releaseNode(ast);
+    
+    // two correlation columns, written either way round
+    ast = parse("SELECT cust, (SELECT SUM(amount) FROM 'data/test_decorrelated.csv' o2 "
+                "WHERE o.region = o2.region AND o2.cust = o.cust) FROM 'data/test_decorrelated.csv' o");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 6);
+    double sums[] = {10, 30, 5, 7, 9, 0};
+    for (int r = 0; r < 6; r++) {
+        assert(result->rows[r].values[1].type == VALUE_TYPE_DOUBLE);
+        assert(result->rows[r].values[1].double_value == sums[r]);
+    }
+    csv_free(result);
+    releaseNode(ast);
+    
+    // a condition reading the outer row is not a correlation column, the subquery runs per row
+    assert(count_rows("SELECT cust FROM 'data/test_decorrelated.csv' o WHERE 1 < "
+                      "(SELECT COUNT(*) FROM 'data/test_decorrelated.csv' o2 "
+                      "WHERE o2.cust = o.cust AND o2.amount >= o.amount)") == 2);
+    
+    remove(filename);
+    printf("✓ test_decorrelated_subquery passed\n\n");
+}
+
+void test_top_n() {
+    printf("Running test_top_n...\n");
+    
+    const char* filename = "data/test_top_n.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,score,tag\n");
+    for (int i = 0; i < 200; i++) {
+        // scores repeat every 50 rows, every 7th one is NULL
+        if (i % 7 == 3) fprintf(f, "%d,,t%d\n", i, i % 5);
+        else fprintf(f, "%d,%d,t%d\n", i, (i * 37) % 50, i % 5);
+    }
+    fclose(f);
+    
+    // ties keep the order of the source rows
+    ASTNode* ast = parse("SELECT id, score FROM 'data/test_top_n.csv' ORDER BY score DESC LIMIT 3 OFFSET 2");
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 3);
+    assert(result->rows[0].values[0].int_value == 127);
+    assert(result->rows[1].values[0].int_value == 177);
+    assert(result->rows[1].values[1].int_value == 49);
+    assert(result->rows[2].values[0].int_value == 4);
+    assert(result->rows[2].values[1].int_value == 48);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // NULL sorts first ascending, the sort column is an alias of an expression
+    ast = parse("SELECT id, score * 2 AS doubled FROM 'data/test_top_n.csv' ORDER BY doubled LIMIT 30");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 30);
+    for (int i = 0; i < 29; i++) {
+        assert(result->rows[i].values[1].type == VALUE_TYPE_NULL);
+    }
+    assert(result->rows[28].values[0].int_value == 199);
+    assert(result->rows[29].values[1].int_value == 0);
+    assert(result->rows[29].values[0].int_value == 0);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // star columns, and nothing to keep
+    ast = parse("SELECT * FROM 'data/test_top_n.csv' WHERE tag = 't1' ORDER BY id DESC LIMIT 2");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 2);
+    assert(result->column_count == 3);
+    assert(result->rows[0].values[0].int_value == 196);
+    assert(result->rows[1].values[0].int_value == 191);
+    csv_free(result);
+    releaseNode(ast);
+    
+    assert(count_rows("SELECT id FROM 'data/test_top_n.csv' ORDER BY id LIMIT 0") == 0);
+    assert(count_rows("SELECT id FROM 'data/test_top_n.csv' ORDER BY id LIMIT 500") == 200);
+    
+    remove(filename);
+    printf("✓ test_top_n passed\n\n");
+}
+
+void test_multi_key_order_by() {
+    printf("Running test_multi_key_order_by...\n");
+    
+    const char* filename = "data/test_multi_order.csv";
+    FILE* f = fopen(filename, "w");
+    assert(f != NULL);
+    fprintf(f, "id,dt,region,amount\n");
+    fprintf(f, "1,2024-01-02,north,5\n");
+    fprintf(f, "2,2024-01-01,south,-1.5\n");
+    fprintf(f, "3,2024-01-02,north,12\n");
+    fprintf(f, "4,2024-01-01,nort,3\n");
+    fprintf(f, "5,2024-01-02,,7\n");
+    fprintf(f, "6,2023-12-31,north,\n");
+    fprintf(f, "7,2024-01-01,south,-2\n");
+    fprintf(f, "8,2024-01-02,north,12\n");
+    fclose(f);
+    
+    // NULL region first ascending, "nort" before its extension "north", ties keep file order
+    long long expected[] = {6, 4, 2, 7, 5, 3, 8, 1};
+    ASTNode* ast = parse("SELECT id, dt, region, amount FROM 'data/test_multi_order.csv' ORDER BY dt, region, amount DESC");
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 8);
+    for (int i = 0; i < 8; i++) {
+        assert(result->rows[i].values[0].int_value == expected[i]);
+    }
+    csv_free(result);
+    releaseNode(ast);
+    
+    // the same order picked by the top-N heap
+    ast = parse("SELECT id, dt, region, amount FROM 'data/test_multi_order.csv' ORDER BY dt, region, amount DESC LIMIT 3 OFFSET 4");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 3);
+    for (int i = 0; i < 3; i++) {
+        assert(result->rows[i].values[0].int_value == expected[4 + i]);
+    }
+    csv_free(result);
+    releaseNode(ast);
+    
+    // NULLS LAST on a descending key and NULLS FIRST on an ascending one
+    ast = parse("SELECT id, amount FROM 'data/test_multi_order.csv' ORDER BY amount DESC NULLS FIRST, id DESC");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->rows[0].values[0].int_value == 6);
+    assert(result->rows[1].values[0].int_value == 8);
+    assert(result->rows[2].values[0].int_value == 3);
+    assert(result->rows[7].values[0].int_value == 7);
+    csv_free(result);
+    releaseNode(ast);
+    
+    ast = parse("SELECT id, region FROM 'data/test_multi_order.csv' ORDER BY region NULLS LAST, id LIMIT 8");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->rows[0].values[0].int_value == 4);
+    assert(result->rows[7].values[0].int_value == 5);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // keys of a grouped result, one of them an aggregate
+    ast = parse("SELECT dt, COUNT(*) AS n FROM 'data/test_multi_order.csv' GROUP BY dt ORDER BY n DESC, dt");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 3);
+    assert(result->rows[0].values[1].int_value == 4);
+    assert(result->rows[1].values[1].int_value == 3);
+    assert(result->rows[2].values[1].int_value == 1);
+    csv_free(result);
+    releaseNode(ast);
+    
+    remove(filename);
+    printf("✓ test_multi_key_order_by passed\n\n");
+}
+
+/* sink collecting the streamed rows of test_streaming */
+typedef struct {
+    int begin_calls;
+    int column_count;
+    int row_count;
+    char names[8][32];
+} StreamCollect;
+
+static void collect_begin(void* ctx, ResultSet* header) {
+    StreamCollect* collect = ctx;
+    collect->begin_calls++;
+    collect->column_count = header->column_count;
+    assert(header->row_count == 0);
+}
+
+static void collect_rows(void* ctx, ResultSet* batch) {
+    StreamCollect* collect = ctx;
+    for (int i = 0; i < batch->row_count; i++) {
+        if (collect->row_count < 8) {
+            snprintf(collect->names[collect->row_count], 32, "%s", batch->rows[i].values[0].string_value);
+        }
+        collect->row_count++;
+    }
+}
+
+void test_streaming() {
+    printf("Running test_streaming...\n");
+    
+    // blocking operators fall back to evaluate_query
+    ASTNode* sorted = parse("SELECT name FROM 'data/test_data.csv' ORDER BY age");
+    ASTNode* counted = parse("SELECT COUNT(*) FROM 'data/test_data.csv'");
+    assert(!query_is_streamable(sorted));
+    assert(!query_is_streamable(counted));
+    releaseNode(sorted);
+    releaseNode(counted);
+    
+    // WHERE, OFFSET and LIMIT are applied while streaming
+    const char* sql = "SELECT name, age FROM 'data/test_data.csv' WHERE age > 20 LIMIT 3 OFFSET 1";
+    ASTNode* ast = parse(sql);
+    assert(query_is_streamable(ast));
+    
+    StreamCollect collect = {0};
+    ResultSink sink = { collect_begin, collect_rows, &collect };
+    int row_count = evaluate_query_streaming(ast, &sink);
+    
+    assert(row_count == 3);
+    assert(collect.begin_calls == 1);
+    assert(collect.column_count == 2);
+    assert(collect.row_count == 3);
+    assert(strcmp(collect.names[0], "Bob") == 0);
+    assert(strcmp(collect.names[1], "Charlie") == 0);
+    assert(strcmp(collect.names[2], "Diana") == 0);
+    
+    releaseNode(ast);
+    printf("✓ test_streaming passed\n\n");
+}
+
 int main(void) {
     printf("=== Evaluator Test Suite ===\n\n");
     
@@ -197,6 +885,21 @@ int main(void) {
     test_alias();
     test_group_by_avg();
     test_group_by_count();
+    test_group_by_multi_column();
+    test_projected_columns();
+    test_where_pushdown();
+    test_columnar_operators();
+    test_batch_where();
+    test_column_binding();
+    test_compiled_expressions();
+    test_constant_folding();
+    test_in_subquery();
+    test_in_list_and_subquery();
+    test_scalar_subquery_memo();
+    test_decorrelated_subquery();
+    test_top_n();
+    test_multi_key_order_by();
+    test_streaming();
     
     printf("=== All evaluator tests passed! ===\n");
     return 0;
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_framework.h"
+#include "parser.h"
+#include "evaluator.h"
+#include "csv_reader.h"
+
+static const char* left_file = "data/test_join_left.csv";
+static const char* right_file = "data/test_join_right.csv";
+
+static void create_join_files(void) {
+    FILE* f = fopen(left_file, "w");
+    fprintf(f, "id,region,name\n");
+    fprintf(f, "1,eu,Alice\n");
+    fprintf(f, "2,us,Bob\n");
+    fprintf(f, "3,eu,Charlie\n");
+    fprintf(f, ",eu,Nobody\n");
+    fprintf(f, "5,us,Eve\n");
+    fclose(f);
+
+    f = fopen(right_file, "w");
+    fprintf(f, "cust,region,amount\n");
+    fprintf(f, "1,eu,10\n");
+    fprintf(f, "1,eu,20\n");
+    fprintf(f, "2,eu,30\n");
+    fprintf(f, ",eu,40\n");
+    fprintf(f, "7,us,50\n");
+    fprintf(f, "3.0,eu,60\n");
+    fclose(f);
+}
+
+static ResultSet* run_query(const char* sql) {
+    ASTNode* ast = parse(sql);
+    if (!ast) return NULL;
+    ResultSet* result = evaluate_query(ast);
+    releaseNode(ast);
+    return result;
+}
+
+// Test 1: INNER JOIN on a single key keeps left order and duplicates
+void test_inner_join() {
+    TEST_START("INNER JOIN single key");
+
+    ResultSet* result = run_query("SELECT l.name, r.amount FROM 'data/test_join_left.csv' AS l "
+                                  "INNER JOIN 'data/test_join_right.csv' AS r ON l.id = r.cust");
+    ASSERT_NOT_NULL(result);
+
+    // 1 -> 10, 20; 2 -> 30; 3 -> 3.0 (numeric equality); NULL keys never match
+    ASSERT_EQUAL(4, result->row_count);
+    ASSERT_TRUE(strcmp(result->rows[0].values[0].string_value, "Alice") == 0);
+    ASSERT_EQUAL(10, result->rows[0].values[1].int_value);
+    ASSERT_EQUAL(20, result->rows[1].values[1].int_value);
+    ASSERT_TRUE(strcmp(result->rows[2].values[0].string_value, "Bob") == 0);
+    ASSERT_TRUE(strcmp(result->rows[3].values[0].string_value, "Charlie") == 0);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+// Test 2: equality written as right = left
+void test_inner_join_reversed_condition() {
+    TEST_START("INNER JOIN with reversed ON operands");
+
+    ResultSet* result = run_query("SELECT l.name, r.amount FROM 'data/test_join_left.csv' AS l "
+                                  "INNER JOIN 'data/test_join_right.csv' AS r ON r.cust = l.id");
+    ASSERT_NOT_NULL(result);
+    ASSERT_EQUAL(4, result->row_count);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+// Test 3: conjunction of equalities
+void test_multi_key_join() {
+    TEST_START("INNER JOIN on composite key");
+
+    ResultSet* result = run_query("SELECT l.name, r.amount FROM 'data/test_join_left.csv' AS l "
+                                  "INNER JOIN 'data/test_join_right.csv' AS r "
+                                  "ON l.id = r.cust AND l.region = r.region");
+    ASSERT_NOT_NULL(result);
+
+    // Bob is in 'us' while his order is in 'eu'
+    ASSERT_EQUAL(3, result->row_count);
+    ASSERT_EQUAL(60, result->rows[2].values[1].int_value);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+// Test 4: LEFT JOIN pads unmatched and NULL-keyed left rows
+void test_left_join() {
+    TEST_START("LEFT JOIN");
+
+    ResultSet* result = run_query("SELECT l.name, r.amount FROM 'data/test_join_left.csv' AS l "
+                                  "LEFT JOIN 'data/test_join_right.csv' AS r ON l.id = r.cust");
+    ASSERT_NOT_NULL(result);
+
+    // 4 matches + Nobody + Eve
+    ASSERT_EQUAL(6, result->row_count);
+    ASSERT_TRUE(strcmp(result->rows[4].values[0].string_value, "Nobody") == 0);
+    ASSERT_TRUE(result->rows[4].values[1].type == VALUE_TYPE_NULL);
+    ASSERT_TRUE(result->rows[5].values[1].type == VALUE_TYPE_NULL);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+// Test 5: RIGHT JOIN appends unmatched right rows after the matches
+void test_right_join() {
+    TEST_START("RIGHT JOIN");
+
+    ResultSet* result = run_query("SELECT l.name, r.amount FROM 'data/test_join_left.csv' AS l "
+                                  "RIGHT JOIN 'data/test_join_right.csv' AS r ON l.id = r.cust");
+    ASSERT_NOT_NULL(result);
+
+    // 4 matches + NULL cust (40) + 7 (50)
+    ASSERT_EQUAL(6, result->row_count);
+    ASSERT_TRUE(result->rows[4].values[0].type == VALUE_TYPE_NULL);
+    ASSERT_EQUAL(40, result->rows[4].values[1].int_value);
+    ASSERT_EQUAL(50, result->rows[5].values[1].int_value);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+// Test 6: FULL JOIN keeps unmatched rows from both sides
+void test_full_join() {
+    TEST_START("FULL JOIN");
+
+    ResultSet* result = run_query("SELECT l.name, r.amount FROM 'data/test_join_left.csv' AS l "
+                                  "FULL JOIN 'data/test_join_right.csv' AS r ON l.id = r.cust");
+    ASSERT_NOT_NULL(result);
+    ASSERT_EQUAL(8, result->row_count);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+// Test 7: SELECT * still sees every column of both sides
+void test_join_select_star() {
+    TEST_START("JOIN with SELECT *");
+
+    ResultSet* result = run_query("SELECT * FROM 'data/test_join_left.csv' AS l "
+                                  "INNER JOIN 'data/test_join_right.csv' AS r ON l.id = r.cust");
+    ASSERT_NOT_NULL(result);
+    ASSERT_EQUAL(4, result->row_count);
+    ASSERT_EQUAL(6, result->column_count);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+// Test 8: only the referenced columns are carried through the join
+void test_join_projected_columns() {
+    TEST_START("JOIN with columns used outside the select list");
+
+    ResultSet* result = run_query("SELECT l.name FROM 'data/test_join_left.csv' AS l "
+                                  "INNER JOIN 'data/test_join_right.csv' AS r ON l.id = r.cust "
+                                  "WHERE r.amount > 15");
+    ASSERT_NOT_NULL(result);
+    ASSERT_EQUAL(3, result->row_count);
+    ASSERT_TRUE(strcmp(result->rows[0].values[0].string_value, "Alice") == 0);
+    ASSERT_TRUE(strcmp(result->rows[2].values[0].string_value, "Charlie") == 0);
+
+    csv_free(result);
+
+    result = run_query("SELECT COUNT(*) FROM 'data/test_join_left.csv' AS l "
+                       "LEFT JOIN 'data/test_join_right.csv' AS r ON l.id = r.cust");
+    ASSERT_NOT_NULL(result);
+    ASSERT_EQUAL(1, result->row_count);
+    ASSERT_EQUAL(6, result->rows[0].values[0].int_value);
+
+    csv_free(result);
+    TEST_PASS();
+}
+
+int main() {
+    create_join_files();
+
+    test_inner_join();
+    test_inner_join_reversed_condition();
+    test_multi_key_join();
+    test_left_join();
+    test_right_join();
+    test_full_join();
+    test_join_select_star();
+    test_join_projected_columns();
+
+    unlink(left_file);
+    unlink(right_file);
+
+    print_test_summary();
+    return (tests_failed == 0) ? 0 : 1;
+}
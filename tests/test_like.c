@@ -5,6 +5,7 @@
 #include "parser.h"
 #include "evaluator.h"
 #include "csv_reader.h"
+#include "like.h"
 
 void test_like_basic() {
     printf("Test: LIKE basic patterns...\n");
@@ -285,6 +286,76 @@ void test_like_with_and_or() {
     printf("  PASSED\n\n");
 }
 
+void test_like_compiled_patterns() {
+    printf("Test: compiled LIKE patterns...\n");
+    
+    struct {
+        const char* pattern;
+        const char* str;
+        bool case_sensitive;
+        bool expected;
+    } cases[] = {
+        { "abc", "abc", true, true },
+        { "abc", "abcd", true, false },
+        { "", "", true, true },
+        { "ab%", "abc", true, true },
+        { "ab%", "a", true, false },
+        { "%bc", "abc", true, true },
+        { "%bc", "abcb", true, false },
+        { "%out%", "request timeout", true, true },
+        { "%OUT%", "request timeout", true, false },
+        { "%OUT%", "request timeout", false, true },
+        { "%", "", true, true },
+        { "a%a", "a", true, false },
+        { "a%a", "aa", true, true },
+        { "a%b%c", "aXbYbc", true, true },
+        { "a%b%c", "acb", true, false },
+        { "%time%sock%", "Timeout on SOCKET", false, true },
+        { "%sock%time%", "Timeout on SOCKET", false, false },
+        { "r_q%", "REQUEST", false, true },
+        { "%1@%", "x1@y", false, true },
+    };
+    
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        LikePattern* like = like_compile(cases[i].pattern, strlen(cases[i].pattern), cases[i].case_sensitive);
+        bool matched = like_match(like, cases[i].str, strlen(cases[i].str));
+        assert(matched == cases[i].expected);
+        assert(matched == match_pattern(cases[i].str, strlen(cases[i].str), cases[i].pattern,
+                                        strlen(cases[i].pattern), cases[i].case_sensitive));
+        like_free(like);
+    }
+    
+    // the loader drops the rows a pattern rejects, the WHERE clause agrees with it
+    FILE* f = fopen("test_like_compiled.csv", "w");
+    fprintf(f, "id,msg\n");
+    fprintf(f, "1,Connection Timeout\n");
+    fprintf(f, "2,request ok\n");
+    fprintf(f, "3,timeout on socket\n");
+    fprintf(f, "4,2024-01-01\n");
+    fclose(f);
+    
+    ASTNode* ast = parse("SELECT id FROM test_like_compiled.csv WHERE msg ILIKE '%TIMEOUT%' AND msg LIKE '%o%t'");
+    assert(ast != NULL);
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 2);
+    assert(result->rows[0].values[0].int_value == 1);
+    assert(result->rows[1].values[0].int_value == 3);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // a date is not a string, no pattern matches it
+    ast = parse("SELECT id FROM test_like_compiled.csv WHERE msg LIKE '2024%'");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 0);
+    csv_free(result);
+    releaseNode(ast);
+    
+    remove("test_like_compiled.csv");
+    printf("  PASSED\n\n");
+}
+
 int main() {
     printf("=== LIKE and ILIKE Tests ===\n\n");
     
@@ -296,6 +367,7 @@ int main() {
     test_like_exact_match();
     test_like_complex_patterns();
     test_like_with_and_or();
+    test_like_compiled_patterns();
     
     printf("=== All LIKE/ILIKE tests passed! ===\n");
     return 0;
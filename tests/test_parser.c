@@ -173,13 +173,38 @@ void test_order_by() {
     assert(ast != NULL);
     assert(ast->query.order_by != NULL);
     assert_node_type(ast->query.order_by, NODE_TYPE_ORDER_BY);
-    assert(strcmp(ast->query.order_by->order_by.column, "height") == 0);
-    assert(ast->query.order_by->order_by.descending == true);
+    assert(ast->query.order_by->order_by.column_count == 1);
+    assert(strcmp(ast->query.order_by->order_by.columns[0], "height") == 0);
+    assert(ast->query.order_by->order_by.descending[0] == true);
+    assert(ast->query.order_by->order_by.nulls_first[0] == false);
     
     releaseNode(ast);
     printf("✓ test_order_by passed\n\n");
 }
 
+void test_order_by_multiple_keys() {
+    printf("Running test_order_by_multiple_keys...\n");
+    
+    const char* sql = "SELECT name FROM t ORDER BY region, UPPER(name) DESC NULLS FIRST, t.last ASC NULLS LAST, first LIMIT 3";
+    ASTNode* ast = parse(sql);
+    
+    assert(ast != NULL);
+    ASTNode* order_by = ast->query.order_by;
+    assert(order_by != NULL);
+    assert(order_by->order_by.column_count == 4);
+    assert(strcmp(order_by->order_by.columns[0], "region") == 0);
+    assert(!order_by->order_by.descending[0] && order_by->order_by.nulls_first[0]);
+    assert(strcmp(order_by->order_by.columns[1], "UPPER(name)") == 0);
+    assert(order_by->order_by.descending[1] && order_by->order_by.nulls_first[1]);
+    assert(strcmp(order_by->order_by.columns[2], "t.last") == 0);
+    assert(!order_by->order_by.descending[2] && !order_by->order_by.nulls_first[2]);
+    assert(strcmp(order_by->order_by.columns[3], "first") == 0);
+    assert(ast->query.limit == 3);
+    
+    releaseNode(ast);
+    printf("✓ test_order_by_multiple_keys passed\n\n");
+}
+
 /* test 9: Complete query */
 void test_complete_query() {
     printf("Running test_complete_query...\n");
@@ -287,6 +312,7 @@ int main(void) {
     test_group_by();
     test_group_by_multiple();
     test_order_by();
+    test_order_by_multiple_keys();
     test_only_select();
     test_comparison_operators();
     test_complete_query();
@@ -265,6 +265,60 @@ void test_intersect_no_common() {
     printf("  PASSED\n\n");
 }
 
+void test_set_ops_with_nulls_and_aggregates() {
+    printf("Test: set operations with NULLs, duplicates and aggregate inputs...\n");
+    
+    FILE* f1 = fopen("test_set_nulls_a.csv", "w");
+    fprintf(f1, "id,name\n1,Alice\n,Bob\n1,Alice\n2,\n,Bob\n3,Carol\n");
+    fclose(f1);
+    
+    FILE* f2 = fopen("test_set_nulls_b.csv", "w");
+    fprintf(f2, "id,name\n,Bob\n2,\n4,Dave\n");
+    fclose(f2);
+    
+    // UNION removes duplicates within each side too, NULL matches NULL
+    ASTNode* ast = parse("SELECT id, name FROM test_set_nulls_a.csv UNION SELECT id, name FROM test_set_nulls_b.csv");
+    ResultSet* result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 5); // Alice, Bob, (2, NULL), Carol, Dave
+    assert(result->rows[1].values[0].type == VALUE_TYPE_NULL);
+    assert(strcmp(result->rows[4].values[1].string_value, "Dave") == 0);
+    csv_free(result);
+    releaseNode(ast);
+    
+    ast = parse("SELECT id, name FROM test_set_nulls_a.csv EXCEPT SELECT id, name FROM test_set_nulls_b.csv");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 2); // Alice, Carol
+    assert(strcmp(result->rows[0].values[1].string_value, "Alice") == 0);
+    assert(strcmp(result->rows[1].values[1].string_value, "Carol") == 0);
+    csv_free(result);
+    releaseNode(ast);
+    
+    ast = parse("SELECT id, name FROM test_set_nulls_a.csv INTERSECT SELECT id, name FROM test_set_nulls_b.csv");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 2); // Bob, (2, NULL)
+    assert(strcmp(result->rows[0].values[1].string_value, "Bob") == 0);
+    assert(result->rows[1].values[1].type == VALUE_TYPE_NULL);
+    csv_free(result);
+    releaseNode(ast);
+    
+    // aggregate results on one side and a nested set operation on the other
+    ast = parse("SELECT COUNT(*) FROM test_set_nulls_a.csv UNION ALL SELECT id FROM test_set_nulls_b.csv UNION ALL SELECT id FROM test_set_nulls_b.csv");
+    result = evaluate_query(ast);
+    assert(result != NULL);
+    assert(result->row_count == 7);
+    assert(result->rows[0].values[0].int_value == 6);
+    assert(result->rows[3].values[0].int_value == 4);
+    csv_free(result);
+    releaseNode(ast);
+    
+    remove("test_set_nulls_a.csv");
+    remove("test_set_nulls_b.csv");
+    printf("  PASSED\n\n");
+}
+
 int main() {
     printf("=== Set Operations Tests (UNION, INTERSECT, EXCEPT) ===\n\n");
     
@@ -276,6 +330,7 @@ int main() {
     test_multiple_unions();
     test_union_different_columns();
     test_intersect_no_common();
+    test_set_ops_with_nulls_and_aggregates();
     
     printf("=== All set operation tests passed! ===\n");
     return 0;